@@ -0,0 +1,159 @@
+#include "analysiscache.h"
+#include "logger.h"
+#include <cstring>
+
+namespace {
+
+const char Magic[4] = { 'C', 'H', 'A', 'C' };
+const uint32_t Version = 1;
+const qint64 HeaderSize = 16;
+
+struct Header
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+} // namespace
+
+AnalysisCache::~AnalysisCache()
+{
+    close();
+}
+
+bool AnalysisCache::open(const QString &path)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        LOG_ERROR("analysis_cache_open_failed", {"path", path}, {"error", file.errorString()});
+        return false;
+    }
+
+    Header header;
+    bool valid = file.size() >= HeaderSize && file.read(reinterpret_cast<char *>(&header), HeaderSize) == HeaderSize &&
+                 std::memcmp(header.magic, Magic, 4) == 0 && header.version == Version && header.recordSize == sizeof(Record);
+    if (!valid) {
+        // Üres vagy más formátumú fájl: újrakezdjük
+        if (file.size() > 0) LOG_WARNING("analysis_cache_reset", {"path", path});
+        file.resize(0);
+        std::memcpy(header.magic, Magic, 4);
+        header.version = Version;
+        header.recordSize = sizeof(Record);
+        header.reserved = 0;
+        file.seek(0);
+        file.write(reinterpret_cast<const char *>(&header), HeaderSize);
+        file.flush();
+    }
+
+    std::string localPath = QFile::encodeName(path).toStdString();
+    mappedCount = (file.size() - HeaderSize) / qint64(sizeof(Record));
+    if (!truncateTornTail(localPath, uint64_t(HeaderSize + mappedCount * qint64(sizeof(Record))))) {
+        file.close();
+        return false;
+    }
+
+    if (mappedCount > 0) {
+        mapped = file.map(HeaderSize, mappedCount * qint64(sizeof(Record)));
+        if (!mapped) {
+            LOG_ERROR("analysis_cache_map_failed", {"path", path}, {"error", file.errorString()});
+            file.close();
+            return false;
+        }
+    }
+
+    index.reserve(int(mappedCount));
+    for (qint64 i = 0; i < mappedCount; ++i) {
+        uint64_t key;
+        std::memcpy(&key, mapped + i * qint64(sizeof(Record)), sizeof(key));
+        index.insert(key, i);   // A későbbi rekord felülírja a korábbit
+    }
+    if (!appender.open(localPath, std::string())) {
+        LOG_ERROR("analysis_cache_open_failed", {"path", path});
+        close();
+        return false;
+    }
+    LOG_INFO("analysis_cache_opened", {"path", path}, {"records", mappedCount}, {"positions", int(index.size())});
+    return true;
+}
+
+void AnalysisCache::close()
+{
+    appender.close();
+    if (!file.isOpen()) return;
+    if (mapped) file.unmap(mapped);
+    mapped = nullptr;
+    mappedCount = 0;
+    appended.clear();
+    index.clear();
+    file.close();
+}
+
+AnalysisCache::Record AnalysisCache::record(qint64 number) const
+{
+    if (number >= mappedCount) return appended[size_t(number - mappedCount)];
+    Record result;
+    std::memcpy(&result, mapped + number * qint64(sizeof(Record)), sizeof(Record));
+    return result;
+}
+
+bool AnalysisCache::probe(uint64_t key, int minDepth, Entry &entry)
+{
+    auto it = index.constFind(key);
+    if (it == index.constEnd()) {
+        ++missCount;
+        return false;
+    }
+
+    Record stored = record(it.value());
+    if (stored.depth < minDepth) {
+        ++missCount;
+        return false;
+    }
+
+    entry.bestMove = stored.bestMove;
+    entry.score = stored.score;
+    entry.mate = stored.flags & 1;
+    entry.depth = stored.depth;
+    entry.pv.assign(stored.pv, stored.pv + stored.pvLength);
+    ++hitCount;
+    return true;
+}
+
+bool AnalysisCache::probe(const Position &position, int minDepth, Entry &entry)
+{
+    if (!probe(position.key(), minDepth, entry)) return false;
+    if (position.isPseudoLegal(entry.bestMove)) return true;
+    --hitCount;
+    ++missCount;
+    return false;
+}
+
+void AnalysisCache::store(uint64_t key, const Entry &entry)
+{
+    if (!appender.isOpen() || entry.bestMove == NoMove) return;
+
+    auto it = index.constFind(key);
+    if (it != index.constEnd() && record(it.value()).depth >= entry.depth) return;
+
+    Record stored;
+    std::memset(&stored, 0, sizeof(stored));
+    stored.key = key;
+    stored.bestMove = entry.bestMove;
+    stored.score = int16_t(qBound(-32000, entry.score, 32000));
+    stored.depth = uint8_t(qBound(0, entry.depth, 255));
+    stored.flags = entry.mate ? 1 : 0;
+    stored.pvLength = uint8_t(qMin(int(entry.pv.size()), int(MaxPvLength)));
+    for (int i = 0; i < stored.pvLength; ++i) stored.pv[i] = entry.pv[size_t(i)];
+
+    appended.push_back(stored);
+    index.insert(key, mappedCount + qint64(appended.size()) - 1);
+    appender.append(stored);
+}
+
+void AnalysisCache::encode(const Record &record, std::string &out)
+{
+    out.append(reinterpret_cast<const char *>(&record), sizeof(Record));
+}
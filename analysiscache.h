@@ -0,0 +1,79 @@
+#ifndef ANALYSISCACHE_H
+#define ANALYSISCACHE_H
+
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "position.h"
+#include "fileappender.h"
+
+// Persistent engine results keyed by Zobrist key.
+// The file is a 16 byte header followed by fixed 40 byte records that are only
+// ever appended; a later record for the same key replaces the earlier one. On
+// open the file is memory-mapped and indexed, records stored afterwards are
+// kept in memory until the next open and appended to the file from a
+// background thread (FileAppender). A torn record at the end (crash while
+// writing) is cut off on open.
+class AnalysisCache
+{
+public:
+    struct Entry
+    {
+        Move bestMove = NoMove;
+        int score = 0;          // Side to move, centipawns or moves to mate (Search::mateMoves)
+        bool mate = false;
+        int depth = 0;
+        std::vector<Move> pv;
+    };
+
+    static const int MaxPvLength = 12;
+
+    ~AnalysisCache();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    // Hit only if the stored result is at least minDepth deep
+    bool probe(uint64_t key, int minDepth, Entry &entry);
+    // Same, but the best move must also be playable in the position (key collision guard)
+    bool probe(const Position &position, int minDepth, Entry &entry);
+    // Ignored when an equal or deeper result is already stored; only queues the
+    // write and never waits for the disk
+    void store(uint64_t key, const Entry &entry);
+
+    int size() const { return int(index.size()); }
+    quint64 hits() const { return hitCount; }
+    quint64 misses() const { return missCount; }
+
+private:
+    struct Record
+    {
+        uint64_t key;
+        uint16_t bestMove;
+        int16_t score;
+        uint8_t depth;
+        uint8_t flags;          // 1 = mate score
+        uint8_t pvLength;
+        uint8_t reserved;
+        uint16_t pv[MaxPvLength];
+    };
+    static_assert(sizeof(Record) == 40, "AnalysisCache record layout changed");
+
+    Record record(qint64 number) const;
+    static void encode(const Record &record, std::string &out);
+
+    QFile file;
+    uchar *mapped = nullptr;
+    qint64 mappedCount = 0;             // Records inside the mapping
+    std::vector<Record> appended;       // Records written since open
+    QHash<quint64, qint64> index;       // Key -> record number
+    FileAppender<Record> appender { encode, "analysis cache writer", FileAppender<Record>::Unbounded };   // Nyitás után a fájlba csak ez ír
+    quint64 hitCount = 0;
+    quint64 missCount = 0;
+};
+
+#endif // ANALYSISCACHE_H
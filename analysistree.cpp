@@ -0,0 +1,114 @@
+#include "analysistree.h"
+#include <algorithm>
+
+const uint32_t AnalysisTree::NoNode;
+
+AnalysisTree::AnalysisTree()
+{
+    clear();
+}
+
+void AnalysisTree::clear()
+{
+    nodes.clear();
+    edges.clear();
+    index.assign(1024, NoNode);
+}
+
+uint32_t AnalysisTree::find(uint64_t key) const
+{
+    // A Zobrist kulcs alsó bitjei már egyenletesek, nem kell újrakeverni
+    size_t mask = index.size() - 1;
+    for (size_t slot = size_t(key) & mask;; slot = (slot + 1) & mask) {
+        uint32_t node = index[slot];
+        if (node == NoNode || nodes[node].key == key) return node;
+    }
+}
+
+uint32_t AnalysisTree::add(const Position &position)
+{
+    uint32_t node = find(position.key());
+    return node != NoNode ? node : insert(position.key(), position.evaluation().evaluate(position.whiteToMove()));
+}
+
+uint32_t AnalysisTree::addChild(uint32_t parent, Move move, const Position &child)
+{
+    uint32_t last = NoNode;
+    for (uint32_t edge = nodes[parent].firstEdge; edge != NoNode; edge = edges[edge].next) {
+        if (edges[edge].move == move) return edges[edge].child;
+        last = edge;
+    }
+
+    uint32_t node = add(child);
+    if (nodes[node].parents < 0xFFFF) ++nodes[node].parents;
+
+    // Az élek a felfedezés sorrendjében maradnak
+    edges.push_back({ node, NoNode, move });
+    uint32_t edge = uint32_t(edges.size() - 1);
+    if (last == NoNode) nodes[parent].firstEdge = edge;
+    else edges[last].next = edge;
+    return node;
+}
+
+uint32_t AnalysisTree::child(uint32_t node, Move move) const
+{
+    for (uint32_t edge = nodes[node].firstEdge; edge != NoNode; edge = edges[edge].next) {
+        if (edges[edge].move == move) return edges[edge].child;
+    }
+    return NoNode;
+}
+
+AnalysisTree::Result AnalysisTree::result(uint32_t node) const
+{
+    Result result;
+    result.score = nodes[node].score;
+    result.mate = nodes[node].mate != 0;
+    result.depth = nodes[node].depth;
+    result.bestMove = nodes[node].bestMove;
+    return result;
+}
+
+bool AnalysisTree::store(uint32_t node, const Result &result)
+{
+    Node &entry = nodes[node];
+    if (result.depth <= 0 || result.depth < entry.depth) return false;
+    entry.score = int16_t(std::max(-32000, std::min(32000, result.score)));
+    entry.mate = result.mate ? 1 : 0;
+    entry.depth = uint8_t(std::min(result.depth, 255));
+    entry.bestMove = result.bestMove;
+    return true;
+}
+
+size_t AnalysisTree::memoryUsage() const
+{
+    return nodes.capacity() * sizeof(Node) + edges.capacity() * sizeof(Edge) + index.capacity() * sizeof(uint32_t);
+}
+
+uint32_t AnalysisTree::insert(uint64_t key, int staticEval)
+{
+    if ((nodes.size() + 1) * 2 > index.size()) rehash(index.size() * 2);
+
+    Node node = {};
+    node.key = key;
+    node.firstEdge = NoNode;
+    node.staticEval = int16_t(std::max(-32000, std::min(32000, staticEval)));
+    nodes.push_back(node);
+    uint32_t id = uint32_t(nodes.size() - 1);
+
+    size_t mask = index.size() - 1;
+    size_t slot = size_t(key) & mask;
+    while (index[slot] != NoNode) slot = (slot + 1) & mask;
+    index[slot] = id;
+    return id;
+}
+
+void AnalysisTree::rehash(size_t size)
+{
+    index.assign(size, NoNode);
+    size_t mask = size - 1;
+    for (uint32_t id = 0; id < uint32_t(nodes.size()); ++id) {
+        size_t slot = size_t(nodes[id].key) & mask;
+        while (index[slot] != NoNode) slot = (slot + 1) & mask;
+        index[slot] = id;
+    }
+}
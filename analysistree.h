@@ -0,0 +1,84 @@
+#ifndef ANALYSISTREE_H
+#define ANALYSISTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "position.h"
+
+// Explored variations as a DAG keyed by the Zobrist key: a position reached
+// through different move orders is a single node, so the engine result and
+// static evaluation found on one line are shared by every line transposing
+// into it.
+// Nodes and edges live in two contiguous arenas and refer to each other by
+// 32-bit index. A node takes 24 bytes, an edge 12 and the key index at most
+// 16 (it is kept at most half full), so a million positions fit in ~50 MB.
+class AnalysisTree
+{
+public:
+    static const uint32_t NoNode = 0xFFFFFFFF;
+
+    struct Result
+    {
+        int score = 0;          // Side to move's point of view; moves to mate if mate
+        bool mate = false;
+        int depth = 0;          // 0 = no engine result yet
+        Move bestMove = NoMove;
+    };
+
+    AnalysisTree();
+    void clear();
+
+    uint32_t find(uint64_t key) const;
+    uint32_t add(const Position &position);   // Finds or inserts the position's node
+    // Finds or inserts the node of child (the position after move) and the
+    // parent -> child edge
+    uint32_t addChild(uint32_t parent, Move move, const Position &child);
+    uint32_t child(uint32_t node, Move move) const;
+    template <typename F> void forEachChild(uint32_t node, F visit) const;   // visit(Move, uint32_t child)
+
+    uint64_t key(uint32_t node) const { return nodes[node].key; }
+    int staticEval(uint32_t node) const { return nodes[node].staticEval; }
+    int parentCount(uint32_t node) const { return nodes[node].parents; }   // Több szülő = transzpozíció
+    Result result(uint32_t node) const;
+    bool store(uint32_t node, const Result &result);   // Kept if at least as deep as the stored one
+
+    size_t nodeCount() const { return nodes.size(); }
+    size_t edgeCount() const { return edges.size(); }
+    size_t memoryUsage() const;
+
+private:
+    struct Node
+    {
+        uint64_t key;
+        uint32_t firstEdge;     // NoNode = nincs gyerek
+        int16_t score;
+        int16_t staticEval;
+        Move bestMove;
+        uint8_t depth;
+        uint8_t mate;
+        uint16_t parents;       // 65535-nél telítődik
+    };
+
+    struct Edge
+    {
+        uint32_t child;
+        uint32_t next;          // A szülő következő éle, NoNode = utolsó
+        Move move;
+    };
+
+    uint32_t insert(uint64_t key, int staticEval);
+    void rehash(size_t size);
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::vector<uint32_t> index;   // Nyílt címzés lineáris próbálással, NoNode = üres hely
+};
+
+template <typename F>
+void AnalysisTree::forEachChild(uint32_t node, F visit) const
+{
+    for (uint32_t edge = nodes[node].firstEdge; edge != NoNode; edge = edges[edge].next) visit(edges[edge].move, edges[edge].child);
+}
+
+#endif // ANALYSISTREE_H
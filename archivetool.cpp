@@ -0,0 +1,56 @@
+#include "gamearchive.h"
+#include <QCoreApplication>
+#include <QTextStream>
+#include <fstream>
+#include <iostream>
+
+// Game archive utility.
+//
+//   chess_archive stats games.cga
+//   chess_archive pgn games.cga [out.pgn]
+//
+// "pgn" exports every game (stdout without an output file), "stats" prints the
+// number of games, plies and bytes per game.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QStringList args = app.arguments();
+    QTextStream err(stderr);
+    if (args.size() < 3 || (args[1] != "stats" && args[1] != "pgn")) {
+        err << "usage: chess_archive stats|pgn games.cga [out.pgn]\n";
+        return 2;
+    }
+
+    GameArchiveReader reader;
+    if (!reader.open(args[2].toStdString())) {
+        err << "Cannot read archive " << args[2] << "\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (args[1] == "pgn" && args.size() > 3) {
+        file.open(args[3].toStdString());
+        if (!file) {
+            err << "Cannot write " << args[3] << "\n";
+            return 1;
+        }
+    }
+    std::ostream &out = file.is_open() ? static_cast<std::ostream &>(file) : std::cout;
+
+    ArchivedGame game;
+    quint64 games = 0, plies = 0;
+    quint64 results[4] = {};
+    while (reader.next(game)) {
+        ++games;
+        plies += game.moves.size();
+        ++results[int(game.result)];
+        if (args[1] == "pgn") out << GameArchive::toPgn(game);
+    }
+
+    std::ifstream size(args[2].toStdString(), std::ios::binary | std::ios::ate);
+    qint64 bytes = qint64(size.tellg());
+    err << QString("%1 games, %2 plies, %3 bytes/game, 1-0 %4, 0-1 %5, draws %6, unfinished %7, corrupt tail %8\n")
+               .arg(games).arg(plies).arg(games ? double(bytes) / games : 0.0, 0, 'f', 1)
+               .arg(results[1]).arg(results[2]).arg(results[3]).arg(results[0]).arg(reader.skipped());
+    return 0;
+}
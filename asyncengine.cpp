@@ -0,0 +1,99 @@
+#include "asyncengine.h"
+#include <utility>
+
+SearchStop::SearchStop()
+    : state(std::make_shared<State>())
+{
+}
+
+void SearchStop::stop()
+{
+    std::coroutine_handle<> handle;
+    std::function<void(std::coroutine_handle<>)> resume;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->requested) return;
+        state->requested = true;
+        if (!state->pool || !state->job) return;   // Még nincs beküldve, az await_suspend látja a jelzést
+
+        // Sorban álló kérés: a pool eldobja, a visszahívás nem fut le, ezért itt folytatjuk.
+        // Futó kérés: a keresés hamarosan leáll és a szokásos úton tér vissza.
+        if (!state->pool->cancel(state->job)) return;
+        handle = std::exchange(state->waiting, nullptr);
+        resume = std::move(state->resume);
+    }
+    if (handle) resume(handle);
+}
+
+bool SearchStop::stopRequested() const
+{
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->requested;
+}
+
+AsyncEngine::AsyncEngine(EnginePool &pool, Executor executor)
+    : pool(pool)
+    , executor(std::move(executor))
+{
+}
+
+AsyncEngine::SearchAwaiter AsyncEngine::search(const Position &position, const SearchLimits &limits, SearchStop stop)
+{
+    return SearchAwaiter(this, position, limits, std::move(stop));
+}
+
+void AsyncEngine::resume(std::coroutine_handle<> handle)
+{
+    inFlight.fetch_sub(1, std::memory_order_relaxed);
+    if (executor) executor([handle]() { handle.resume(); });
+    else handle.resume();
+}
+
+AsyncEngine::SearchAwaiter::SearchAwaiter(AsyncEngine *engine, const Position &position, const SearchLimits &limits, SearchStop stop)
+    : engine(engine)
+    , position(position)
+    , limits(limits)
+    , stop(std::move(stop))
+{
+}
+
+bool AsyncEngine::SearchAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    // A beküldés után a korutin bármelyik szálon folytatódhat és az awaiter megszűnhet,
+    // ezért innentől csak helyi másolatokat használunk
+    std::shared_ptr<SearchStop::State> state = stop.state;
+    AsyncEngine *owner = engine;
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (state->requested) return false;
+
+    owner->inFlight.fetch_add(1, std::memory_order_relaxed);
+    state->pool = &owner->pool;
+    state->waiting = handle;
+    state->resume = [owner](std::coroutine_handle<> waiting) { owner->resume(waiting); };
+    state->job = owner->pool.submit(position, limits, [state](const SearchResult &result) {
+        std::coroutine_handle<> waiting;
+        std::function<void(std::coroutine_handle<>)> resume;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->reply.result = result;
+            waiting = std::exchange(state->waiting, nullptr);
+            resume = std::move(state->resume);
+        }
+        if (waiting) resume(waiting);
+    });
+    return true;
+}
+
+EngineReply AsyncEngine::SearchAwaiter::await_resume()
+{
+    std::lock_guard<std::mutex> lock(stop.state->mutex);
+    EngineReply reply = std::move(stop.state->reply);
+    reply.cancelled = stop.state->requested;
+    return reply;
+}
+
+void AsyncEngine::ScheduleAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    engine->executor([handle]() { handle.resume(); });
+}
@@ -0,0 +1,111 @@
+#ifndef ASYNCENGINE_H
+#define ASYNCENGINE_H
+
+#include <atomic>
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "enginepool.h"
+
+struct EngineReply
+{
+    SearchResult result;
+    bool cancelled = false;   // stop() was called; result is partial or empty
+};
+
+// Cancellation handle of one engine request. Copies share the same request;
+// stop() is safe from any thread and at any time, also before the search was
+// submitted (then the request completes immediately as cancelled). A stopped
+// handle stays stopped, a new request needs a new SearchStop.
+class SearchStop
+{
+public:
+    SearchStop();
+
+    void stop();
+    bool stopRequested() const;
+
+private:
+    friend class AsyncEngine;
+
+    struct State
+    {
+        mutable std::mutex mutex;
+        EnginePool *pool = nullptr;
+        EnginePool::JobId job = 0;     // 0 = nincs beküldve
+        bool requested = false;
+        std::coroutine_handle<> waiting;
+        std::function<void(std::coroutine_handle<>)> resume;
+        EngineReply reply;
+    };
+
+    std::shared_ptr<State> state;
+};
+
+// Coroutine front end of EnginePool: many requests can be in flight at once,
+// each suspended coroutine costs a frame, not a thread.
+//
+//   EngineReply reply = co_await engine.search(position, limits, stop);
+//   if (reply.cancelled) co_return;
+//
+// The position is copied when the request is submitted. The coroutine resumes
+// through the executor (e.g. a post to the Qt event loop); without one it
+// resumes on the pool's worker thread. Requests still queued when the pool is
+// destroyed never resume, so the pool has to outlive the coroutines that
+// still care about their answer.
+class AsyncEngine
+{
+public:
+    typedef std::function<void(std::function<void()>)> Executor;
+
+    explicit AsyncEngine(EnginePool &pool, Executor executor = Executor());
+
+    class SearchAwaiter
+    {
+    public:
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        EngineReply await_resume();
+
+    private:
+        friend class AsyncEngine;
+        SearchAwaiter(AsyncEngine *engine, const Position &position, const SearchLimits &limits, SearchStop stop);
+
+        AsyncEngine *engine;
+        Position position;
+        SearchLimits limits;
+        SearchStop stop;
+    };
+
+    // Continues the coroutine on the executor, e.g. to answer from a cache in
+    // the same order and on the same thread as a real search would
+    class ScheduleAwaiter
+    {
+    public:
+        bool await_ready() const noexcept { return !engine->executor; }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() noexcept {}
+
+    private:
+        friend class AsyncEngine;
+        explicit ScheduleAwaiter(AsyncEngine *engine) : engine(engine) {}
+
+        AsyncEngine *engine;
+    };
+
+    SearchAwaiter search(const Position &position, const SearchLimits &limits, SearchStop stop = SearchStop());
+    ScheduleAwaiter schedule() { return ScheduleAwaiter(this); }
+
+    int outstanding() const { return inFlight.load(std::memory_order_relaxed); }   // Beküldött, még nem folytatott kérések
+    EnginePool &enginePool() { return pool; }
+
+private:
+    void resume(std::coroutine_handle<> handle);
+
+    EnginePool &pool;
+    Executor executor;
+    std::atomic<int> inFlight { 0 };
+};
+
+#endif // ASYNCENGINE_H
@@ -0,0 +1,114 @@
+#include "attackmap.h"
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+// 0-3 egyenes, 4-7 átlós irányok; az ellentétes irány indexe direction ^ 1
+const int directionRows[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+const int directionCols[8] = { 0, 0, 1, -1, 1, -1, -1, 1 };
+const int knightRows[8] = { 2, 2, -2, -2, 1, 1, -1, -1 };
+const int knightCols[8] = { 1, -1, 1, -1, 2, -2, 2, -2 };
+
+bool onBoard(int row, int col)
+{
+    return row >= 0 && row < 8 && col >= 0 && col < 8;
+}
+
+bool slidesAlong(char piece, int direction)
+{
+    char type = char(std::tolower(piece));
+    return type == 'q' || (direction < 4 ? type == 'r' : type == 'b');
+}
+
+} // namespace
+
+void AttackMap::clear()
+{
+    std::memset(squares, ' ', sizeof(squares));
+    std::memset(counts, 0, sizeof(counts));
+    bits[0] = bits[1] = 0;
+}
+
+void AttackMap::set(int square, char piece)
+{
+    char old = squares[square];
+    if (old == piece) return;
+    if (old != ' ') addAttacks(square, old, -1);
+
+    // Ha a mező foglaltsága változik, az itt áthaladó vonalas támadások rövidülnek vagy hosszabbodnak
+    if ((old == ' ') != (piece == ' ')) {
+        int delta = piece == ' ' ? 1 : -1;
+        for (int direction = 0; direction < 8; ++direction) {
+            int back = direction ^ 1;
+            int row = square / 8 + directionRows[back], col = square % 8 + directionCols[back];
+            while (onBoard(row, col) && squares[row * 8 + col] == ' ') {
+                row += directionRows[back];
+                col += directionCols[back];
+            }
+            if (!onBoard(row, col)) continue;
+            char slider = squares[row * 8 + col];
+            if (slidesAlong(slider, direction)) addRay(std::isupper(slider) ? 0 : 1, square, direction, delta);
+        }
+    }
+
+    squares[square] = piece;
+    if (piece != ' ') addAttacks(square, piece, 1);
+}
+
+bool AttackMap::isHanging(int square) const
+{
+    char piece = squares[square];
+    if (piece == ' ') return false;
+    bool white = std::isupper(piece);
+    return isAttacked(square, !white) && !isAttacked(square, white);
+}
+
+void AttackMap::addAttacks(int square, char piece, int delta)
+{
+    int side = std::isupper(piece) ? 0 : 1;
+    int row = square / 8, col = square % 8;
+    switch (std::tolower(piece)) {
+    case 'p': {
+        int forward = side == 0 ? -1 : 1;   // A 0. sor a 8. sor, a fehér felfelé halad
+        if (onBoard(row + forward, col - 1)) touch(side, (row + forward) * 8 + col - 1, delta);
+        if (onBoard(row + forward, col + 1)) touch(side, (row + forward) * 8 + col + 1, delta);
+        break;
+    }
+    case 'n':
+        for (int i = 0; i < 8; ++i) {
+            if (onBoard(row + knightRows[i], col + knightCols[i])) touch(side, (row + knightRows[i]) * 8 + col + knightCols[i], delta);
+        }
+        break;
+    case 'k':
+        for (int direction = 0; direction < 8; ++direction) {
+            int toRow = row + directionRows[direction], toCol = col + directionCols[direction];
+            if (onBoard(toRow, toCol)) touch(side, toRow * 8 + toCol, delta);
+        }
+        break;
+    default:
+        for (int direction = 0; direction < 8; ++direction) {
+            if (slidesAlong(piece, direction)) addRay(side, square, direction, delta);
+        }
+        break;
+    }
+}
+
+void AttackMap::addRay(int side, int square, int direction, int delta)
+{
+    // A kiinduló mező után az első foglalt mezőig (azt is beleértve)
+    int row = square / 8 + directionRows[direction], col = square % 8 + directionCols[direction];
+    while (onBoard(row, col)) {
+        touch(side, row * 8 + col, delta);
+        if (squares[row * 8 + col] != ' ') break;
+        row += directionRows[direction];
+        col += directionCols[direction];
+    }
+}
+
+void AttackMap::touch(int side, int square, int delta)
+{
+    counts[side][square] = uint8_t(counts[side][square] + delta);
+    if (counts[side][square]) bits[side] |= uint64_t(1) << square;
+    else bits[side] &= ~(uint64_t(1) << square);
+}
@@ -0,0 +1,36 @@
+#ifndef ATTACKMAP_H
+#define ATTACKMAP_H
+
+#include <cstdint>
+
+// Per-side attack maps: for every square, how many pieces of each side attack
+// it, plus one bitboard per side of the attacked squares. Kept up to date
+// incrementally: changing one square updates the attacks of the piece on it
+// and the rook/bishop/queen rays passing through it, so "is this square
+// attacked" is a bit test instead of a ray walk.
+// Squares and pieces use the Position layout (row * 8 + col, 'P', 'n', ' ').
+class AttackMap
+{
+public:
+    AttackMap() { clear(); }
+
+    void clear();
+    void set(int square, char piece);   // ' ' = empty
+    char pieceAt(int square) const { return squares[square]; }
+
+    bool isAttacked(int square, bool byWhite) const { return (bits[byWhite ? 0 : 1] >> square) & 1; }
+    int attackCount(int square, bool byWhite) const { return counts[byWhite ? 0 : 1][square]; }
+    uint64_t attackedSquares(bool byWhite) const { return bits[byWhite ? 0 : 1]; }
+    bool isHanging(int square) const;   // Attacked by the enemy and not defended
+
+private:
+    void addAttacks(int square, char piece, int delta);
+    void addRay(int side, int square, int direction, int delta);
+    void touch(int side, int square, int delta);
+
+    char squares[64];
+    uint8_t counts[2][64];
+    uint64_t bits[2];
+};
+
+#endif // ATTACKMAP_H
@@ -0,0 +1,247 @@
+#include "widget.h"
+#include "chessgame.h"
+#include "uciengine.h"
+#include "position.h"
+#include "perft.h"
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+// Micro-benchmarks for the rules and rendering hot paths.
+//
+//   chess_bench [--json results.json] [--filter substring] [--min-time ms]
+//
+// Every benchmark is calibrated to run for at least --min-time per sample,
+// five samples are taken and the median is reported. The JSON output keeps a
+// fixed key order and benchmark order so two runs can be diffed directly.
+
+namespace {
+
+struct BenchmarkResult
+{
+    QString name;
+    qint64 iterations = 0;
+    double nsPerOp = 0;
+    QVector<double> samples;
+};
+
+const char *const benchmarkFens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP1B1PPP/R2QKB1R w KQ - 0 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+const char *const uciLines[] = {
+    "info depth 22 seldepth 31 multipv 1 score cp 34 nodes 2418211 nps 1209105 hashfull 421 tbhits 0 time 2000 "
+    "pv e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6 e1g1 f8e7",
+    "info depth 12 currmove d2d4 currmovenumber 3",
+    "bestmove e2e4 ponder e7e5",
+    "readyok",
+};
+
+BenchmarkResult runBenchmark(const QString &name, qint64 minTimeNs, const std::function<void()> &body)
+{
+    BenchmarkResult result;
+    result.name = name;
+
+    // Kalibráció: addig duplázzuk az ismétlésszámot, amíg egy minta eléri a minimális időt
+    qint64 iterations = 1;
+    QElapsedTimer timer;
+    while (true) {
+        timer.start();
+        for (qint64 i = 0; i < iterations; ++i) body();
+        qint64 elapsed = timer.nsecsElapsed();
+        if (elapsed >= minTimeNs || iterations >= (qint64(1) << 40)) break;
+        iterations *= elapsed > 0 ? qBound<qint64>(2, minTimeNs / elapsed + 1, 16) : 16;
+    }
+
+    for (int sample = 0; sample < 5; ++sample) {
+        timer.start();
+        for (qint64 i = 0; i < iterations; ++i) body();
+        result.samples.append(double(timer.nsecsElapsed()) / double(iterations));
+    }
+
+    QVector<double> sorted = result.samples;
+    std::sort(sorted.begin(), sorted.end());
+    result.nsPerOp = sorted[sorted.size() / 2];
+    result.iterations = iterations;
+    return result;
+}
+
+void discardMessages(QtMsgType, const QMessageLogContext &, const QString &) {}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Képernyő nélkül is fusson (CI)
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QString jsonPath;
+    QString filter;
+    qint64 minTimeNs = 100 * 1000 * 1000;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--json" && i + 1 < args.size()) jsonPath = args[++i];
+        else if (args[i] == "--filter" && i + 1 < args.size()) filter = args[++i];
+        else if (args[i] == "--min-time" && i + 1 < args.size()) minTimeNs = args[++i].toLongLong() * 1000 * 1000;
+    }
+
+    // A qDebug kimenet mérése nem cél, a konzol I/O elnyomná az eredményeket
+    qInstallMessageHandler(discardMessages);
+
+    Widget widget;
+    widget.resize(800, 610);
+    widget.isStarted = true;
+    ChessGame game;
+    UCIEngine engine;
+    Position position;
+
+    struct Benchmark
+    {
+        QString name;
+        std::function<void()> setup;
+        std::function<void()> body;
+    };
+    std::vector<Benchmark> benchmarks;
+    auto noSetup = []() {};
+
+    benchmarks.push_back({ "rules/isSquareAttacked", [&]() { game.setFen(benchmarkFens[1]); }, [&]() {
+        int attacked = 0;
+        for (int row = 0; row < 8; ++row)
+            for (int col = 0; col < 8; ++col)
+                attacked += game.isSquareAttacked(row, col, true) + game.isSquareAttacked(row, col, false);
+        volatile int sink = attacked;
+        (void)sink;
+    } });
+
+    // Bábunkénti generálás a Position generátorával; a nevek a régi eredményekkel összevethetők maradnak
+    const char pieceTypes[] = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+    const char *pieceNames[] = { "pawn", "knight", "bishop", "rook", "queen", "king" };
+    Position kiwipete;
+    kiwipete.setFen(benchmarkFens[1]);
+    for (int type = 0; type < 6; ++type) {
+        QVector<int> squares;
+        for (int square = 0; square < 64; ++square) {
+            if (kiwipete.pieceAt(square) == pieceTypes[type]) squares.append(square);
+        }
+        benchmarks.push_back({ QString("movegen/game_%1").arg(pieceNames[type]),
+                               [&]() { position.setFen(benchmarkFens[1]); },
+                               [&position, squares]() {
+            MoveList list;
+            for (int square : squares) position.generatePieceMoves(square, list);
+            volatile int sink = list.count;
+            (void)sink;
+        } });
+    }
+
+    benchmarks.push_back({ "movegen/position_pseudo_legal", [&]() { position.setFen(benchmarkFens[1]); }, [&]() {
+        MoveList list;
+        position.generateCaptures(list);
+        position.generateQuiets(list);
+        volatile int sink = list.count;
+        (void)sink;
+    } });
+
+    benchmarks.push_back({ "legal/filterIllegalMoves", [&]() { game.setFen(benchmarkFens[1]); }, [&]() {
+        int count = 0;
+        for (int row = 0; row < 8; ++row) {
+            for (int col = 0; col < 8; ++col) {
+                if (!game.isOwnPiece(row, col)) continue;
+                game.selectedRow = row;
+                game.selectedCol = col;
+                count += game.getLegalMoves(row, col).size();
+            }
+        }
+        game.selectedRow = game.selectedCol = -1;
+        volatile int sink = count;
+        (void)sink;
+    } });
+
+    benchmarks.push_back({ "legal/position_generateLegal", [&]() { position.setFen(benchmarkFens[1]); }, [&]() {
+        MoveList list;
+        position.generateLegal(list);
+        volatile int sink = list.count;
+        (void)sink;
+    } });
+
+    benchmarks.push_back({ "perft/kiwipete_3", [&]() { position.setFen(benchmarkFens[1]); }, [&]() {
+        volatile uint64_t sink = perft(position, 3);
+        (void)sink;
+    } });
+
+    // A checkGameOver útja: egy outcome() és a rá épülő kérdések; az állás nem változik, így a tárolt eredményből
+    benchmarks.push_back({ "gameover/checkmate_stalemate_draw", [&]() { game.setFen(benchmarkFens[2]); }, [&]() {
+        volatile int sink = int(game.outcome()) + game.isCheckmate() + game.isStalemate() + game.isDraw();
+        (void)sink;
+    } });
+
+    // Új állásonként egyszer fizetjük: teljes legális lépésgenerálás
+    benchmarks.push_back({ "gameover/outcome_uncached", [&]() { position.setFen(benchmarkFens[2]); }, [&]() {
+        volatile int sink = int(position.outcome());
+        (void)sink;
+    } });
+
+    benchmarks.push_back({ "fen/parse", noSetup, [&]() {
+        for (const char *fen : benchmarkFens) position.setFen(fen);
+    } });
+
+    benchmarks.push_back({ "uci/processLine", noSetup, [&]() {
+        for (const char *line : uciLines) engine.processLine(QString::fromLatin1(line));
+    } });
+
+    benchmarks.push_back({ "render/paintEvent", [&]() { widget.setFen(benchmarkFens[1]); }, [&]() {
+        static QImage image(800, 610, QImage::Format_ARGB32_Premultiplied);
+        // Csak maga a tábla, a gyerek widgetek (gombok, címkék) nélkül
+        widget.render(&image, QPoint(), QRegion(), QWidget::DrawWindowBackground);
+    } });
+
+    QVector<BenchmarkResult> results;
+    QTextStream out(stdout);
+    for (const Benchmark &benchmark : benchmarks) {
+        if (!filter.isEmpty() && !benchmark.name.contains(filter)) continue;
+        benchmark.setup();
+        BenchmarkResult result = runBenchmark(benchmark.name, minTimeNs, benchmark.body);
+        out << QString("%1 %2 ns/op (%3 iterations)\n")
+                   .arg(result.name, -36)
+                   .arg(result.nsPerOp, 12, 'f', 1)
+                   .arg(result.iterations);
+        out.flush();
+        results.append(result);
+    }
+
+    if (!jsonPath.isEmpty()) {
+        QJsonArray array;
+        for (const BenchmarkResult &result : results) {
+            QJsonObject object;
+            object["name"] = result.name;
+            object["ns_per_op"] = result.nsPerOp;
+            object["iterations"] = result.iterations;
+            QJsonArray samples;
+            for (double sample : result.samples) samples.append(sample);
+            object["samples"] = samples;
+            array.append(object);
+        }
+        QJsonObject root;
+        root["version"] = 1;
+        root["benchmarks"] = array;
+
+        QFile file(jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            out << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "boardrendercache.h"
+#include <QPainter>
+
+namespace {
+
+QString pieceGlyph(char piece)
+{
+    switch (piece) {
+    case 'K': return "\u2654";
+    case 'Q': return "\u2655";
+    case 'R': return "\u2656";
+    case 'B': return "\u2657";
+    case 'N': return "\u2658";
+    case 'P': return "\u2659";
+    case 'k': return "\u265A";
+    case 'q': return "\u265B";
+    case 'r': return "\u265C";
+    case 'b': return "\u265D";
+    case 'n': return "\u265E";
+    case 'p': return "\u265F";
+    }
+    return QString();
+}
+
+} // namespace
+
+void BoardRenderCache::clear()
+{
+    cachedSize = 0;
+    boardPixmap = QPixmap();
+    piecePixmaps.clear();
+}
+
+void BoardRenderCache::ensureSize(int squareSize)
+{
+    if (squareSize == cachedSize) return;
+    clear();
+    cachedSize = squareSize;
+}
+
+const QPixmap &BoardRenderCache::background(int squareSize)
+{
+    ensureSize(squareSize);
+    if (boardPixmap.isNull()) {
+        boardPixmap = QPixmap(squareSize * 8, squareSize * 8);
+        QPainter painter(&boardPixmap);
+        painter.setPen(Qt::NoPen);
+        for (int row = 0; row < 8; ++row) {
+            for (int col = 0; col < 8; ++col) {
+                painter.setBrush((row + col) % 2 == 0 ? Qt::white : Qt::gray);
+                painter.drawRect(col * squareSize, row * squareSize, squareSize, squareSize);
+            }
+        }
+    }
+    return boardPixmap;
+}
+
+const QPixmap &BoardRenderCache::piece(char piece, int squareSize)
+{
+    ensureSize(squareSize);
+    auto it = piecePixmaps.find(piece);
+    if (it == piecePixmaps.end()) {
+        QPixmap pixmap(squareSize, squareSize);
+        pixmap.fill(Qt::transparent);
+        QPainter painter(&pixmap);
+        // Ugyanaz a betűtípus arány, mint a fő táblán (36 pt 75 px-es mezőn)
+        QFont font("Arial");
+        font.setPixelSize(qMax(6, squareSize * 2 / 3));
+        painter.setFont(font);
+        painter.setPen(Qt::black);
+        painter.drawText(QRect(0, 0, squareSize, squareSize), Qt::AlignCenter, pieceGlyph(piece));
+        it = piecePixmaps.insert(piece, pixmap);
+    }
+    return it.value();
+}
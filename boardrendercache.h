@@ -0,0 +1,25 @@
+#ifndef BOARDRENDERCACHE_H
+#define BOARDRENDERCACHE_H
+
+#include <QPixmap>
+#include <QHash>
+
+// Pre-rendered board backgrounds and piece glyphs, shared by every board of
+// the multi-board view. Text rendering of the Unicode pieces is by far the most
+// expensive part of a board paint, so every glyph is drawn once per square size.
+class BoardRenderCache
+{
+public:
+    const QPixmap &background(int squareSize);
+    const QPixmap &piece(char piece, int squareSize);
+    void clear();
+
+private:
+    int cachedSize = 0;
+    QPixmap boardPixmap;
+    QHash<char, QPixmap> piecePixmaps;
+
+    void ensureSize(int squareSize);
+};
+
+#endif // BOARDRENDERCACHE_H
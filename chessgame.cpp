@@ -0,0 +1,140 @@
+#include "chessgame.h"
+#include "logger.h"
+#include <cctype>
+
+ChessGame::ChessGame()
+{
+    board.setAttackTracking(true);   // A sakk- és sáncvizsgálat, valamint a kiemelés a támadási térképből olvas
+    initializeBoard();
+}
+
+void ChessGame::initializeBoard()
+{
+    board.setStartPosition();
+    reset();
+    stepsCount = 0;
+}
+
+bool ChessGame::setFen(const QString &fen)
+{
+    Position position;
+    if (!position.setFen(fen.toStdString())) {
+        LOG_WARNING("invalid_fen", {"fen", fen});
+        return false;
+    }
+    setPosition(position);
+    return true;
+}
+
+void ChessGame::setPosition(const Position &position)
+{
+    board = position;
+    board.setAttackTracking(true);
+    reset();
+}
+
+void ChessGame::reset()
+{
+    outcomePly = -1;   // Új játszma: más előzmény, más ismétlésszám
+    moveHistory.clear();
+    possibleMoves.clear();
+    selectedRow = -1;
+    selectedCol = -1;
+}
+
+int ChessGame::evaluate() const
+{
+    return board.evaluation().evaluate(board.whiteToMove());
+}
+
+void ChessGame::highlightMoves(int row, int col)
+{
+    possibleMoves.clear();
+    if (!isOwnPiece(row, col)) return;
+
+    MoveList legal;
+    board.generateLegal(legal);
+    int from = row * 8 + col;
+    for (int i = 0; i < legal.count; ++i) {
+        if (moveFrom(legal.moves[i]) != from) continue;
+        int to = moveTo(legal.moves[i]);
+        possibleMoves.insert({to / 8, to % 8});   // A négy átváltozás egy célmező
+    }
+}
+
+QVector<QPair<int, int>> ChessGame::getLegalMoves(int row, int col)
+{
+    selectedRow = row;
+    selectedCol = col;
+    highlightMoves(row, col);
+    return possibleMoves.values().toVector();
+}
+
+void ChessGame::filterIllegalMoves()
+{
+    // Kívülről (HighlightPieces) összerakott halmaz: csak a kiválasztott bábu legális lépései maradnak
+    QSet<QPair<int, int>> candidates = possibleMoves;
+    highlightMoves(selectedRow, selectedCol);
+    possibleMoves.intersect(candidates);
+}
+
+bool ChessGame::isSquareAttacked(int row, int col, bool isWhite) const
+{
+    // isWhite a megtámadott fél: az ellenfél támadási térképében egy bit
+    return board.isSquareAttacked(row * 8 + col, !isWhite);
+}
+
+bool ChessGame::isOwnPiece(int row, int col) const
+{
+    if (row < 0 || row >= 8 || col < 0 || col >= 8) return false;
+    char piece = board.pieceAt(row * 8 + col);
+    if (piece == ' ') return false;
+    return bool(std::isupper(static_cast<unsigned char>(piece))) == board.whiteToMove();
+}
+
+bool ChessGame::applyMove(const QString &move)
+{
+    std::string uci = move.toStdString();
+    Move parsed = board.parseUciMove(uci);
+    if (parsed == NoMove && uci.size() == 4) parsed = board.parseUciMove(uci + 'q');   // A GUI nem kérdez rá
+
+    possibleMoves.clear();
+    selectedRow = -1;
+    selectedCol = -1;
+    if (parsed == NoMove || !board.makeMove(parsed)) {
+        LOG_WARNING("illegal_move", {"move", move});
+        return false;
+    }
+
+    moveHistory.append(QString::fromStdString(Position::moveToUci(parsed)));
+    return true;
+}
+
+GameOutcome ChessGame::outcome()
+{
+    // Ugyanabban a játszmában a kulcs és a lépésszám együtt az előzményt is azonosítja
+    if (outcomePly != board.ply() || outcomeKey != board.key()) {
+        cachedOutcome = board.outcome();
+        outcomeKey = board.key();
+        outcomePly = board.ply();
+    }
+    return cachedOutcome;
+}
+
+bool ChessGame::isCheckmate()
+{
+    return outcome() == GameOutcome::Checkmate;
+}
+
+bool ChessGame::isStalemate()
+{
+    return outcome() == GameOutcome::Stalemate;
+}
+
+bool ChessGame::isDraw()
+{
+    // Anyaghiány, háromszori ismétlés vagy ötven lépés szabály
+    GameOutcome result = outcome();
+    return result == GameOutcome::FiftyMoves || result == GameOutcome::Repetition ||
+           result == GameOutcome::InsufficientMaterial;
+}
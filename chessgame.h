@@ -0,0 +1,61 @@
+#ifndef CHESSGAME_H
+#define CHESSGAME_H
+
+#include <QVector>
+#include <QSet>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include "position.h"
+
+// A Widget táblanézete grafikus felület nélkül (csak QtCore). A szabályokat
+// (sánc, en passant, átváltozás, matt/patt/döntetlen) a Position adja, itt
+// csak a kijelölés, a kiemelt lépések és a lépéstörténet él.
+class ChessGame
+{
+public:
+    ChessGame();
+    void initializeBoard();
+    bool setFen(const QString &fen);
+    void setPosition(const Position &position);   // A lépéstörténetet (ismétlés) is átveszi
+    const Position &position() const { return board; }
+    char pieceAt(int row, int col) const { return board.pieceAt(row * 8 + col); }
+    bool isWhiteTurn() const { return board.whiteToMove(); }
+    const Evaluation &evaluation() const { return board.evaluation(); }
+    int evaluate() const;
+
+    // A kiválasztott bábu legális célmezői a possibleMoves halmazba kerülnek
+    void highlightMoves(int row, int col);
+    QVector<QPair<int, int>> getLegalMoves(int row, int col);
+    void filterIllegalMoves();
+    bool isSquareAttacked(int row, int col, bool isWhite) const;
+    bool isOwnPiece(int row, int col) const;
+    const AttackMap &attacks() const { return board.attacks(); }   // Mindkét fél támadásai
+
+    // UCI formátumú lépés ("e2e4", "e7e8q") ellenőrzése és végrehajtása;
+    // átváltozás betű nélkül vezérré
+    bool applyMove(const QString &move);
+
+    // A szabály szerinti eredmény; a legális lépések generálása állásonként
+    // (kulcs és lépésszám) egyszer fut, a három kérdés ebből olvas
+    GameOutcome outcome();
+    bool isCheckmate();
+    bool isStalemate();
+    bool isDraw();
+
+    QSet<QPair<int, int>> possibleMoves;
+    int selectedRow = -1;
+    int selectedCol = -1;
+    QStringList moveHistory;
+    int stepsCount = 0;
+
+private:
+    void reset();
+
+    Position board;
+    uint64_t outcomeKey = 0;
+    int outcomePly = -1;   // -1 = nincs tárolt eredmény
+    GameOutcome cachedOutcome = GameOutcome::Ongoing;
+};
+
+#endif // CHESSGAME_H
@@ -0,0 +1,221 @@
+#include "selfplay.h"
+#include "uciengine.h"
+#include "task.h"
+#include "logger.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// Self-play training data generator.
+//
+//   chess_datagen [--threads n] [--games n] [--depth d] [--hash mb] [--seed n]
+//                 [--random-plies n] [--min-ply n] [--max-score cp]
+//                 [--engine path [--movetime ms]] out.ctd
+//   chess_datagen --dump data.ctd [--limit n]
+//
+// Plays self-play games on every core, with the in-process search by default
+// or with one UCI engine process per thread (--engine), and appends the quiet
+// positions to out.ctd (format in trainingdata.h). Progress and the summary,
+// including positions/s per core, go to stderr. --dump prints the samples as
+// "<fen>;<score>;<result>" lines.
+
+namespace {
+
+void report(QTextStream &err, const SelfPlayStats &stats, double seconds, int cores)
+{
+    double positionsPerSecond = seconds > 0 ? stats.positions.load() / seconds : 0.0;
+    double busy = double(stats.engineBusyNs.load()) / 1e9;
+    err << QString("games %1 (1-0 %2, 0-1 %3, draws %4), plies %5, positions %6, skipped %7\n")
+               .arg(stats.games.load()).arg(stats.results[int(GameResult::WhiteWins)].load())
+               .arg(stats.results[int(GameResult::BlackWins)].load()).arg(stats.results[int(GameResult::Draw)].load())
+               .arg(stats.plies.load()).arg(stats.positions.load()).arg(stats.skipped.load());
+    err << QString("%1 s, %2 positions/s, %3 positions/s/core on %4 cores, engine utilization %5%\n")
+               .arg(seconds, 0, 'f', 1)
+               .arg(positionsPerSecond, 0, 'f', 1)
+               .arg(positionsPerSecond / cores, 0, 'f', 1)
+               .arg(cores)
+               .arg(seconds > 0 ? 100.0 * busy / (seconds * cores) : 0.0, 0, 'f', 1);
+    err.flush();
+}
+
+int dump(const QString &path, quint64 limit)
+{
+    QTextStream err(stderr);
+    TrainingDataReader reader;
+    if (!reader.open(path.toStdString())) {
+        err << "Cannot read " << path << "\n";
+        return 1;
+    }
+
+    TrainingSample sample;
+    quint64 samples = 0;
+    quint64 results[4] = {};
+    double scoreSum = 0;
+    while ((limit == 0 || samples < limit) && reader.next(sample)) {
+        ++samples;
+        ++results[int(TrainingData::result(sample))];
+        scoreSum += TrainingData::score(sample);
+        std::cout << TrainingData::fen(sample) << ';' << TrainingData::score(sample) << ';'
+                  << GameArchive::resultString(TrainingData::result(sample)) << '\n';
+    }
+    err << QString("%1 of %2 samples, 1-0 %3, 0-1 %4, draws %5, mean score %6\n")
+               .arg(samples).arg(reader.size()).arg(results[1]).arg(results[2]).arg(results[3])
+               .arg(samples ? scoreSum / samples : 0.0, 0, 'f', 1);
+    return 0;
+}
+
+// Egy külső motor és az éppen játszott játszmája; minden a fő szál eseményhurkán fut
+struct UciPlayer
+{
+    UCIEngine *engine = nullptr;
+    bool done = false;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    DataGenerator::Options options;
+    QString enginePath;
+    QString dumpPath;
+    int movetime = 50;
+    quint64 limit = 0;
+    QStringList files;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        bool hasValue = i + 1 < args.size();
+        if (args[i] == "--threads" && hasValue) options.threads = args[++i].toInt();
+        else if (args[i] == "--games" && hasValue) options.games = args[++i].toULongLong();
+        else if (args[i] == "--depth" && hasValue) options.depth = args[++i].toInt();
+        else if (args[i] == "--hash" && hasValue) options.hashSizeMb = args[++i].toInt();
+        else if (args[i] == "--seed" && hasValue) options.seed = args[++i].toULongLong();
+        else if (args[i] == "--random-plies" && hasValue) options.game.randomPlies = args[++i].toInt();
+        else if (args[i] == "--min-ply" && hasValue) options.game.minPly = args[++i].toInt();
+        else if (args[i] == "--max-score" && hasValue) options.game.maxScore = args[++i].toInt();
+        else if (args[i] == "--engine" && hasValue) enginePath = args[++i];
+        else if (args[i] == "--movetime" && hasValue) movetime = args[++i].toInt();
+        else if (args[i] == "--dump" && hasValue) dumpPath = args[++i];
+        else if (args[i] == "--limit" && hasValue) limit = args[++i].toULongLong();
+        else files.append(args[i]);
+    }
+
+    if (!dumpPath.isEmpty()) return dump(dumpPath, limit);
+
+    QTextStream err(stderr);
+    if (files.isEmpty()) {
+        err << "usage: chess_datagen [options] out.ctd | chess_datagen --dump data.ctd\n";
+        return 2;
+    }
+
+    Log::Level logLevel = Log::levelFromName(qEnvironmentVariable("CHESS_LOG_LEVEL", "off").toStdString());
+    if (logLevel != Log::Off) Log::start(qEnvironmentVariable("CHESS_LOG", "chess_datagen.log").toStdString(), logLevel);
+
+    TrainingDataWriter writer;
+    if (!writer.open(files[0].toStdString())) {
+        err << "Cannot write " << files[0] << "\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed = [&start]() { return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); };
+    const int ReportMs = 10000;
+
+    if (enginePath.isEmpty()) {
+        DataGenerator generator(options);
+        std::atomic<bool> finished { false };
+        std::thread runner([&]() {
+            generator.run(writer);
+            finished = true;
+        });
+        auto lastReport = std::chrono::steady_clock::now();
+        while (!finished) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (std::chrono::steady_clock::now() - lastReport >= std::chrono::milliseconds(ReportMs)) {
+                report(err, generator.stats(), elapsed(), generator.threadCount());
+                lastReport = std::chrono::steady_clock::now();
+            }
+        }
+        runner.join();
+        writer.close();
+        report(err, generator.stats(), elapsed(), generator.threadCount());
+        Log::stop();
+        return 0;
+    }
+
+    // Külső motorral: szálanként egy motorfolyamat és egy korutin, amely a saját kéréseire vár
+    int threads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    EngineSettings settings;
+    settings.path = enginePath;
+    settings.hash = options.hashSizeMb;
+    settings.threads = 1;
+
+    SelfPlayStats stats;
+    quint64 nextGame = 0;
+    std::vector<UciPlayer> players(static_cast<size_t>(threads));
+
+    SearchLimits limits;
+    limits.movetime = movetime;
+
+    auto finishPlayer = [&](UciPlayer &player) {
+        player.done = true;
+        for (const UciPlayer &other : players) {
+            if (!other.done) return;
+        }
+        app.quit();
+    };
+    // A lambda main végéig él, így a korutin kerete a befogott referenciákat használhatja
+    auto play = [&](UciPlayer &player) -> Task<> {
+        while (nextGame < options.games) {
+            SelfPlayGame game(options.game, DataGenerator::gameSeed(options.seed, nextGame++));
+            player.engine->startNewGame();
+            while (!game.isOver()) {
+                Position &position = game.position();
+                QStringList moves;
+                for (int i = 0; i < position.ply(); ++i) moves << QString::fromStdString(Position::moveToUci(position.historyMove(i)));
+                QElapsedTimer searchClock;
+                searchClock.start();
+                UciReply reply = co_await player.engine->search(moves, QString(), limits);
+                if (reply.cancelled) {   // A motor kiesett (engineFailed)
+                    finishPlayer(player);
+                    co_return;
+                }
+                stats.engineBusyNs += quint64(searchClock.nsecsElapsed());
+                Move move = position.parseUciMove(reply.bestMove.toStdString());
+                if (!game.play(move, reply.info.score, reply.info.mate))
+                    LOG_WARNING("datagen_illegal_engine_move", {"move", reply.bestMove});
+            }
+            stats.add(game);
+            writer.append(std::move(game.samples()));
+        }
+        finishPlayer(player);
+    };
+
+    for (UciPlayer &player : players) {
+        player.engine = new UCIEngine(&app);
+        player.engine->setSettings(settings);
+        QObject::connect(player.engine, &UCIEngine::engineFailed, &app, [&]() {
+            LOG_ERROR("datagen_engine_failed", {"path", enginePath});
+        });
+        player.engine->startEngine();   // A parancsok az uciok-ig sorban várnak
+        play(player);                   // Eldobott Task: a korutin a saját végéig fut
+    }
+
+    QTimer progress;
+    QObject::connect(&progress, &QTimer::timeout, &app, [&]() { report(err, stats, elapsed(), threads); });
+    progress.start(ReportMs);
+    bool running = false;
+    for (const UciPlayer &player : players) running = running || !player.done;
+    if (running) app.exec();   // Nulla játszmánál a quit() még az eseményhurok előtt jött
+
+    writer.close();
+    report(err, stats, elapsed(), threads);
+    Log::stop();
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "enginepool.h"
+#include "trace.h"
+
+EnginePool::EnginePool(int threads, int hashSizeMb)
+{
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+
+    running.assign(size_t(threads), 0);
+    aborts.reset(new std::atomic<bool>[size_t(threads)]);
+    for (int i = 0; i < threads; ++i) {
+        aborts[i] = false;
+        searches.emplace_back(new Search(hashSizeMb));
+        searches.back()->setAbortFlag(&aborts[i]);
+    }
+    for (int i = 0; i < threads; ++i) workers.emplace_back(&EnginePool::run, this, i);
+}
+
+EnginePool::~EnginePool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();   // A még el nem kezdett kéréseket eldobjuk
+    }
+    for (auto &search : searches) search->stop();
+    wakeUp.notify_all();
+    for (auto &worker : workers) worker.join();
+}
+
+EnginePool::JobId EnginePool::submit(const Position &position, const SearchLimits &limits, Callback callback)
+{
+    JobId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        jobs.push_back({ id, position, limits, std::move(callback) });
+    }
+    wakeUp.notify_one();
+    return id;
+}
+
+bool EnginePool::cancel(JobId id)
+{
+    Callback dropped;   // A zár elengedése után szűnik meg (a lambda elkapott állapota bármi lehet)
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = jobs.begin(); it != jobs.end(); ++it) {
+        if (it->id == id) {
+            dropped = std::move(it->callback);
+            jobs.erase(it);
+            return true;
+        }
+    }
+    // Fut: a jelzőt a keresés a következő óraellenőrzésnél látja, a run() a következő feladatnál törli
+    for (size_t i = 0; i < running.size(); ++i) {
+        if (running[i] == id) aborts[i] = true;
+    }
+    return false;
+}
+
+int EnginePool::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return int(jobs.size());
+}
+
+void EnginePool::run(int index)
+{
+    if (Trace::enabled()) Trace::setThreadName("engine pool");
+    Search &search = *searches[index];
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this]() { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            running[index] = job.id;
+            aborts[index] = false;
+        }
+
+        // Minden kérés külön játszmából jöhet, a régi hash bejegyzések itt is hasznosak maradnak
+        SearchResult result = search.think(job.position, job.limits);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running[index] = 0;
+        }
+        job.callback(result);
+    }
+}
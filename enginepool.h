@@ -0,0 +1,56 @@
+#ifndef ENGINEPOOL_H
+#define ENGINEPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "search.h"
+
+// Fixed set of worker threads, each with its own Search (and hash table).
+// Jobs are taken in FIFO order; the callback runs on the worker thread, so
+// callers that live in a Qt event loop should post the result back themselves
+// (or use AsyncEngine, which does it for coroutines).
+class EnginePool
+{
+public:
+    typedef std::function<void(const SearchResult &)> Callback;
+    typedef uint64_t JobId;
+
+    explicit EnginePool(int threads = 0, int hashSizeMb = 4);   // 0 = hardware threads
+    ~EnginePool();
+
+    JobId submit(const Position &position, const SearchLimits &limits, Callback callback);
+    // A queued job is removed without calling its callback (returns true); a
+    // running one stops early and reports the best move found so far
+    bool cancel(JobId id);
+    int threadCount() const { return int(workers.size()); }
+    int pending() const;
+
+private:
+    struct Job
+    {
+        JobId id;
+        Position position;
+        SearchLimits limits;
+        Callback callback;
+    };
+
+    void run(int index);
+
+    std::vector<std::unique_ptr<Search>> searches;
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::vector<JobId> running;                  // Szálanként, 0 = szabad
+    std::unique_ptr<std::atomic<bool>[]> aborts; // Szálanként, a Search óraellenőrzése figyeli
+    JobId nextId = 1;
+    mutable std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+};
+
+#endif // ENGINEPOOL_H
@@ -0,0 +1,40 @@
+#ifndef EVALUATION_H
+#define EVALUATION_H
+
+// Tapered (midgame/endgame) piece-square evaluation.
+// The scores are kept up to date incrementally: the owner of the board calls
+// addPiece/removePiece/movePiece for every square it changes, so neither the
+// evaluation nor the material counters ever need a full board scan.
+class Evaluation
+{
+public:
+    Evaluation();
+
+    void clear();
+    void addPiece(char piece, int row, int col);
+    void removePiece(char piece, int row, int col);
+    void movePiece(char piece, int fromRow, int fromCol, int toRow, int toCol);
+
+    int evaluate(bool whiteToMove) const;   // Centipawns from the side to move's point of view
+    int whiteScore() const;                  // Centipawns from White's point of view
+    int phase() const;                       // 24 = full midgame, 0 = bare kings and pawns
+    int material(bool white) const;          // Midgame material without kings
+    int pieceCount(bool white) const;        // All pieces including the king
+    int count(char piece) const;
+    int bishopsOnSquareColor(int squareColor) const;   // 0 = light, 1 = dark (same as (row + col) % 2)
+    bool isInsufficientMaterial() const;
+
+    static int pieceValue(char piece);
+
+private:
+    static int pieceIndex(char piece);
+
+    int midgame = 0;
+    int endgame = 0;
+    int gamePhase = 0;
+    int counts[12];
+    int bishopColors[2];
+    int materialValue[2];
+};
+
+#endif // EVALUATION_H
@@ -0,0 +1,18 @@
+#include "fileappender.h"
+#include <filesystem>
+
+bool truncateTornTail(const std::string &path, uint64_t validSize)
+{
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error) return error == std::errc::no_such_file_or_directory;   // Nincs mit levágni
+    if (size <= validSize) return true;
+    // Hozzáfűzésre nyitott fájlnál is jó: a következő írás az új végre kerül
+    std::filesystem::resize_file(path, validSize, error);
+    if (error) {
+        LOG_ERROR("truncate_failed", {"path", path}, {"error", error.message()});
+        return false;
+    }
+    LOG_WARNING("torn_tail_truncated", {"path", path}, {"bytes", size - validSize});
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef FILEAPPENDER_H
+#define FILEAPPENDER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include "boundedqueue.h"
+#include "trace.h"
+#include "logger.h"
+
+// Cuts everything after validSize off the file: a record torn by a crash (or
+// a half written header, validSize = 0) would otherwise shift every record
+// appended after it. Logs what was removed; false if the file could not be cut.
+bool truncateTornTail(const std::string &path, uint64_t validSize);
+
+// Appends records to a file from a background thread. append() only queues;
+// the thread encodes everything queued so far into one buffer and writes it
+// with a single fwrite and fflush. Used by the game archive, the training data
+// and the analysis cache writers, which only differ in the record encoding.
+//
+// append() waits while capacity records are queued, so a bulk producer is
+// slowed down to the disk's pace. Writers whose callers must never wait (GUI
+// thread, server event loop) pass Unbounded: their records are small and rare,
+// and a stalled disk costs memory instead of a frozen caller or lost records.
+template<class T>
+class FileAppender
+{
+public:
+    typedef std::function<void(const T &, std::string &)> Encoder;
+    static const size_t Unbounded = SIZE_MAX;
+
+    FileAppender(Encoder encode, const char *threadName, size_t capacity)
+        : encode(std::move(encode)), threadName(threadName), capacity(capacity) {}
+    ~FileAppender() { close(); }
+
+    // Opens the file for appending and writes the header if it is empty.
+    // prepare runs on the writer thread before the first write (e.g. a scan
+    // that is too slow for the caller's thread).
+    bool open(const std::string &path, const std::string &header, std::function<void()> prepare = {})
+    {
+        close();
+        file = std::fopen(path.c_str(), "ab");
+        if (!file) return false;
+        std::fseek(file, 0, SEEK_END);
+        if (std::ftell(file) == 0 && !header.empty()) {
+            std::fwrite(header.data(), 1, header.size(), file);
+            std::fflush(file);
+        }
+        filePath = path;
+        queue.reset(new BoundedQueue<T>(capacity));   // Lezárás után nem nyitható újra
+        writer = std::thread(&FileAppender::run, this, std::move(prepare));
+        return true;
+    }
+
+    void append(T item)
+    {
+        if (file) queue->push(std::move(item));
+    }
+
+    // Writes what is queued, then stops the thread
+    void close()
+    {
+        if (!file) return;
+        queue->close();
+        writer.join();
+        std::fclose(file);
+        file = nullptr;
+    }
+
+    bool isOpen() const { return file != nullptr; }
+    uint64_t recordsWritten() const { return records.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return bytes.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t BatchBytes = 1 << 20;
+
+    void run(std::function<void()> prepare)
+    {
+        if (Trace::enabled()) Trace::setThreadName(threadName);
+        if (prepare) prepare();
+        std::string buffer;
+        T item;
+        while (queue->pop(item)) {
+            TRACE_SCOPE(threadName);
+            // Ami közben összegyűlt, egyetlen írással megy ki
+            buffer.clear();
+            uint64_t count = 0;
+            do {
+                encode(item, buffer);
+                ++count;
+            } while (buffer.size() < BatchBytes && queue->tryPop(item));
+
+            if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size() || std::fflush(file) != 0)
+                LOG_ERROR("append_write_failed", {"path", filePath}, {"bytes", uint64_t(buffer.size())});
+            records.fetch_add(count, std::memory_order_relaxed);
+            bytes.fetch_add(buffer.size(), std::memory_order_relaxed);
+        }
+    }
+
+    const Encoder encode;
+    const char *const threadName;
+    const size_t capacity;
+    FILE *file = nullptr;
+    std::string filePath;
+    std::unique_ptr<BoundedQueue<T>> queue;
+    std::thread writer;
+    std::atomic<uint64_t> records { 0 };
+    std::atomic<uint64_t> bytes { 0 };
+};
+
+#endif // FILEAPPENDER_H
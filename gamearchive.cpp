@@ -0,0 +1,373 @@
+#include "gamearchive.h"
+#include "logger.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace {
+
+const char ArchiveMagic[4] = { 'C', 'G', 'A', '1' };
+const char JournalMagic[4] = { 'C', 'G', 'J', '1' };
+const size_t HeaderSize = 12;
+const size_t MaxRecordSize = HeaderSize + 3 * 256 + 2 * 65535;   // FEN, két név, 65535 lépés
+const uint8_t HasFen = 1;
+const uint8_t HasNames = 2;
+const char *const StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+void put16(std::string &out, uint16_t value)
+{
+    out += char(value & 0xFF);
+    out += char(value >> 8);
+}
+
+void put32(std::string &out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i) out += char((value >> (8 * i)) & 0xFF);
+}
+
+uint16_t get16(const char *data)
+{
+    return uint16_t(uint8_t(data[0]) | (uint8_t(data[1]) << 8));
+}
+
+uint32_t get32(const char *data)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= uint32_t(uint8_t(data[i])) << (8 * i);
+    return value;
+}
+
+void putString(std::string &out, const std::string &text)
+{
+    size_t length = text.size() < 255 ? text.size() : 255;
+    out += char(length);
+    out.append(text, 0, length);
+}
+
+uint32_t fnv1a(const char *data, size_t size, uint32_t hash = 2166136261u)
+{
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= uint8_t(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct ArchiveScan
+{
+    uint64_t validEnd = sizeof(ArchiveMagic);   // Az utolsó ép rekord vége
+    uint64_t damaged = 0;                       // Átugrott sérült szakaszok, a csonka vég nélkül
+};
+
+// A rekordokat csak elölről lehet bejárni, ezért darabonként végigolvassuk a
+// fájlt. Sérült rekord után bájtonként keressük a következő ép rekordot, így
+// egy hiba a fájl közepén nem viszi magával az utána írt játszmákat.
+ArchiveScan scanArchive(FILE *file)
+{
+    ArchiveScan scan;
+    std::string data;
+    uint64_t base = sizeof(ArchiveMagic);   // data[0] helye a fájlban
+    size_t offset = 0;
+    bool eof = false;
+    bool damaged = false;
+    ArchivedGame game;
+    while (true) {
+        // Ha a fájlban van még, legalább egy teljes rekordnyi adat legyen előttünk
+        if (!eof && data.size() - offset < 2 * MaxRecordSize) {
+            data.erase(0, offset);
+            base += offset;
+            offset = 0;
+            size_t size = data.size();
+            data.resize(size + (1 << 20));
+            data.resize(size + std::fread(&data[size], 1, 1 << 20, file));
+            eof = data.size() < size + (1 << 20);
+            continue;
+        }
+        if (offset >= data.size()) break;
+        size_t consumed = 0;
+        if (GameArchive::decode(data.data() + offset, data.size() - offset, consumed, game)) {
+            if (damaged) ++scan.damaged;
+            damaged = false;
+            offset += consumed;
+            scan.validEnd = base + offset;
+        } else {
+            damaged = true;
+            ++offset;
+        }
+    }
+    return scan;
+}
+
+std::string pgnEscape(const std::string &text)
+{
+    std::string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+} // namespace
+
+namespace GameArchive {
+
+void encode(const ArchivedGame &game, std::string &out)
+{
+    size_t start = out.size();
+    uint8_t flags = (game.startFen.empty() ? 0 : HasFen) | (game.white.empty() && game.black.empty() ? 0 : HasNames);
+    size_t plies = game.moves.size() < 65535 ? game.moves.size() : 65535;
+
+    put16(out, uint16_t(plies));
+    out += char(game.result);
+    out += char(flags);
+    put32(out, uint32_t(game.date));
+    put32(out, 0);   // Ellenőrzőösszeg, lent töltjük ki
+    if (flags & HasFen) putString(out, game.startFen);
+    if (flags & HasNames) {
+        putString(out, game.white);
+        putString(out, game.black);
+    }
+    for (size_t i = 0; i < plies; ++i) put16(out, game.moves[i]);
+
+    uint32_t checksum = fnv1a(out.data() + start, 8);
+    checksum = fnv1a(out.data() + start + HeaderSize, out.size() - start - HeaderSize, checksum);
+    for (int i = 0; i < 4; ++i) out[start + 8 + size_t(i)] = char((checksum >> (8 * i)) & 0xFF);
+}
+
+bool decode(const char *data, size_t size, size_t &consumed, ArchivedGame &game)
+{
+    if (size < HeaderSize) return false;
+    size_t plies = get16(data);
+    uint8_t result = uint8_t(data[2]);
+    uint8_t flags = uint8_t(data[3]);
+    if (result > uint8_t(GameResult::Draw) || flags > (HasFen | HasNames)) return false;
+
+    size_t offset = HeaderSize;
+    auto readString = [&](std::string &text) {
+        if (offset >= size) return false;
+        size_t length = uint8_t(data[offset++]);
+        if (offset + length > size) return false;
+        text.assign(data + offset, length);
+        offset += length;
+        return true;
+    };
+
+    game = ArchivedGame();
+    if ((flags & HasFen) && !readString(game.startFen)) return false;
+    if ((flags & HasNames) && (!readString(game.white) || !readString(game.black))) return false;
+    if (offset + plies * 2 > size) return false;
+    game.moves.resize(plies);
+    for (size_t i = 0; i < plies; ++i) game.moves[i] = get16(data + offset + i * 2);
+    offset += plies * 2;
+
+    uint32_t checksum = fnv1a(data, 8);
+    checksum = fnv1a(data + HeaderSize, offset - HeaderSize, checksum);
+    if (checksum != get32(data + 8)) return false;
+
+    game.result = GameResult(result);
+    game.date = int64_t(get32(data + 4));
+    consumed = offset;
+    return true;
+}
+
+const char *resultString(GameResult result)
+{
+    switch (result) {
+    case GameResult::WhiteWins: return "1-0";
+    case GameResult::BlackWins: return "0-1";
+    case GameResult::Draw: return "1/2-1/2";
+    case GameResult::Unknown: break;
+    }
+    return "*";
+}
+
+std::string toPgn(const ArchivedGame &game)
+{
+    char date[16] = "????.??.??";
+    if (game.date > 0) {
+        std::time_t time = std::time_t(game.date);
+        std::tm *utc = std::gmtime(&time);
+        if (utc) std::strftime(date, sizeof(date), "%Y.%m.%d", utc);
+    }
+
+    std::ostringstream pgn;
+    pgn << "[Event \"?\"]\n[Site \"?\"]\n[Date \"" << date << "\"]\n[Round \"?\"]\n"
+        << "[White \"" << (game.white.empty() ? "?" : pgnEscape(game.white)) << "\"]\n"
+        << "[Black \"" << (game.black.empty() ? "?" : pgnEscape(game.black)) << "\"]\n"
+        << "[Result \"" << resultString(game.result) << "\"]\n";
+    if (!game.startFen.empty()) pgn << "[SetUp \"1\"]\n[FEN \"" << game.startFen << "\"]\n";
+    pgn << "\n";
+
+    Position position;
+    if (game.startFen.empty() || !position.setFen(game.startFen)) position.setFen(StartFen);
+    // A lépésszám a FEN-ből jön, fekete kezdésnél "1..." formában
+    std::istringstream fenFields(game.startFen.empty() ? StartFen : game.startFen);
+    std::string field;
+    int moveNumber = 1;
+    for (int i = 0; i < 6 && fenFields >> field; ++i) {
+        if (i == 5) moveNumber = std::atoi(field.c_str());
+    }
+    if (moveNumber < 1) moveNumber = 1;
+
+    size_t lineLength = 0;
+    auto emit = [&](const std::string &token) {
+        // A PGN sorai legfeljebb 80 karakteresek
+        if (lineLength && lineLength + 1 + token.size() > 79) {
+            pgn << "\n";
+            lineLength = 0;
+        } else if (lineLength) {
+            pgn << ' ';
+            ++lineLength;
+        }
+        pgn << token;
+        lineLength += token.size();
+    };
+
+    bool first = true;
+    for (Move move : game.moves) {
+        if (!position.isPseudoLegal(move)) break;
+        bool white = position.whiteToMove();
+        if (white) emit(std::to_string(moveNumber) + ".");
+        else if (first) emit(std::to_string(moveNumber) + "...");
+        std::string san = position.moveToSan(move);
+        if (!position.makeMove(move)) break;
+        emit(san);
+        if (!white) ++moveNumber;
+        first = false;
+    }
+    emit(resultString(game.result));
+    pgn << "\n\n";
+    return pgn.str();
+}
+
+} // namespace GameArchive
+
+bool GameArchiveWriter::open(const std::string &path)
+{
+    close();
+    // Itt csak a fejlécet nézzük; a rekordok ellenőrzése az író szálon fut (repair)
+    bool existing = false;
+    if (FILE *in = std::fopen(path.c_str(), "rb")) {
+        char magic[4];
+        size_t read = std::fread(magic, 1, 4, in);
+        std::fclose(in);
+        if (std::memcmp(magic, ArchiveMagic, read) != 0) {
+            LOG_ERROR("archive_not_an_archive", {"path", path});
+            return false;
+        }
+        existing = read == 4;
+        if (!existing && !truncateTornTail(path, 0)) return false;
+    }
+
+    std::function<void()> prepare;
+    if (existing) prepare = [path]() { repair(path); };
+    return appender.open(path, std::string(ArchiveMagic, 4), prepare);
+}
+
+void GameArchiveWriter::repair(const std::string &path)
+{
+    // Csak az valódi csonka vég, ami után nincs ép rekord és rövidebb egy rekordnál;
+    // a közbülső sérült részeket az olvasó átugorja, azokat nem vágjuk le.
+    FILE *in = std::fopen(path.c_str(), "rb");
+    if (!in) return;
+    std::fseek(in, sizeof(ArchiveMagic), SEEK_SET);
+    ArchiveScan scan = scanArchive(in);
+    std::fseek(in, 0, SEEK_END);
+    uint64_t size = uint64_t(std::ftell(in));
+    std::fclose(in);
+
+    if (scan.damaged) LOG_ERROR("archive_damaged", {"path", path}, {"regions", scan.damaged});
+    uint64_t tail = size - scan.validEnd;
+    if (tail >= MaxRecordSize) LOG_ERROR("archive_damaged_tail", {"path", path}, {"bytes", tail});
+    else truncateTornTail(path, scan.validEnd);
+}
+
+void GameArchiveWriter::append(ArchivedGame game)
+{
+    if (game.date == 0) game.date = int64_t(std::time(nullptr));
+    appender.append(std::move(game));
+}
+
+bool GameArchiveReader::open(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    offset = 4;
+    corrupt = 0;
+    return data.size() >= 4 && std::memcmp(data.data(), ArchiveMagic, 4) == 0;
+}
+
+bool GameArchiveReader::next(ArchivedGame &game)
+{
+    // Sérült szakasz után a következő ép rekordtól folytatjuk (scanArchive ugyanígy)
+    bool damaged = false;
+    while (offset < data.size()) {
+        size_t consumed = 0;
+        if (GameArchive::decode(data.data() + offset, data.size() - offset, consumed, game)) {
+            if (damaged) ++corrupt;
+            offset += consumed;
+            return true;
+        }
+        damaged = true;
+        ++offset;
+    }
+    if (damaged) ++corrupt;
+    return false;
+}
+
+GameJournal::~GameJournal()
+{
+    if (file) std::fclose(file);
+}
+
+bool GameJournal::recover(const std::string &path, ArchivedGame &game)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (content.size() < 5 || std::memcmp(content.data(), JournalMagic, 4) != 0) return false;
+
+    size_t fenLength = uint8_t(content[4]);
+    if (5 + fenLength > content.size()) return false;
+    game = ArchivedGame();
+    game.startFen = content.substr(5, fenLength);
+    // Páratlan hossz: a legutolsó lépés írása közben állt le, azt elvetjük
+    for (size_t offset = 5 + fenLength; offset + 2 <= content.size(); offset += 2)
+        game.moves.push_back(get16(content.data() + offset));
+    return !game.moves.empty();
+}
+
+bool GameJournal::begin(const std::string &path, const std::string &startFen)
+{
+    if (file) std::fclose(file);
+    journalPath = path;
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::string header(JournalMagic, 4);
+    putString(header, startFen);
+    std::fwrite(header.data(), 1, header.size(), file);
+    std::fflush(file);
+    return true;
+}
+
+void GameJournal::appendMove(Move move)
+{
+    if (!file) return;
+    char bytes[2] = { char(move & 0xFF), char(move >> 8) };
+    // Két bájt és egy flush: a folyamat összeomlását túléli, a fájlrendszer szinkronizálását nem várjuk meg
+    std::fwrite(bytes, 1, 2, file);
+    std::fflush(file);
+}
+
+void GameJournal::discard()
+{
+    if (!file) return;
+    std::fclose(file);
+    file = nullptr;
+    std::remove(journalPath.c_str());
+}
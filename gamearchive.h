@@ -0,0 +1,97 @@
+#ifndef GAMEARCHIVE_H
+#define GAMEARCHIVE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "position.h"
+#include "fileappender.h"
+
+// Compact binary game storage.
+//
+// Archive file: "CGA1" followed by game records. A record is a 12 byte header
+// (ply count, result, flags, date, FNV-1a checksum of the rest of the record),
+// the optional start FEN and player names (each one length byte + bytes) and
+// two bytes per ply (the Move encoding, little endian). A game of 80 plies
+// takes 172 bytes. Records are appended with one write each. A damaged record
+// fails the checksum; the reader skips it and resumes at the next record that
+// decodes. A torn record at the very end is cut off by the writer when it
+// opens the file again; damage in the middle is left for the reader to skip.
+
+enum class GameResult : uint8_t { Unknown = 0, WhiteWins = 1, BlackWins = 2, Draw = 3 };
+
+struct ArchivedGame
+{
+    std::string startFen;       // Üres = alapállás
+    std::vector<Move> moves;
+    GameResult result = GameResult::Unknown;
+    int64_t date = 0;           // Unix time, seconds
+    std::string white;
+    std::string black;
+};
+
+namespace GameArchive {
+
+void encode(const ArchivedGame &game, std::string &out);   // Appends one record
+// Decodes the record at data; false if it is truncated or corrupt
+bool decode(const char *data, size_t size, size_t &consumed, ArchivedGame &game);
+// Moves are replayed to produce SAN; stops at the first illegal move
+std::string toPgn(const ArchivedGame &game);
+const char *resultString(GameResult result);
+
+} // namespace GameArchive
+
+// Appends games from a background thread (FileAppender), so the caller (GUI
+// thread, server event loop) never waits for the disk.
+class GameArchiveWriter
+{
+public:
+    // false if the file exists but is not an archive. The records are checked
+    // on the writer thread before the first write; a torn last record is removed.
+    bool open(const std::string &path);
+    void append(ArchivedGame game);
+    void close() { appender.close(); }
+    bool isOpen() const { return appender.isOpen(); }
+
+    uint64_t gamesWritten() const { return appender.recordsWritten(); }
+    uint64_t bytesWritten() const { return appender.bytesWritten(); }
+
+private:
+    static void repair(const std::string &path);
+
+    FileAppender<ArchivedGame> appender { GameArchive::encode, "archive writer", FileAppender<ArchivedGame>::Unbounded };
+};
+
+class GameArchiveReader
+{
+public:
+    bool open(const std::string &path);
+    bool next(ArchivedGame &game);   // false at the end; damaged records are skipped
+    uint64_t skipped() const { return corrupt; }   // Damaged stretches, a torn end included
+
+private:
+    std::string data;
+    size_t offset = 0;
+    uint64_t corrupt = 0;
+};
+
+// Journal of the game in progress: "CGJ1", the start FEN, then two bytes per
+// move, flushed after every move. After a crash recover() returns the moves
+// that reached the file, so at most the move being written is lost.
+class GameJournal
+{
+public:
+    ~GameJournal();
+
+    bool recover(const std::string &path, ArchivedGame &game);   // false if there is nothing to recover
+    bool begin(const std::string &path, const std::string &startFen = std::string());
+    void appendMove(Move move);
+    void discard();   // Game archived or abandoned: the journal is removed
+
+private:
+    FILE *file = nullptr;
+    std::string journalPath;
+};
+
+#endif // GAMEARCHIVE_H
@@ -0,0 +1,67 @@
+#include "gameclock.h"
+
+GameClock::GameClock(QObject *parent) : QObject(parent), ticker(new QTimer(this))
+{
+    ticker->setInterval(100); // A kijelzőnek tizedmásodperc pontosság elég
+    connect(ticker, &QTimer::timeout, this, &GameClock::tick);
+}
+
+void GameClock::start(int initialMs, int incrementMs)
+{
+    whiteMs = blackMs = initialMs;
+    this->incrementMs = incrementMs;
+    whiteRunning = true;
+    running = true;
+    elapsed.start();
+    ticker->start();
+    emit timeUpdated(whiteMs, blackMs);
+}
+
+void GameClock::stop()
+{
+    if (!running) return;
+    // A futó oldal idejét lezárjuk, hogy a kijelző a végső állapotot mutassa
+    int used = int(elapsed.elapsed());
+    if (whiteRunning) whiteMs -= used;
+    else blackMs -= used;
+    running = false;
+    ticker->stop();
+    emit timeUpdated(remaining(true), remaining(false));
+}
+
+void GameClock::switchSide()
+{
+    if (!running) return;
+    int used = int(elapsed.restart());
+    if (whiteRunning) whiteMs += incrementMs - used;
+    else blackMs += incrementMs - used;
+    whiteRunning = !whiteRunning;
+    emit timeUpdated(remaining(true), remaining(false));
+}
+
+int GameClock::remaining(bool white) const
+{
+    int ms = white ? whiteMs : blackMs;
+    if (running && white == whiteRunning) ms -= int(elapsed.elapsed());
+    return qMax(ms, 0);
+}
+
+QString GameClock::format(int ms)
+{
+    int seconds = ms / 1000;
+    // 10 másodperc alatt tizedeket is mutatunk (bullet)
+    if (ms < 10000) return QString("0:%1.%2").arg(seconds, 2, 10, QChar('0')).arg((ms % 1000) / 100);
+    return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+}
+
+void GameClock::tick()
+{
+    int white = remaining(true);
+    int black = remaining(false);
+    emit timeUpdated(white, black);
+    if ((whiteRunning ? white : black) <= 0) {
+        bool flagged = whiteRunning;
+        stop();
+        emit flagFell(flagged);
+    }
+}
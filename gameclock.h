@@ -0,0 +1,40 @@
+#ifndef GAMECLOCK_H
+#define GAMECLOCK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Chess clock for both sides with Fischer increment.
+class GameClock : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GameClock(QObject *parent = nullptr);
+
+    void start(int initialMs, int incrementMs);
+    void stop();
+    void switchSide();   // The side to move pressed its clock
+    int remaining(bool white) const;
+    int increment() const { return incrementMs; }
+    bool isRunning() const { return running; }
+    static QString format(int ms);
+
+signals:
+    void timeUpdated(int whiteMs, int blackMs);
+    void flagFell(bool white);
+
+private:
+    void tick();
+
+    QTimer *ticker;
+    QElapsedTimer elapsed;
+    int whiteMs = 0;
+    int blackMs = 0;
+    int incrementMs = 0;
+    bool whiteRunning = true;
+    bool running = false;
+};
+
+#endif // GAMECLOCK_H
@@ -0,0 +1,145 @@
+#include "gamerecord.h"
+#include <algorithm>
+
+GameRecord::GameRecord(int snapshotInterval)
+    : interval(snapshotInterval > 0 ? snapshotInterval : 1)
+{
+    reset();
+}
+
+bool GameRecord::reset(const std::string &fen)
+{
+    Position start;
+    if (!fen.empty() && !start.setFen(fen)) return false;
+
+    initialFen = fen;
+    nodes.clear();
+    snapshots.clear();
+    nodes.push_back({ NoMove, -1, 0, 0, {} });
+    snapshots.push_back(start);
+    cursor = start;
+    cursorNode = Root;
+    return true;
+}
+
+int GameRecord::play(Move move, bool mainLine)
+{
+    if (move == NoMove || !cursor.makeMove(move)) return -1;
+
+    int node = -1;
+    for (int child : nodes[size_t(cursorNode)].children) {
+        if (nodes[size_t(child)].move == move) {
+            node = child;
+            break;
+        }
+    }
+
+    if (node < 0) {
+        node = int(nodes.size());
+        int ply = nodes[size_t(cursorNode)].ply + 1;
+        int snapshot = -1;
+        if (ply % interval == 0) {
+            snapshot = int(snapshots.size());
+            snapshots.push_back(cursor);
+        }
+        nodes.push_back({ move, cursorNode, ply, snapshot, {} });
+        nodes[size_t(cursorNode)].children.push_back(node);
+    }
+
+    cursorNode = node;
+    if (mainLine) promote(node);
+    return node;
+}
+
+bool GameRecord::goTo(int node)
+{
+    if (node < 0 || node >= nodeCount()) return false;
+    if (node == cursorNode) return true;
+
+    // Közös ős keresése legfeljebb interval lépésig; a célig vezető lépések a path-ba kerülnek
+    path.clear();
+    int from = cursorNode, to = node, steps = 0;
+    while (from != to && steps <= interval) {
+        if (nodes[size_t(from)].ply >= nodes[size_t(to)].ply) {
+            from = nodes[size_t(from)].parent;
+        } else {
+            path.push_back(to);
+            to = nodes[size_t(to)].parent;
+        }
+        ++steps;
+    }
+
+    if (from == to) {
+        for (int ply = nodes[size_t(cursorNode)].ply; ply > nodes[size_t(from)].ply; --ply) cursor.unmakeMove();
+    } else {
+        // Messze van: a cél feletti legközelebbi pillanatképből játsszuk vissza
+        path.clear();
+        int base = nearestSnapshot(node, cursor);
+        for (to = node; to != base; to = nodes[size_t(to)].parent) path.push_back(to);
+    }
+
+    for (auto it = path.rbegin(); it != path.rend(); ++it) cursor.makeMove(nodes[size_t(*it)].move);
+    cursorNode = node;
+    return true;
+}
+
+bool GameRecord::back()
+{
+    if (cursorNode == Root) return false;
+    cursor.unmakeMove();
+    cursorNode = nodes[size_t(cursorNode)].parent;
+    return true;
+}
+
+bool GameRecord::forward()
+{
+    const std::vector<int> &next = nodes[size_t(cursorNode)].children;
+    if (next.empty()) return false;
+    cursor.makeMove(nodes[size_t(next.front())].move);
+    cursorNode = next.front();
+    return true;
+}
+
+bool GameRecord::goToPly(int ply)
+{
+    if (ply < 0) return false;
+    int node = cursorNode;
+    while (nodes[size_t(node)].ply > ply) node = nodes[size_t(node)].parent;
+    while (nodes[size_t(node)].ply < ply) {
+        if (nodes[size_t(node)].children.empty()) return false;
+        node = nodes[size_t(node)].children.front();
+    }
+    return goTo(node);
+}
+
+int GameRecord::nearestSnapshot(int node, Position &position) const
+{
+    while (nodes[size_t(node)].snapshot < 0) node = nodes[size_t(node)].parent;
+    position = snapshots[size_t(nodes[size_t(node)].snapshot)];
+    return node;
+}
+
+int GameRecord::lineEnd(int node) const
+{
+    while (!nodes[size_t(node)].children.empty()) node = nodes[size_t(node)].children.front();
+    return node;
+}
+
+std::vector<Move> GameRecord::line(int node) const
+{
+    std::vector<Move> moves(size_t(nodes[size_t(node)].ply));
+    for (size_t i = moves.size(); i > 0; --i) {
+        moves[i - 1] = nodes[size_t(node)].move;
+        node = nodes[size_t(node)].parent;
+    }
+    return moves;
+}
+
+void GameRecord::promote(int node)
+{
+    for (int parentNode = nodes[size_t(node)].parent; parentNode >= 0; node = parentNode, parentNode = nodes[size_t(node)].parent) {
+        std::vector<int> &siblings = nodes[size_t(parentNode)].children;
+        auto it = std::find(siblings.begin(), siblings.end(), node);
+        std::rotate(siblings.begin(), it, it + 1);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef GAMERECORD_H
+#define GAMERECORD_H
+
+#include <string>
+#include <vector>
+#include "position.h"
+
+// Game tree for review and analysis: the main line and its variations.
+//
+// Every node is one ply. A full Position snapshot is kept at every
+// snapshotInterval-th ply of every line, and the cursor position is moved with
+// makeMove / unmakeMove (the Position's own undo records). Jumping to any node
+// therefore replays at most snapshotInterval moves: nearby targets are reached
+// by stepping through the common ancestor, far ones from the nearest snapshot
+// above them. Stepping and branching cost one move.
+class GameRecord
+{
+public:
+    static const int Root = 0;
+
+    explicit GameRecord(int snapshotInterval = 16);
+
+    bool reset(const std::string &fen = std::string());   // Üres = alapállás
+    const std::string &startFen() const { return initialFen; }
+
+    int current() const { return cursorNode; }
+    const Position &position() const { return cursor; }
+    int nodeCount() const { return int(nodes.size()); }
+    int ply(int node) const { return nodes[size_t(node)].ply; }
+    Move move(int node) const { return nodes[size_t(node)].move; }
+    int parent(int node) const { return nodes[size_t(node)].parent; }
+    const std::vector<int> &children(int node) const { return nodes[size_t(node)].children; }   // Az első a főváltozat
+    Move parseUciMove(const std::string &uci) { return cursor.parseUciMove(uci); }
+
+    // Plays a legal move from the current node and moves the cursor there. An
+    // existing child with the same move is reused, otherwise a new variation is
+    // added. With mainLine the node's line becomes the main line. Returns the
+    // node or -1 if the move is illegal.
+    int play(Move move, bool mainLine = false);
+
+    bool goTo(int node);
+    bool back();
+    bool forward();               // Along the main continuation
+    bool goToPly(int ply);        // On the line through the current node
+    int lineEnd(int node) const;  // Last node of the main continuation
+    std::vector<Move> line(int node) const;   // Moves from the root
+    void promote(int node);       // Its line becomes the main line at every branch point
+
+    // Copies the nearest snapshot at or above node into position and returns
+    // the snapshot's node; at most snapshotInterval plies above node
+    int nearestSnapshot(int node, Position &position) const;
+    int snapshotCount() const { return int(snapshots.size()); }
+
+private:
+    struct Node
+    {
+        Move move;
+        int parent;
+        int ply;
+        int snapshot;             // Index a snapshots tömbben, -1 ha nincs
+        std::vector<int> children;
+    };
+
+    int interval;
+    std::string initialFen;
+    std::vector<Node> nodes;
+    std::vector<Position> snapshots;
+    Position cursor;
+    int cursorNode = Root;
+    std::vector<int> path;        // goTo munkaterülete
+};
+
+#endif // GAMERECORD_H
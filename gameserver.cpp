@@ -0,0 +1,314 @@
+#include "gameserver.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHostAddress>
+#include "logger.h"
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+
+namespace {
+
+qint64 nowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *resultString(GameOutcome outcome, bool whiteToMove)
+{
+    if (outcome == GameOutcome::Checkmate) return whiteToMove ? "0-1" : "1-0";
+    return "1/2-1/2";
+}
+
+const char *reasonString(GameOutcome outcome)
+{
+    switch (outcome) {
+    case GameOutcome::Checkmate: return "checkmate";
+    case GameOutcome::Stalemate: return "stalemate";
+    case GameOutcome::FiftyMoves: return "fifty_moves";
+    case GameOutcome::Repetition: return "repetition";
+    case GameOutcome::InsufficientMaterial: return "insufficient_material";
+    case GameOutcome::Ongoing: break;
+    }
+    return "ongoing";
+}
+
+} // namespace
+
+GameServer::GameServer(const Options &options, QObject *parent)
+    : QObject(parent)
+    , options(options)
+    , engine(pool, [this](std::function<void()> resume) { QMetaObject::invokeMethod(this, std::move(resume), Qt::QueuedConnection); })
+    , pool(options.engineThreads, options.engineHashMb)
+{
+    if (!options.cachePath.isEmpty()) cache.open(options.cachePath);
+    if (!options.archivePath.isEmpty() && !archive.open(options.archivePath.toStdString()))
+        LOG_ERROR("archive_open_failed", {"path", options.archivePath});
+}
+
+GameServer::~GameServer()
+{
+    // A kapcsolatok a szerver objektumok gyerekei, velük együtt törlődnek
+    for (QIODevice *socket : connections.keys()) socket->disconnect(this);
+}
+
+bool GameServer::listenTcp(quint16 port)
+{
+    tcpServer = new QTcpServer(this);
+    if (!tcpServer->listen(QHostAddress::LocalHost, port)) {
+        lastError = tcpServer->errorString();
+        return false;
+    }
+    connect(tcpServer, &QTcpServer::newConnection, this, [this]() {
+        while (QTcpSocket *socket = tcpServer->nextPendingConnection()) {
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);   // Rövid sorok, ne várjon a Nagle
+            connect(socket, &QTcpSocket::disconnected, this, [this, socket]() { removeConnection(socket); });
+            addConnection(socket);
+        }
+    });
+    return true;
+}
+
+bool GameServer::listenLocal(const QString &name)
+{
+    localServer = new QLocalServer(this);
+    QLocalServer::removeServer(name);   // Előző futásból ottmaradt socket fájl
+    if (!localServer->listen(name)) {
+        lastError = localServer->errorString();
+        return false;
+    }
+    connect(localServer, &QLocalServer::newConnection, this, [this]() {
+        while (QLocalSocket *socket = localServer->nextPendingConnection()) {
+            connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { removeConnection(socket); });
+            addConnection(socket);
+        }
+    });
+    return true;
+}
+
+void GameServer::addConnection(QIODevice *socket)
+{
+    connections.insert(socket, {});
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() { readCommands(socket); });
+}
+
+void GameServer::readCommands(QIODevice *socket)
+{
+    while (socket->canReadLine()) {
+        QByteArray line = socket->readLine().trimmed();
+        if (!line.isEmpty()) handleCommand(socket, line);
+        if (!connections.contains(socket)) return;   // quit közben lezárult
+    }
+}
+
+void GameServer::removeConnection(QIODevice *socket)
+{
+    auto it = connections.find(socket);
+    if (it == connections.end()) return;
+    for (int slot : it.value()) releaseGame(slot);
+    connections.erase(it);
+    socket->deleteLater();
+}
+
+void GameServer::send(QIODevice *socket, const QByteArray &line)
+{
+    socket->write(line);
+    socket->write("\n", 1);
+}
+
+void GameServer::handleCommand(QIODevice *socket, const QByteArray &line)
+{
+    QList<QByteArray> parts = line.split(' ');
+    const QByteArray &command = parts[0];
+
+    if (command == "new") {
+        QByteArray side = parts.value(1, "black");
+        int engineSide = side == "white" ? 0 : side == "black" ? 1 : side == "none" ? -1 : -2;
+        if (engineSide == -2) {
+            send(socket, "error unknown side " + side);
+            return;
+        }
+        int slot = createGame(socket, engineSide);
+        send(socket, "game " + QByteArray::number(slot));
+        if (games[slot].engineSide == 0) startEngineTurn(slot);
+    }
+    else if (command == "move") {
+        int slot;
+        ServerGame *game = findGame(socket, parts.value(1), slot);
+        if (!game) return;
+        if (game->over || game->thinking || int(game->engineSide) == (game->position.whiteToMove() ? 0 : 1)) {
+            send(socket, "error " + parts.value(1) + " not your turn");
+            return;
+        }
+
+        QByteArray uci = parts.value(2);
+        Move move = game->position.parseUciMove(uci.toStdString());
+        if (move == NoMove) {
+            send(socket, "illegal " + parts.value(1) + " " + uci);
+            return;
+        }
+        game->position.makeMove(move);
+        ++movesPlayed;
+        send(socket, "ok " + parts.value(1) + " " + uci);
+        if (!checkGameOver(slot) && game->engineSide >= 0) startEngineTurn(slot);
+    }
+    else if (command == "fen") {
+        int slot;
+        ServerGame *game = findGame(socket, parts.value(1), slot);
+        if (game) send(socket, "fen " + parts.value(1) + " " + QByteArray::fromStdString(game->position.fen()));
+    }
+    else if (command == "close") {
+        int slot;
+        if (!findGame(socket, parts.value(1), slot)) return;
+        std::vector<int> &owned = connections[socket];
+        owned.erase(std::find(owned.begin(), owned.end(), slot));
+        releaseGame(slot);
+        send(socket, "closed " + parts.value(1));
+    }
+    else if (command == "stats") {
+        send(socket, QByteArray("stats games=") + QByteArray::number(activeGames)
+                         + " moves=" + QByteArray::number(movesPlayed)
+                         + " engine_moves=" + QByteArray::number(engineMoves)
+                         + " queue=" + QByteArray::number(pool.pending())
+                         + " cache_hits=" + QByteArray::number(cache.hits())
+                         + " archived=" + QByteArray::number(archive.gamesWritten())
+                         + " engine_p50_us=" + QByteArray::number(engineLatency.percentile(0.50))
+                         + " engine_p99_us=" + QByteArray::number(engineLatency.percentile(0.99)));
+    }
+    else if (command == "quit") {
+        removeConnection(socket);
+        socket->close();
+    }
+    else {
+        send(socket, "error unknown command " + command);
+    }
+}
+
+GameServer::ServerGame *GameServer::findGame(QIODevice *socket, const QByteArray &id, int &slot)
+{
+    bool ok = false;
+    slot = id.toInt(&ok);
+    if (!ok || slot < 0 || slot >= int(games.size()) || games[slot].owner != socket) {
+        send(socket, "error " + id + " unknown game");
+        return nullptr;
+    }
+    return &games[slot];
+}
+
+int GameServer::createGame(QIODevice *socket, int engineSide)
+{
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = int(games.size());
+        games.emplace_back();
+    }
+
+    ServerGame &game = games[slot];
+    game.position.setStartPosition();
+    game.owner = socket;
+    game.engineSide = int8_t(engineSide);
+    game.thinking = false;
+    game.over = false;
+    connections[socket].push_back(slot);
+    ++activeGames;
+    return slot;
+}
+
+void GameServer::releaseGame(int slot)
+{
+    ServerGame &game = games[slot];
+    if (!game.over) archiveGame(game, GameResult::Unknown);   // Félbehagyott játszma
+    game.owner = nullptr;
+    game.search.stop();   // A függőben lévő motorválasz érvénytelen lesz (a sorban állót a pool eldobja)
+    game.position.setStartPosition();   // A lépéstörténet memóriáját elengedjük
+    freeSlots.push_back(slot);
+    --activeGames;
+}
+
+bool GameServer::checkGameOver(int slot)
+{
+    ServerGame &game = games[slot];
+    GameOutcome outcome = game.position.outcome();
+    if (outcome == GameOutcome::Ongoing) return false;
+
+    game.over = true;
+    bool whiteLost = outcome == GameOutcome::Checkmate && game.position.whiteToMove();
+    archiveGame(game, outcome != GameOutcome::Checkmate ? GameResult::Draw
+                                                        : whiteLost ? GameResult::BlackWins : GameResult::WhiteWins);
+    send(game.owner, "over " + QByteArray::number(slot) + " " + resultString(outcome, game.position.whiteToMove())
+                         + " " + reasonString(outcome));
+    return true;
+}
+
+void GameServer::archiveGame(const ServerGame &game, GameResult result)
+{
+    if (!archive.isOpen() || game.position.ply() == 0) return;
+    ArchivedGame record;
+    record.moves.reserve(size_t(game.position.ply()));
+    for (int i = 0; i < game.position.ply(); ++i) record.moves.push_back(game.position.historyMove(i));
+    record.result = result;
+    record.white = game.engineSide == 0 ? "engine" : "client";
+    record.black = game.engineSide == 1 ? "engine" : "client";
+    archive.append(std::move(record));   // Az írás a háttérszálon történik
+}
+
+void GameServer::startEngineTurn(int slot)
+{
+    ServerGame &game = games[slot];
+    game.thinking = true;
+    game.search = SearchStop();
+    engineTurn(slot, game.search, nowMicros());   // Magára hagyott korutin, a válasznál folytatódik
+}
+
+Task<> GameServer::engineTurn(int slot, SearchStop stop, qint64 requestedAt)
+{
+    // Ismert állásnál a motorhoz sem fordulunk, a válasz ugyanúgy az eseményhurkon megy ki
+    const SearchLimits &limits = options.engineLimits;
+    int requiredDepth = limits.depth < 64 && limits.movetime == 0 ? limits.depth : options.cacheDepth;
+    AnalysisCache::Entry cached;
+    SearchResult result;
+    if (cache.probe(games[slot].position, requiredDepth, cached)) {
+        result.bestMove = cached.bestMove;
+        result.score = cached.score;
+        result.depth = cached.depth;
+        co_await engine.schedule();
+        if (stop.stopRequested()) co_return;
+    } else {
+        // A munkaszál saját másolaton keres; a games vektor közben nőhet, ezért utána újra indexelünk
+        EngineReply reply = co_await engine.search(games[slot].position, limits, stop);
+        if (reply.cancelled) co_return;   // Közben lezárták
+        result = std::move(reply.result);
+    }
+    onEngineMove(slot, result, requestedAt);
+}
+
+void GameServer::onEngineMove(int slot, const SearchResult &result, qint64 requestedAt)
+{
+    ServerGame &game = games[slot];
+    game.thinking = false;
+    engineLatency.record(nowMicros() - requestedAt);
+    Move move = result.bestMove;
+    if (move != NoMove) {
+        // A lépés előtt: a kulcs még a keresett állásé
+        AnalysisCache::Entry entry;
+        entry.bestMove = move;
+        entry.mate = Search::isMateScore(result.score);
+        entry.score = entry.mate ? Search::mateMoves(result.score) : result.score;
+        entry.depth = result.depth;
+        entry.pv = result.pv;
+        cache.store(game.position.key(), entry);
+    }
+    if (move == NoMove || !game.position.makeMove(move)) {
+        LOG_ERROR("engine_no_legal_move", {"game", slot});
+        checkGameOver(slot);
+        return;
+    }
+    ++engineMoves;
+    send(game.owner, "engine " + QByteArray::number(slot) + " " + QByteArray::fromStdString(Position::moveToUci(move)));
+    checkGameOver(slot);
+}
@@ -0,0 +1,100 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QByteArray>
+#include <vector>
+#include "position.h"
+#include "enginepool.h"
+#include "asyncengine.h"
+#include "task.h"
+#include "analysiscache.h"
+#include "gamearchive.h"
+#include "latency.h"
+
+class QIODevice;
+class QTcpServer;
+class QLocalServer;
+
+// Line based game server, one event loop thread for all connections.
+//
+//   new [white|black|none]   -> game <id>          (engine side, default black)
+//   move <id> <uci>          -> ok <id> <uci> | illegal <id> <uci>
+//                               engine <id> <uci>  (later, when the engine replied)
+//                               over <id> <result> <reason>
+//   fen <id>                 -> fen <id> <fen>
+//   close <id>               -> closed <id>
+//   stats                    -> stats games=.. moves=.. engine_moves=.. queue=.. engine_p50_us=.. engine_p99_us=..
+//   quit
+//
+// Errors are answered with "error [<id>] <reason>".
+class GameServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Options
+    {
+        int engineThreads = 0;      // 0 = hardware threads
+        int engineHashMb = 4;
+        SearchLimits engineLimits;
+        QString cachePath;          // Üres = nincs elemzési gyorsítótár
+        int cacheDepth = 12;        // Időre kért keresésnél ennyi tárolt mélység elég
+        QString archivePath;        // Üres = a játszmákat nem mentjük
+    };
+
+    explicit GameServer(const Options &options, QObject *parent = nullptr);
+    ~GameServer();
+
+    bool listenTcp(quint16 port);             // Csak 127.0.0.1-en
+    bool listenLocal(const QString &name);    // Unix domain socket / named pipe
+    QString errorString() const { return lastError; }
+
+private:
+    // Egy játszma: a szabályokat a Position tartja, a többi néhány bájt
+    struct ServerGame
+    {
+        Position position;
+        QIODevice *owner = nullptr;   // nullptr = szabad hely
+        SearchStop search;            // Lezáráskor leállítjuk, így a késve érkező motorválasz eldobható
+        int8_t engineSide = 1;        // 0 = fehér, 1 = fekete, -1 = nincs motor
+        bool thinking = false;
+        bool over = false;
+    };
+
+    void addConnection(QIODevice *socket);
+    void readCommands(QIODevice *socket);
+    void removeConnection(QIODevice *socket);
+    void handleCommand(QIODevice *socket, const QByteArray &line);
+    void send(QIODevice *socket, const QByteArray &line);
+
+    ServerGame *findGame(QIODevice *socket, const QByteArray &id, int &slot);
+    int createGame(QIODevice *socket, int engineSide);
+    void releaseGame(int slot);
+    bool checkGameOver(int slot);
+    void archiveGame(const ServerGame &game, GameResult result);
+    void startEngineTurn(int slot);
+    Task<> engineTurn(int slot, SearchStop stop, qint64 requestedAt);
+    void onEngineMove(int slot, const SearchResult &result, qint64 requestedAt);
+
+    Options options;
+    QTcpServer *tcpServer = nullptr;
+    QLocalServer *localServer = nullptr;
+    QString lastError;
+
+    std::vector<ServerGame> games;
+    std::vector<int> freeSlots;
+    QHash<QIODevice *, std::vector<int>> connections;   // Kapcsolat -> saját játszmák
+    int activeGames = 0;
+    quint64 movesPlayed = 0;
+    quint64 engineMoves = 0;
+    LatencyHistogram engineLatency;
+    AnalysisCache cache;
+    GameArchiveWriter archive;
+
+    AsyncEngine engine;   // A korutinok az eseményhurokban folytatódnak
+    EnginePool pool;   // Utolsó tag: elsőként áll le, mielőtt a játszmák megszűnnek
+};
+
+#endif // GAMESERVER_H
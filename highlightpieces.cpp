@@ -24,7 +24,7 @@ void HighlightPieces::highlightMoves(int row, int col)
     }
 
     // Filter illegal moves (e.g., moves that expose the king to check)
-    widget->filterIllegalMoves();
+    widget->game.filterIllegalMoves();
     widget->updatePieceCount();
 }
 
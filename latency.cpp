@@ -0,0 +1,159 @@
+#include "latency.h"
+#include <cstdio>
+#include <fstream>
+
+int LatencyHistogram::bucketIndex(int64_t micros)
+{
+    if (micros < 8) return micros < 0 ? 0 : int(micros);
+    int msb = 63 - __builtin_clzll(uint64_t(micros));
+    int index = (msb - 2) * 8 + int((micros >> (msb - 3)) & 7);
+    return index < BucketCount ? index : BucketCount - 1;
+}
+
+int64_t LatencyHistogram::bucketLowerBound(int index)
+{
+    if (index < 8) return index;
+    int msb = index / 8 + 2;
+    return int64_t(8 + index % 8) << (msb - 3);
+}
+
+void LatencyHistogram::record(int64_t micros)
+{
+    buckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(micros, std::memory_order_relaxed);
+    int64_t previous = maximum.load(std::memory_order_relaxed);
+    while (micros > previous && !maximum.compare_exchange_weak(previous, micros, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::mean() const
+{
+    uint64_t n = count();
+    return n ? sum.load(std::memory_order_relaxed) / int64_t(n) : 0;
+}
+
+int64_t LatencyHistogram::percentile(double fraction) const
+{
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t target = uint64_t(fraction * double(n) + 0.999999);
+    if (target == 0) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            // A vödör közepét adjuk vissza, de sosem többet a mért maximumnál
+            int64_t low = bucketLowerBound(i);
+            int64_t high = i + 1 < BucketCount ? bucketLowerBound(i + 1) : low;
+            int64_t value = low + (high - low) / 2;
+            return value < max() ? value : max();
+        }
+    }
+    return max();
+}
+
+LatencyStats::LatencyStats()
+{
+    // Alapértelmezett keretek: egy képkocka (60 Hz) a felhasználói interakciókra
+    budgets[int(LatencyStage::MouseInput)] = 16000;
+    budgets[int(LatencyStage::LegalMoves)] = 5000;
+    budgets[int(LatencyStage::ApplyMove)] = 5000;
+    budgets[int(LatencyStage::GameOverScan)] = 5000;
+    budgets[int(LatencyStage::EngineRoundTrip)] = 0;
+    budgets[int(LatencyStage::Paint)] = 16000;
+    budgets[int(LatencyStage::ClickToPaint)] = 33000;
+}
+
+LatencyStats &LatencyStats::instance()
+{
+    static LatencyStats stats;
+    return stats;
+}
+
+void LatencyStats::record(LatencyStage stage, int64_t micros)
+{
+    int index = int(stage);
+    histograms[index].record(micros);
+    if (budgets[index] > 0 && micros > budgets[index]) violations[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyStats::reset()
+{
+    for (int i = 0; i < int(LatencyStage::Count); ++i) {
+        histograms[i].reset();
+        violations[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char *LatencyStats::stageName(LatencyStage stage)
+{
+    switch (stage) {
+    case LatencyStage::MouseInput: return "mouse_input";
+    case LatencyStage::LegalMoves: return "legal_moves";
+    case LatencyStage::ApplyMove: return "apply_move";
+    case LatencyStage::GameOverScan: return "game_over_scan";
+    case LatencyStage::EngineRoundTrip: return "engine_round_trip";
+    case LatencyStage::Paint: return "paint";
+    case LatencyStage::ClickToPaint: return "click_to_paint";
+    case LatencyStage::Count: break;
+    }
+    return "unknown";
+}
+
+std::vector<std::string> LatencyStats::summaryLines() const
+{
+    std::vector<std::string> lines;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-18s %7s %8s %8s %8s %8s", "stage (us)", "n", "p50", "p95", "p99", "max");
+    lines.push_back(line);
+    for (int i = 0; i < int(LatencyStage::Count); ++i) {
+        const LatencyHistogram &h = histograms[i];
+        std::snprintf(line, sizeof(line), "%-18s %7llu %8lld %8lld %8lld %8lld",
+                      stageName(LatencyStage(i)), (unsigned long long)h.count(),
+                      (long long)h.percentile(0.50), (long long)h.percentile(0.95),
+                      (long long)h.percentile(0.99), (long long)h.max());
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+bool LatencyStats::exportToFile(const std::string &path) const
+{
+    std::ofstream out(path);
+    if (!out) return false;
+
+    out << "{\n  \"unit\": \"us\",\n  \"stages\": [\n";
+    for (int i = 0; i < int(LatencyStage::Count); ++i) {
+        const LatencyHistogram &h = histograms[i];
+        out << "    {\"name\": \"" << stageName(LatencyStage(i)) << "\""
+            << ", \"count\": " << h.count()
+            << ", \"mean\": " << h.mean()
+            << ", \"p50\": " << h.percentile(0.50)
+            << ", \"p95\": " << h.percentile(0.95)
+            << ", \"p99\": " << h.percentile(0.99)
+            << ", \"max\": " << h.max()
+            << ", \"budget\": " << budgets[i]
+            << ", \"over_budget\": " << violations[i].load(std::memory_order_relaxed)
+            << ", \"buckets\": [";
+        // Csak a nem üres vödröket írjuk ki: [alsó határ, darabszám]
+        bool first = true;
+        for (int b = 0; b < LatencyHistogram::BucketCount; ++b) {
+            uint64_t n = h.bucket(b);
+            if (!n) continue;
+            out << (first ? "" : ", ") << "[" << LatencyHistogram::bucketLowerBound(b) << ", " << n << "]";
+            first = false;
+        }
+        out << "]}" << (i + 1 < int(LatencyStage::Count) ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return bool(out);
+}
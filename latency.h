@@ -0,0 +1,91 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Per-stage latency histograms for the move pipeline
+// (click -> legal moves -> applyMove -> game over scan -> engine round trip -> paint).
+// Recording is a couple of relaxed atomic increments, so the timers can stay
+// enabled in release builds.
+
+enum class LatencyStage {
+    MouseInput,       // Whole mousePressEvent
+    LegalMoves,       // highlightMoves / legal move computation
+    ApplyMove,        // applyMove
+    GameOverScan,     // Checkmate / stalemate / draw detection after a move
+    EngineRoundTrip,  // Engine request -> bestmove received
+    Paint,            // paintEvent
+    ClickToPaint,     // mousePressEvent -> next finished paintEvent
+    Count
+};
+
+class LatencyHistogram
+{
+public:
+    static const int BucketCount = 312;   // 8 buckets per power of two up to ~2^40 us
+
+    void record(int64_t micros);
+    void reset();
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    int64_t max() const { return maximum.load(std::memory_order_relaxed); }
+    int64_t mean() const;
+    int64_t percentile(double fraction) const;   // 0.5 = p50, in microseconds
+    uint64_t bucket(int index) const { return buckets[index].load(std::memory_order_relaxed); }
+
+    static int bucketIndex(int64_t micros);
+    static int64_t bucketLowerBound(int index);
+
+private:
+    std::atomic<uint64_t> buckets[BucketCount] = {};
+    std::atomic<uint64_t> total { 0 };
+    std::atomic<int64_t> sum { 0 };
+    std::atomic<int64_t> maximum { 0 };
+};
+
+class LatencyStats
+{
+public:
+    static LatencyStats &instance();
+
+    void record(LatencyStage stage, int64_t micros);
+    void reset();
+    const LatencyHistogram &histogram(LatencyStage stage) const { return histograms[int(stage)]; }
+
+    // Budget in microseconds, 0 = no budget. Samples above it are counted.
+    void setBudget(LatencyStage stage, int64_t micros) { budgets[int(stage)] = micros; }
+    int64_t budget(LatencyStage stage) const { return budgets[int(stage)]; }
+    uint64_t overBudget(LatencyStage stage) const { return violations[int(stage)].load(std::memory_order_relaxed); }
+
+    static const char *stageName(LatencyStage stage);
+    std::vector<std::string> summaryLines() const;
+    bool exportToFile(const std::string &path) const;   // JSON
+
+private:
+    LatencyStats();
+
+    LatencyHistogram histograms[int(LatencyStage::Count)];
+    int64_t budgets[int(LatencyStage::Count)];
+    std::atomic<uint64_t> violations[int(LatencyStage::Count)] = {};
+};
+
+// Records the lifetime of the object into the given stage.
+class ScopedLatencyTimer
+{
+public:
+    explicit ScopedLatencyTimer(LatencyStage stage) : stage(stage), start(std::chrono::steady_clock::now()) {}
+    ~ScopedLatencyTimer()
+    {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        LatencyStats::instance().record(stage, micros);
+    }
+
+private:
+    LatencyStage stage;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif // LATENCY_H
@@ -0,0 +1,198 @@
+#include "position.h"
+#include "latency.h"
+#include <QCoreApplication>
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Load generator for chess_server.
+//
+//   chess_loadgen [--port 7878 | --unix name] [--connections 16] [--games 64] [--duration 10]
+//
+// Every connection keeps --games games running at the same time and plays a
+// random legal move as soon as it is its turn. Finished games are closed and
+// replaced. At the end moves/second and round-trip latencies are printed.
+
+namespace {
+
+qint64 nowMicros()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Totals
+{
+    quint64 moves = 0;          // Elfogadott saját lépések
+    quint64 engineMoves = 0;
+    quint64 finishedGames = 0;
+    quint64 errors = 0;
+    LatencyHistogram moveLatency;     // move -> ok
+    LatencyHistogram engineLatency;   // move -> engine válasz
+};
+
+class LoadClient : public QObject
+{
+public:
+    LoadClient(QIODevice *socket, int gameCount, Totals &totals, uint32_t seed)
+        : socket(socket), gameCount(gameCount), totals(totals), random(seed)
+    {
+        connect(socket, &QIODevice::readyRead, this, [this]() { readReplies(); });
+    }
+
+    void start()
+    {
+        for (int i = 0; i < gameCount; ++i) send("new");
+    }
+
+    void stop() { stopped = true; }
+
+private:
+    struct ClientGame
+    {
+        Position position;
+        qint64 sentAt = 0;
+    };
+
+    void send(const QByteArray &line)
+    {
+        socket->write(line);
+        socket->write("\n", 1);
+    }
+
+    void readReplies()
+    {
+        while (socket->canReadLine()) {
+            QList<QByteArray> parts = socket->readLine().trimmed().split(' ');
+            const QByteArray &reply = parts[0];
+            int id = parts.value(1).toInt();
+
+            if (reply == "game") {
+                games[id].position.setStartPosition();
+                playMove(id);
+            } else if (reply == "ok") {
+                ClientGame &game = games[id];
+                totals.moveLatency.record(nowMicros() - game.sentAt);
+                ++totals.moves;
+                game.position.makeMove(game.position.parseUciMove(parts.value(2).toStdString()));
+            } else if (reply == "engine") {
+                ClientGame &game = games[id];
+                totals.engineLatency.record(nowMicros() - game.sentAt);
+                ++totals.engineMoves;
+                game.position.makeMove(game.position.parseUciMove(parts.value(2).toStdString()));
+                if (game.position.outcome() == GameOutcome::Ongoing) playMove(id);
+            } else if (reply == "over") {
+                ++totals.finishedGames;
+                games.remove(id);
+                send("close " + parts.value(1));
+                if (!stopped) send("new");
+            } else if (reply == "error" || reply == "illegal") {
+                ++totals.errors;
+            }
+        }
+    }
+
+    void playMove(int id)
+    {
+        if (stopped) return;
+        ClientGame &game = games[id];
+        MoveList legal;
+        game.position.generateLegal(legal);
+        if (legal.count == 0) return;   // Az "over" üzenet jön
+
+        Move move = legal.moves[std::uniform_int_distribution<int>(0, legal.count - 1)(random)];
+        game.sentAt = nowMicros();
+        send("move " + QByteArray::number(id) + " " + QByteArray::fromStdString(Position::moveToUci(move)));
+    }
+
+    QIODevice *socket;
+    int gameCount;
+    Totals &totals;
+    std::mt19937 random;
+    QHash<int, ClientGame> games;
+    bool stopped = false;
+};
+
+void printHistogram(QTextStream &out, const char *name, const LatencyHistogram &histogram)
+{
+    out << QString("%1 n=%2 p50=%3us p95=%4us p99=%5us max=%6us\n")
+               .arg(name)
+               .arg(histogram.count())
+               .arg(histogram.percentile(0.50))
+               .arg(histogram.percentile(0.95))
+               .arg(histogram.percentile(0.99))
+               .arg(histogram.max());
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    quint16 port = 7878;
+    QString localName;
+    int connectionCount = 16;
+    int gamesPerConnection = 64;
+    int durationSeconds = 10;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--port" && i + 1 < args.size()) port = quint16(args[++i].toUInt());
+        else if (args[i] == "--unix" && i + 1 < args.size()) localName = args[++i];
+        else if (args[i] == "--connections" && i + 1 < args.size()) connectionCount = args[++i].toInt();
+        else if (args[i] == "--games" && i + 1 < args.size()) gamesPerConnection = args[++i].toInt();
+        else if (args[i] == "--duration" && i + 1 < args.size()) durationSeconds = args[++i].toInt();
+    }
+
+    Totals totals;
+    std::vector<LoadClient *> clients;
+    for (int i = 0; i < connectionCount; ++i) {
+        QIODevice *socket;
+        if (localName.isEmpty()) {
+            QTcpSocket *tcp = new QTcpSocket(&app);
+            tcp->connectToHost("127.0.0.1", port);
+            tcp->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            if (!tcp->waitForConnected(3000)) {
+                qWarning("Cannot connect to 127.0.0.1:%d", int(port));
+                return 1;
+            }
+            socket = tcp;
+        } else {
+            QLocalSocket *local = new QLocalSocket(&app);
+            local->connectToServer(localName);
+            if (!local->waitForConnected(3000)) {
+                qWarning("Cannot connect to %s", qPrintable(localName));
+                return 1;
+            }
+            socket = local;
+        }
+        LoadClient *client = new LoadClient(socket, gamesPerConnection, totals, uint32_t(i + 1));
+        client->setParent(&app);
+        clients.push_back(client);
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    for (LoadClient *client : clients) client->start();
+
+    QTimer::singleShot(durationSeconds * 1000, &app, [&]() {
+        for (LoadClient *client : clients) client->stop();
+        double seconds = elapsed.nsecsElapsed() / 1e9;
+        QTextStream out(stdout);
+        out << QString("connections=%1 games=%2 duration=%3s\n")
+                   .arg(connectionCount).arg(connectionCount * gamesPerConnection).arg(seconds, 0, 'f', 1);
+        out << QString("moves/s=%1 (client %2, engine %3) finished_games=%4 errors=%5\n")
+                   .arg((totals.moves + totals.engineMoves) / seconds, 0, 'f', 0)
+                   .arg(totals.moves).arg(totals.engineMoves)
+                   .arg(totals.finishedGames).arg(totals.errors);
+        printHistogram(out, "move_ack  ", totals.moveLatency);
+        printHistogram(out, "engine_rtt", totals.engineLatency);
+        app.quit();
+    });
+    return app.exec();
+}
@@ -0,0 +1,295 @@
+#include "logger.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+namespace Log {
+
+std::atomic<int> minimumLevel { Off };   // start() előtt minden hívás egy betöltés és egy ugrás
+
+namespace {
+
+struct Record
+{
+    int64_t timestamp;   // us since epoch
+    const char *event;
+    uint32_t thread;
+    uint8_t level;
+    Field fields[4];
+};
+
+// Korlátos MPMC gyűrű (Vyukov): minden cellának saját sorszáma van, így sem az
+// írók, sem az olvasó nem zár. Itt egyetlen olvasó van, a háttérszál.
+class RecordQueue
+{
+public:
+    static const uint64_t Capacity = 4096;
+
+    RecordQueue()
+    {
+        for (uint64_t i = 0; i < Capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    // Returns the slot index, or -1 when the queue is full
+    int64_t push(const Record &record)
+    {
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Cell &cell = cells[position & (Capacity - 1)];
+            uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+            int64_t difference = int64_t(sequence) - int64_t(position);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.record = record;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return int64_t(position);
+                }
+            } else if (difference < 0) {
+                return -1;   // Tele
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(Record &record)
+    {
+        Cell &cell = cells[head & (Capacity - 1)];
+        uint64_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (int64_t(sequence) - int64_t(head + 1) < 0) return false;   // Üres
+        record = cell.record;
+        cell.sequence.store(head + Capacity, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<uint64_t> sequence;
+        Record record;
+    };
+
+    Cell cells[Capacity];
+    alignas(64) std::atomic<uint64_t> tail { 0 };
+    alignas(64) uint64_t head = 0;   // Csak a háttérszál használja
+};
+
+RecordQueue queue;
+std::atomic<uint64_t> dropped { 0 };        // Még nem jelentett eldobások
+std::atomic<uint64_t> totalDropped { 0 };
+std::atomic<uint32_t> nextThreadId { 1 };
+
+std::mutex controlMutex;   // start/stop, és a háttérszál ébresztése
+std::condition_variable wakeUp;
+std::thread writerThread;
+bool stopping = false;
+
+std::string logPath;
+int64_t rotateBytes = 0;
+int rotateKeep = 0;
+std::FILE *file = nullptr;
+int64_t fileSize = 0;
+
+const char *levelName(int level)
+{
+    switch (level) {
+    case Debug: return "debug";
+    case Info: return "info";
+    case Warning: return "warning";
+    case Error: return "error";
+    }
+    return "off";
+}
+
+void writeEscaped(std::string &out, const char *text)
+{
+    for (const char *p = text; *p; ++p) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (uint8_t(c) < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += c;
+        }
+    }
+}
+
+void format(const Record &record, std::string &out)
+{
+    char buffer[64];
+    std::time_t seconds = std::time_t(record.timestamp / 1000000);
+    std::tm utc;
+#ifdef _WIN32
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", &utc);
+
+    out += "{\"ts\":\"";
+    out += buffer;
+    std::snprintf(buffer, sizeof(buffer), ".%06dZ\",\"level\":\"", int(record.timestamp % 1000000));
+    out += buffer;
+    out += levelName(record.level);
+    std::snprintf(buffer, sizeof(buffer), "\",\"thread\":%u,\"event\":\"", record.thread);
+    out += buffer;
+    writeEscaped(out, record.event);
+    out += '"';
+
+    for (const Field &field : record.fields) {
+        if (field.type == Field::None) continue;
+        out += ",\"";
+        writeEscaped(out, field.key);
+        out += "\":";
+        switch (field.type) {
+        case Field::Integer:
+            std::snprintf(buffer, sizeof(buffer), "%lld", (long long)field.integer);
+            out += buffer;
+            break;
+        case Field::Real:
+            std::snprintf(buffer, sizeof(buffer), "%.6g", field.real);
+            out += buffer;
+            break;
+        case Field::Boolean:
+            out += field.integer ? "true" : "false";
+            break;
+        case Field::Text:
+            out += '"';
+            writeEscaped(out, field.text);
+            out += '"';
+            break;
+        case Field::None:
+            break;
+        }
+    }
+    out += "}\n";
+}
+
+void rotate()
+{
+    std::fclose(file);
+    // chess.log.2 -> chess.log.3, chess.log.1 -> chess.log.2, chess.log -> chess.log.1
+    for (int i = rotateKeep - 1; i >= 1; --i) {
+        std::rename((logPath + "." + std::to_string(i)).c_str(), (logPath + "." + std::to_string(i + 1)).c_str());
+    }
+    if (rotateKeep > 0) std::rename(logPath.c_str(), (logPath + ".1").c_str());
+    file = std::fopen(logPath.c_str(), "w");
+    fileSize = 0;
+}
+
+void drain()
+{
+    std::string batch;
+    Record record;
+    while (true) {
+        batch.clear();
+        while (batch.size() < 64 * 1024 && queue.pop(record)) format(record, batch);
+        if (batch.empty()) break;
+        if (!file) continue;
+
+        std::fwrite(batch.data(), 1, batch.size(), file);
+        fileSize += int64_t(batch.size());
+        if (rotateBytes > 0 && fileSize >= rotateBytes) rotate();
+    }
+    if (file) std::fflush(file);
+
+    // Az eldobott rekordokról is marad nyom (a következő körben íródik ki)
+    uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost) write(Warning, "log_records_dropped", Field("count", (unsigned long long)lost));
+}
+
+void writerLoop()
+{
+    std::unique_lock<std::mutex> lock(controlMutex);
+    while (!stopping) {
+        // Az írók nem ébresztenek (az rendszerhívás lenne), a szál magától néz rá
+        wakeUp.wait_for(lock, std::chrono::milliseconds(50));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+    lock.unlock();
+    drain();
+    drain();   // Az esetleges "log_records_dropped" rekord
+}
+
+} // namespace
+
+bool start(const std::string &path, Level level, int64_t maxBytes, int keepFiles)
+{
+    std::lock_guard<std::mutex> lock(controlMutex);
+    if (file) return true;
+
+    file = std::fopen(path.c_str(), "a");
+    if (!file) return false;
+    std::fseek(file, 0, SEEK_END);
+    fileSize = std::ftell(file);
+    logPath = path;
+    rotateBytes = maxBytes;
+    rotateKeep = keepFiles;
+    stopping = false;
+    writerThread = std::thread(writerLoop);
+    minimumLevel.store(level, std::memory_order_relaxed);
+    return true;
+}
+
+void stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(controlMutex);
+        if (!file) return;
+        stopping = true;
+    }
+    wakeUp.notify_one();
+    writerThread.join();
+    minimumLevel.store(Off, std::memory_order_relaxed);
+    std::fclose(file);
+    file = nullptr;
+}
+
+uint64_t droppedRecords()
+{
+    return totalDropped.load(std::memory_order_relaxed);
+}
+
+Level levelFromName(const std::string &name)
+{
+    if (name == "debug") return Debug;
+    if (name == "info") return Info;
+    if (name == "warning") return Warning;
+    if (name == "error") return Error;
+    return Off;
+}
+
+void write(Level level, const char *event, const Field &a, const Field &b, const Field &c, const Field &d)
+{
+    thread_local uint32_t threadId = nextThreadId.fetch_add(1, std::memory_order_relaxed);
+
+    Record record;
+    record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::system_clock::now().time_since_epoch()).count();
+    record.event = event;
+    record.thread = threadId;
+    record.level = uint8_t(level);
+    record.fields[0] = a;
+    record.fields[1] = b;
+    record.fields[2] = c;
+    record.fields[3] = d;
+    int64_t slot = queue.push(record);
+    if (slot < 0) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        totalDropped.fetch_add(1, std::memory_order_relaxed);
+    } else if ((slot & (RecordQueue::Capacity / 4 - 1)) == 0 || level >= Error) {
+        wakeUp.notify_one();   // Nagy forgalomnál vagy hibánál nem várjuk ki a következő kört
+    }
+}
+
+} // namespace Log
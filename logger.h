@@ -0,0 +1,99 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#ifdef QT_CORE_LIB
+#include <QString>
+#endif
+
+// Structured asynchronous logger.
+// A log call checks the level (one relaxed load), copies the event name and up
+// to four key/value fields into a fixed-size record and pushes it into a
+// lock-free ring buffer. Formatting (JSON lines) and file I/O happen on a
+// background thread that also rotates the file. When the ring is full records
+// are dropped and counted instead of blocking the caller.
+//
+//   LOG_INFO("apply_move", {"move", move}, {"ms", elapsed});
+//
+// LOG_DEBUG compiles to nothing below CHESS_LOG_MIN_LEVEL (0 = debug, 1 = info),
+// which defaults to 1 in release (NDEBUG) builds.
+namespace Log {
+
+enum Level { Debug = 0, Info = 1, Warning = 2, Error = 3, Off = 4 };
+
+struct Field
+{
+    static const int TextSize = 48;
+    enum Type : uint8_t { None, Integer, Real, Boolean, Text };
+
+    Field() {}
+    Field(const char *key, int value) : key(key), type(Integer) { integer = value; }
+    Field(const char *key, long value) : key(key), type(Integer) { integer = value; }
+    Field(const char *key, long long value) : key(key), type(Integer) { integer = value; }
+    Field(const char *key, unsigned value) : key(key), type(Integer) { integer = value; }
+    Field(const char *key, unsigned long value) : key(key), type(Integer) { integer = int64_t(value); }
+    Field(const char *key, unsigned long long value) : key(key), type(Integer) { integer = int64_t(value); }
+    Field(const char *key, double value) : key(key), type(Real) { real = value; }
+    Field(const char *key, bool value) : key(key), type(Boolean) { integer = value; }
+    Field(const char *key, const char *value) : key(key), type(Text) { setText(value, value ? std::char_traits<char>::length(value) : 0); }
+    Field(const char *key, const std::string &value) : key(key), type(Text) { setText(value.data(), value.size()); }
+#ifdef QT_CORE_LIB
+    Field(const char *key, const QString &value) : key(key), type(Text)
+    {
+        QByteArray utf8 = value.toUtf8();
+        setText(utf8.constData(), size_t(utf8.size()));
+    }
+#endif
+
+    void setText(const char *value, size_t length)
+    {
+        if (length >= TextSize) length = TextSize - 1;   // Hosszabb szöveget csonkolunk
+        std::char_traits<char>::copy(text, value ? value : "", length);
+        text[length] = 0;
+    }
+
+    const char *key = nullptr;   // String literal
+    Type type = None;
+    union {
+        int64_t integer;
+        double real;
+        char text[TextSize];
+    };
+};
+
+extern std::atomic<int> minimumLevel;
+
+inline bool enabled(Level level) { return level >= minimumLevel.load(std::memory_order_relaxed); }
+
+// path: log file; rotated to path.1 .. path.<keepFiles> once it reaches maxBytes
+bool start(const std::string &path, Level level = Info, int64_t maxBytes = 10 * 1024 * 1024, int keepFiles = 3);
+void stop();   // Drains the queue and closes the file
+uint64_t droppedRecords();
+Level levelFromName(const std::string &name);
+
+void write(Level level, const char *event, const Field &a = Field(), const Field &b = Field(),
+           const Field &c = Field(), const Field &d = Field());
+
+} // namespace Log
+
+#ifndef CHESS_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define CHESS_LOG_MIN_LEVEL 1
+#else
+#define CHESS_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+#define LOG_AT(level, ...) do { if (Log::enabled(level)) Log::write(level, __VA_ARGS__); } while (0)
+#if CHESS_LOG_MIN_LEVEL <= 0
+#define LOG_DEBUG(...) LOG_AT(Log::Debug, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+#define LOG_INFO(...) LOG_AT(Log::Info, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(Log::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(Log::Error, __VA_ARGS__)
+
+#endif // LOGGER_H
@@ -1,11 +1,38 @@
 #include "widget.h"
+#include "multiboardview.h"
 #include <QApplication>
 #include <QDebug>
+#include <QScopedPointer>
+#include "trace.h"
+#include "logger.h"
 
 int main(int argc, char *argv[])
 {
+    // CHESS_TRACE=trace.json: Chrome/Perfetto trace a futásról, kilépéskor mentve
+    QString tracePath = qEnvironmentVariable("CHESS_TRACE");
+    if (!tracePath.isEmpty()) {
+        Trace::start(tracePath.toStdString());
+        Trace::setThreadName("GUI");
+    }
+
+    // CHESS_LOG=fájl (alapból chess.log), CHESS_LOG_LEVEL=debug|info|warning|error|off
+    Log::Level logLevel = Log::levelFromName(qEnvironmentVariable("CHESS_LOG_LEVEL", "info").toStdString());
+    if (logLevel != Log::Off) Log::start(qEnvironmentVariable("CHESS_LOG", "chess.log").toStdString(), logLevel);
+
     QApplication a(argc, argv);
-    Widget w;
-    w.show();
-    return a.exec();
+
+    // --boards N: N motor-motor játszma egy ablakban (szimultán / botfigyelés)
+    int boards = 0;
+    QStringList args = a.arguments();
+    int boardsIndex = args.indexOf("--boards");
+    if (boardsIndex >= 0) boards = args.value(boardsIndex + 1, "64").toInt();
+
+    QScopedPointer<QWidget> w(boards > 0 ? static_cast<QWidget *>(new MultiBoardView(boards)) : new Widget);
+    w->show();
+    int result = a.exec();
+    w.reset();   // Az utolsó naplóbejegyzések (motor leállítása) még a logger leállítása előtt
+    Log::stop();
+
+    if (!tracePath.isEmpty() && !Trace::stop()) qDebug() << "❌ Nem sikerült menteni a trace fájlt:" << tracePath;
+    return result;
 }
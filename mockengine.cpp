@@ -0,0 +1,310 @@
+#include "position.h"
+#include "boundedqueue.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Scriptable stand-in for a UCI engine, for protocol tests and benchmarks
+// without a real engine binary.
+//
+//   chess_mockengine [--transcript file] [--delay ms] [--rate lines/s] [--info n]
+//                    [--startup ms] [--crash-after n] [--hang-after n]
+//
+// Transcript: recorded or hand-written session, "> command" lines followed by
+// the "< response" lines the engine sent for it. Responses are keyed by the
+// first word of the command; repeated commands cycle through the recorded
+// blocks. "< @sleep ms" pauses, "{move}" is replaced with a legal move in the
+// current position. Without a transcript (or without a "go" block) the engine
+// answers uci/isready itself and prints --info synthetic info lines per search.
+//
+// --delay waits before each bestmove, --rate paces info lines (0 = no pacing).
+// --crash-after n exits abruptly on the n-th go, --hang-after n never answers
+// it: both for testing the UCIEngine supervisor.
+
+namespace {
+
+struct Options
+{
+    std::string transcript;
+    int delayMs = 0;
+    int rate = 0;
+    int infoLines = 10;
+    int startupMs = 0;
+    int crashAfter = 0;
+    int hangAfter = 0;
+};
+
+struct Block
+{
+    std::vector<std::string> lines;
+};
+
+class MockEngine
+{
+public:
+    explicit MockEngine(const Options &options) : options(options), commands(1024) {}
+
+    bool loadTranscript(const std::string &path);
+    int run();
+
+private:
+    void reader();
+    void handle(const std::string &command);
+    void setPosition(const std::string &command);
+    void search(const std::string &command);
+    bool replay(const std::string &verb);
+    void send(const std::string &line);
+    void sleepFor(int ms);
+    bool interruptedBy(std::string &command);
+    std::string expand(const std::string &line);
+    std::string chooseMove();
+
+    Options options;
+    std::map<std::string, std::vector<Block>> blocks;
+    std::map<std::string, size_t> nextBlock;
+    BoundedQueue<std::string> commands;
+    std::deque<std::string> deferred;   // Keresés közben érkezett, utána feldolgozandó parancsok
+    Position position;
+    int searches = 0;
+    bool quitting = false;
+};
+
+bool MockEngine::loadTranscript(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    Block *current = nullptr;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.size() < 2 || line[0] == '#') continue;
+        std::string text = line.substr(line[1] == ' ' ? 2 : 1);
+        if (line[0] == '>') {
+            std::string verb = text.substr(0, text.find(' '));
+            blocks[verb].push_back(Block());
+            current = &blocks[verb].back();
+        } else if (line[0] == '<' && current) {
+            current->lines.push_back(text);
+        }
+    }
+    return true;
+}
+
+int MockEngine::run()
+{
+    position.setStartPosition();
+    std::thread input(&MockEngine::reader, this);
+    input.detach();   // A getline nem szakítható meg; kilépéskor a folyamattal együtt ér véget
+
+    sleepFor(options.startupMs);
+    std::string command;
+    while (!quitting) {
+        if (!deferred.empty()) {
+            command = deferred.front();
+            deferred.pop_front();
+        } else if (!commands.pop(command)) {
+            break;
+        }
+        handle(command);
+    }
+    std::fflush(stdout);
+    return 0;
+}
+
+void MockEngine::reader()
+{
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!commands.push(line)) return;
+    }
+    commands.close();
+}
+
+void MockEngine::send(const std::string &line)
+{
+    // Soronként ürítjük, ahogy a valódi motorok is
+    std::fputs(line.c_str(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+}
+
+void MockEngine::sleepFor(int ms)
+{
+    if (ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+std::string MockEngine::chooseMove()
+{
+    MoveList legal;
+    position.generateLegal(legal);
+    if (legal.count == 0) return "(none)";
+    // Állásonként rögzített, de nem mindig ugyanaz az első lépés
+    return Position::moveToUci(legal.moves[position.key() % uint64_t(legal.count)]);
+}
+
+std::string MockEngine::expand(const std::string &line)
+{
+    size_t at = line.find("{move}");
+    if (at == std::string::npos) return line;
+    return line.substr(0, at) + chooseMove() + line.substr(at + 6);
+}
+
+bool MockEngine::replay(const std::string &verb)
+{
+    auto it = blocks.find(verb);
+    if (it == blocks.end() || it->second.empty()) return false;
+    size_t &index = nextBlock[verb];
+    const Block &block = it->second[index++ % it->second.size()];
+    for (const std::string &line : block.lines) {
+        if (line.compare(0, 7, "@sleep ") == 0) sleepFor(std::atoi(line.c_str() + 7));
+        else send(expand(line));
+    }
+    return true;
+}
+
+void MockEngine::handle(const std::string &command)
+{
+    std::istringstream tokens(command);
+    std::string verb;
+    tokens >> verb;
+
+    if (verb == "quit") {
+        quitting = true;
+    } else if (verb == "position") {
+        setPosition(command);
+    } else if (verb == "go") {
+        search(command);
+    } else if (verb == "stop" || verb == "setoption" || verb == "ucinewgame") {
+        replay(verb);   // Válasz nélküli parancsok, hacsak az átirat mást nem mond
+    } else if (!replay(verb)) {
+        if (verb == "uci") {
+            send("id name MockEngine");
+            send("id author chess");
+            send("option name Hash type spin default 16 min 1 max 1024");
+            send("option name Threads type spin default 1 min 1 max 64");
+            send("option name MultiPV type spin default 1 min 1 max 5");
+            send("option name Skill Level type spin default 20 min 0 max 20");
+            send("uciok");
+        } else if (verb == "isready") {
+            send("readyok");
+        }
+    }
+}
+
+void MockEngine::setPosition(const std::string &command)
+{
+    std::istringstream tokens(command);
+    std::string token;
+    tokens >> token >> token;
+    if (token == "fen") {
+        std::string fen, part;
+        while (tokens >> part && part != "moves") fen += (fen.empty() ? "" : " ") + part;
+        position.setFen(fen);
+        token = part;
+    } else {
+        position.setStartPosition();
+        tokens >> token;
+    }
+    if (token != "moves") return;
+    while (tokens >> token) {
+        Move move = position.parseUciMove(token);
+        if (move == NoMove || !position.makeMove(move)) break;
+    }
+}
+
+bool MockEngine::interruptedBy(std::string &command)
+{
+    // Keresés közben a "stop"/"quit" megszakít, az "isready"-re azonnal válaszolunk;
+    // minden más a keresés utánra marad, és az utána jövő "stop" már nem erre vonatkozik
+    while (deferred.empty() && commands.tryPop(command)) {
+        if (command == "stop" || command == "quit") return true;
+        if (command == "isready") send("readyok");
+        else deferred.push_back(command);
+    }
+    return false;
+}
+
+void MockEngine::search(const std::string &command)
+{
+    ++searches;
+    if (options.crashAfter > 0 && searches >= options.crashAfter) {
+        std::fflush(stdout);
+        std::abort();   // Összeomlás szimulálása
+    }
+    if (options.hangAfter > 0 && searches >= options.hangAfter) return;   // Soha nem válaszol
+
+    bool infinite = command.find("infinite") != std::string::npos;
+    std::string move = chooseMove();
+    std::vector<std::string> infos;
+    std::string bestLine = "bestmove " + move;
+
+    auto recorded = blocks.find("go");
+    if (recorded != blocks.end() && !recorded->second.empty()) {
+        const Block &block = recorded->second[nextBlock["go"]++ % recorded->second.size()];
+        for (const std::string &line : block.lines) {
+            if (line.compare(0, 8, "bestmove") == 0) bestLine = expand(line);
+            else infos.push_back(line);
+        }
+    } else {
+        for (int depth = 1; depth <= options.infoLines; ++depth) {
+            infos.push_back("info depth " + std::to_string(depth) + " seldepth " + std::to_string(depth + 4)
+                            + " multipv 1 score cp " + std::to_string(20 + depth) + " nodes " + std::to_string(depth * 1000)
+                            + " nps 1000000 time " + std::to_string(depth) + " pv " + move);
+        }
+    }
+
+    int pauseUs = options.rate > 0 ? 1000000 / options.rate : 0;
+    std::string interrupt;
+    bool stopped = false;
+    // Végtelen elemzésnél a sorokat a "stop"-ig ismételjük
+    do {
+        for (const std::string &info : infos) {
+            if (info.compare(0, 7, "@sleep ") == 0) sleepFor(std::atoi(info.c_str() + 7));
+            else send(expand(info));
+            if (pauseUs) std::this_thread::sleep_for(std::chrono::microseconds(pauseUs));
+            if ((stopped = interruptedBy(interrupt))) break;
+        }
+        if (infos.empty() && infinite) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            stopped = interruptedBy(interrupt);
+        }
+    } while (infinite && !stopped);
+
+    if (!stopped) sleepFor(options.delayMs);
+    send(bestLine);
+    if (interrupt == "quit") quitting = true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--transcript" && hasValue) options.transcript = argv[++i];
+        else if (arg == "--delay" && hasValue) options.delayMs = std::atoi(argv[++i]);
+        else if (arg == "--rate" && hasValue) options.rate = std::atoi(argv[++i]);
+        else if (arg == "--info" && hasValue) options.infoLines = std::atoi(argv[++i]);
+        else if (arg == "--startup" && hasValue) options.startupMs = std::atoi(argv[++i]);
+        else if (arg == "--crash-after" && hasValue) options.crashAfter = std::atoi(argv[++i]);
+        else if (arg == "--hang-after" && hasValue) options.hangAfter = std::atoi(argv[++i]);
+    }
+
+    MockEngine engine(options);
+    if (!options.transcript.empty() && !engine.loadTranscript(options.transcript)) {
+        std::fprintf(stderr, "Cannot read transcript %s\n", options.transcript.c_str());
+        return 1;
+    }
+    return engine.run();
+}
@@ -0,0 +1,150 @@
+#include "movelistmodel.h"
+#include "gamerecord.h"
+#include <QFont>
+#include <QStringList>
+#include <algorithm>
+#include <cstdlib>
+
+MoveListModel::MoveListModel(const GameRecord *record, QObject *parent)
+    : QAbstractTableModel(parent)
+    , record(record)
+{
+    reload();
+}
+
+int MoveListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rowsFor(line.size());
+}
+
+int MoveListModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 2;
+}
+
+QVariant MoveListModel::data(const QModelIndex &index, int role) const
+{
+    int node = nodeAt(index);
+    if (node < 0) return role == Qt::DisplayRole && index.isValid() && index.column() == 0 ? QVariant("...") : QVariant();
+
+    switch (role) {
+    case Qt::DisplayRole:
+        return san(node);
+    case Qt::FontRole:
+        if (node == currentNode) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        break;
+    case Qt::ToolTipRole: {
+        // Az ágaztatási pontokon a többi változat első lépése
+        const std::vector<int> &siblings = record->children(record->parent(node));
+        if (siblings.size() < 2) break;
+        QStringList variations;
+        for (int sibling : siblings) {
+            if (sibling != node) variations.append(san(sibling));
+        }
+        return QString("Variations: %1").arg(variations.join(", "));
+    }
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+QVariant MoveListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (role != Qt::DisplayRole) return QVariant();
+    if (orientation == Qt::Horizontal) return section == 0 ? QString("White") : QString("Black");
+    return firstMoveNumber + section;
+}
+
+void MoveListModel::reload()
+{
+    beginResetModel();
+    sanCache.clear();
+    line.clear();
+    for (int node = record->lineEnd(record->current()); node != GameRecord::Root; node = record->parent(node)) line.push_back(node);
+    std::reverse(line.begin(), line.end());
+    currentNode = record->current();
+
+    // Sorszámozás a kezdőállás FEN-jéből (lépésszám és a lépésre következő fél)
+    record->nearestSnapshot(GameRecord::Root, scratch);
+    blackFirst = scratch.whiteToMove() ? 0 : 1;
+    std::string fen = scratch.fen();
+    firstMoveNumber = std::max(1, std::atoi(fen.c_str() + fen.find_last_of(' ') + 1));
+    endResetModel();
+}
+
+void MoveListModel::refresh()
+{
+    std::vector<int> newLine;
+    newLine.reserve(line.size() + 1);
+    for (int node = record->lineEnd(record->current()); node != GameRecord::Root; node = record->parent(node)) newLine.push_back(node);
+    std::reverse(newLine.begin(), newLine.end());
+
+    size_t common = 0;
+    while (common < line.size() && common < newLine.size() && line[common] == newLine[common]) ++common;
+    int oldRows = rowsFor(line.size());
+    int newRows = rowsFor(newLine.size());
+
+    // Sorok hozzáadása / törlése a végén, a közös előtag utáni sorok frissítése
+    if (newRows < oldRows) {
+        beginRemoveRows(QModelIndex(), newRows, oldRows - 1);
+        line.swap(newLine);
+        endRemoveRows();
+    } else if (newRows > oldRows) {
+        beginInsertRows(QModelIndex(), oldRows, newRows - 1);
+        line.swap(newLine);
+        endInsertRows();
+    } else {
+        line.swap(newLine);
+    }
+    int firstChanged = int((common + size_t(blackFirst)) / 2);
+    int lastKept = std::min(oldRows, newRows) - 1;
+    if (common < std::max(line.size(), newLine.size()) && firstChanged <= lastKept)
+        emit dataChanged(index(firstChanged, 0), index(lastKept, 1));
+
+    // Az aktuális lépés kiemelése
+    if (currentNode != record->current()) {
+        QModelIndex previous = indexOf(currentNode);
+        currentNode = record->current();
+        QModelIndex next = indexOf(currentNode);
+        if (previous.isValid()) emit dataChanged(previous, previous, { Qt::FontRole });
+        if (next.isValid()) emit dataChanged(next, next, { Qt::FontRole });
+    }
+}
+
+int MoveListModel::nodeAt(const QModelIndex &index) const
+{
+    if (!index.isValid()) return -1;
+    int ply = index.row() * 2 + index.column() - blackFirst;
+    return ply >= 0 && ply < int(line.size()) ? line[size_t(ply)] : -1;
+}
+
+QModelIndex MoveListModel::indexOf(int node) const
+{
+    if (node == GameRecord::Root) return QModelIndex();
+    int ply = record->ply(node) - 1;
+    if (ply >= int(line.size()) || line[size_t(ply)] != node) return QModelIndex();
+    int cell = ply + blackFirst;
+    return index(cell / 2, cell % 2);
+}
+
+const QString &MoveListModel::san(int node) const
+{
+    if (sanCache.size() < size_t(record->nodeCount())) sanCache.resize(size_t(record->nodeCount()));
+    if (!sanCache[size_t(node)].isNull()) return sanCache[size_t(node)];
+
+    // Visszajátszás a legközelebbi pillanatképtől; az útba eső lépések SAN-ja is a gyorsítótárba kerül
+    int base = record->nearestSnapshot(record->parent(node), scratch);
+    replay.clear();
+    for (int n = node; n != base; n = record->parent(n)) replay.push_back(n);
+    for (auto it = replay.rbegin(); it != replay.rend(); ++it) {
+        Move move = record->move(*it);
+        if (sanCache[size_t(*it)].isNull()) sanCache[size_t(*it)] = QString::fromStdString(scratch.moveToSan(move));
+        scratch.makeMove(move);
+    }
+    return sanCache[size_t(node)];
+}
@@ -0,0 +1,48 @@
+#ifndef MOVELISTMODEL_H
+#define MOVELISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QString>
+#include <vector>
+#include "position.h"
+
+class GameRecord;
+
+// Move list of the line through the GameRecord's current node: one row per
+// full move, White and Black columns. The view only asks for the visible
+// rows; SAN is generated on first use (replaying from the nearest snapshot
+// caches every move on the way) and kept per record node, so switching
+// between variations does not regenerate anything.
+class MoveListModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit MoveListModel(const GameRecord *record, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void reload();    // The record was reset
+    void refresh();   // Moves played or the cursor moved; only the changed rows are signalled
+    int nodeAt(const QModelIndex &index) const;   // -1 for an empty cell
+    QModelIndex indexOf(int node) const;          // Invalid if the node is not on the line
+    const QString &san(int node) const;
+
+private:
+    int rowsFor(size_t plies) const { return plies ? int((plies + size_t(blackFirst) + 1) / 2) : 0; }
+
+    const GameRecord *record;
+    std::vector<int> line;        // line[i] = az (i + 1). fél lépés csomópontja
+    int blackFirst = 0;           // 1, ha a kezdőállásban sötét lép (az első sor fehér cellája üres)
+    int firstMoveNumber = 1;
+    int currentNode = 0;
+
+    mutable std::vector<QString> sanCache;   // Csomópontonként, null = még nem számoltuk
+    mutable Position scratch;
+    mutable std::vector<int> replay;
+};
+
+#endif // MOVELISTMODEL_H
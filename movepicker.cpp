@@ -0,0 +1,156 @@
+#include "movepicker.h"
+
+namespace {
+
+int pieceRank(char piece)
+{
+    switch (piece) {
+    case 'P': case 'p': return 1;
+    case 'N': case 'n': return 2;
+    case 'B': case 'b': return 3;
+    case 'R': case 'r': return 4;
+    case 'Q': case 'q': return 5;
+    case 'K': case 'k': return 6;
+    }
+    return 0;
+}
+
+} // namespace
+
+MovePicker::MovePicker(const Position &position, Move hashMove, const Move *killers, const HistoryTable *history)
+    : pos(position)
+    , hashMove(hashMove)
+    , history(history)
+    , stage(HashMove)
+{
+    if (killers) {
+        this->killers[0] = killers[0];
+        this->killers[1] = killers[1];
+    }
+}
+
+MovePicker::MovePicker(const Position &position, Move hashMove)
+    : pos(position)
+    , hashMove(hashMove)
+    , stage(QuiescenceHashMove)
+{
+    // A csendes keresésben csak taktikai hash lépést fogadunk el
+    if (hashMove != NoMove && !pos.isTactical(hashMove)) this->hashMove = NoMove;
+}
+
+void MovePicker::scoreCaptures()
+{
+    // MVV-LVA: a legértékesebb áldozat a legolcsóbb támadóval kerül előre
+    for (int i = 0; i < moves.count; ++i) {
+        Move move = moves.moves[i];
+        char attacker = pos.pieceAt(moveFrom(move));
+        int score = pieceRank(pos.capturedPiece(move)) * 8 - pieceRank(attacker);
+        if (movePromotion(move) == PromoteQueen) score += pieceRank('Q') * 8;
+        scores[i] = score;
+    }
+}
+
+void MovePicker::scoreQuiets()
+{
+    for (int i = 0; i < moves.count; ++i) {
+        Move move = moves.moves[i];
+        scores[i] = history ? (*history)[moveFrom(move)][moveTo(move)] : 0;
+    }
+}
+
+Move MovePicker::pickBest()
+{
+    // Kiválasztásos rendezés lépésenként: ha korán jön a vágás, a maradékot nem rendezzük
+    int best = current;
+    for (int i = current + 1; i < moves.count; ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    Move move = moves.moves[best];
+    moves.moves[best] = moves.moves[current];
+    scores[best] = scores[current];
+    moves.moves[current] = move;
+    ++current;
+    return move;
+}
+
+Move MovePicker::next()
+{
+    switch (stage) {
+    case HashMove:
+        stage = GenerateCaptures;
+        if (hashMove != NoMove && pos.isPseudoLegal(hashMove)) return hashMove;
+        // fall through
+    case GenerateCaptures:
+        moves.count = 0;
+        pos.generateCaptures(moves);
+        scoreCaptures();
+        current = 0;
+        stage = GoodCaptures;
+        // fall through
+    case GoodCaptures:
+        while (current < moves.count) {
+            Move move = pickBest();
+            if (move == hashMove) continue;
+            // Csak akkor fut SEE, ha a támadó értékesebb az áldozatnál
+            if (pieceRank(pos.pieceAt(moveFrom(move))) > pieceRank(pos.capturedPiece(move)) && pos.see(move) < 0) {
+                badCaptures.add(move);
+                continue;
+            }
+            return move;
+        }
+        stage = KillerMoves;
+        // fall through
+    case KillerMoves:
+        while (killerIndex < 2) {
+            Move killer = killers[killerIndex++];
+            if (killer != NoMove && killer != hashMove && !pos.isTactical(killer) && pos.isPseudoLegal(killer)) {
+                return killer;
+            }
+        }
+        stage = GenerateQuiets;
+        // fall through
+    case GenerateQuiets:
+        moves.count = 0;
+        pos.generateQuiets(moves);
+        scoreQuiets();
+        current = 0;
+        stage = QuietMoves;
+        // fall through
+    case QuietMoves:
+        while (current < moves.count) {
+            Move move = pickBest();
+            if (move == hashMove || move == killers[0] || move == killers[1]) continue;
+            return move;
+        }
+        stage = BadCaptures;
+        // fall through
+    case BadCaptures:
+        if (badCaptureIndex < badCaptures.count) return badCaptures.moves[badCaptureIndex++];
+        stage = Finished;
+        return NoMove;
+
+    case QuiescenceHashMove:
+        stage = QuiescenceGenerate;
+        if (hashMove != NoMove && pos.isPseudoLegal(hashMove)) return hashMove;
+        // fall through
+    case QuiescenceGenerate:
+        moves.count = 0;
+        pos.generateCaptures(moves);
+        scoreCaptures();
+        current = 0;
+        stage = QuiescenceCaptures;
+        // fall through
+    case QuiescenceCaptures:
+        while (current < moves.count) {
+            Move move = pickBest();
+            if (move == hashMove) continue;
+            if (pieceRank(pos.pieceAt(moveFrom(move))) > pieceRank(pos.capturedPiece(move)) && pos.see(move) < 0) continue;
+            return move;
+        }
+        stage = Finished;
+        // fall through
+    case Finished:
+        break;
+    }
+    return NoMove;
+}
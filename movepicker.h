@@ -0,0 +1,46 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "position.h"
+
+// Staged move ordering for the alpha-beta search.
+// Moves are handed out one at a time in the order: hash move, winning and
+// equal captures (MVV-LVA, checked with SEE), killers, quiets sorted by the
+// history table, losing captures. Quiet moves are only generated once the
+// capture and killer stages are exhausted, so nodes that cut off early never
+// pay for them.
+class MovePicker
+{
+public:
+    typedef int HistoryTable[64][64];
+
+    MovePicker(const Position &position, Move hashMove, const Move *killers, const HistoryTable *history);
+    // Quiescence search: hash move and captures only, losing captures are skipped
+    MovePicker(const Position &position, Move hashMove);
+
+    Move next();
+
+private:
+    enum Stage {
+        HashMove, GenerateCaptures, GoodCaptures, KillerMoves, GenerateQuiets, QuietMoves, BadCaptures,
+        QuiescenceHashMove, QuiescenceGenerate, QuiescenceCaptures, Finished
+    };
+
+    void scoreCaptures();
+    void scoreQuiets();
+    Move pickBest();
+
+    const Position &pos;
+    Move hashMove;
+    Move killers[2] = { NoMove, NoMove };
+    const HistoryTable *history = nullptr;
+    int stage;
+    int current = 0;
+    int killerIndex = 0;
+    int badCaptureIndex = 0;
+    MoveList moves;
+    MoveList badCaptures;
+    int scores[256];
+};
+
+#endif // MOVEPICKER_H
@@ -0,0 +1,147 @@
+#include "multiboardview.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QTimer>
+#include <cmath>
+
+namespace {
+
+const int RandomOpeningPlies = 4;   // Különböző nyitások, különben minden tábla ugyanazt játszaná
+const int TileMargin = 4;
+
+} // namespace
+
+MultiBoardView::MultiBoardView(int boardCount, QWidget *parent)
+    : QWidget(parent)
+    , tiles(boardCount)
+    , random(12345)
+    , pool(0, 1)
+{
+    setWindowTitle(QString("Chess - %1 boards").arg(boardCount));
+    setAttribute(Qt::WA_OpaquePaintEvent);   // Minden pixelt mi rajzolunk, nem kell háttértörlés
+    resize(1200, 1200);
+    engineLimits.movetime = 200;
+
+    for (int i = 0; i < boardCount; ++i) restartGame(i);
+}
+
+void MultiBoardView::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    layoutTiles();
+}
+
+void MultiBoardView::layoutTiles()
+{
+    int count = int(tiles.size());
+    if (count == 0) return;
+    int columns = int(std::ceil(std::sqrt(double(count))));
+    int rows = (count + columns - 1) / columns;
+    int cell = qMin(width() / columns, height() / rows);
+    int squareSize = qMax(1, (cell - TileMargin) / 8);
+
+    for (int i = 0; i < count; ++i) {
+        BoardTile &tile = tiles[i];
+        tile.rect = QRect((i % columns) * cell, (i / columns) * cell, squareSize * 8, squareSize * 8);
+        tile.dirty = true;
+    }
+    renderCache.clear();
+    update();
+}
+
+void MultiBoardView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    painter.fillRect(event->rect(), palette().window());
+
+    // Csak a frissítendő területtel metsző táblák; a változatlanok a saját pixmapjükből jönnek
+    for (BoardTile &tile : tiles) {
+        if (!event->region().intersects(tile.rect)) continue;
+        if (tile.dirty || tile.pixmap.size() != tile.rect.size()) renderTile(tile);
+        painter.drawPixmap(tile.rect.topLeft(), tile.pixmap);
+    }
+}
+
+void MultiBoardView::renderTile(BoardTile &tile)
+{
+    int squareSize = tile.rect.width() / 8;
+    if (tile.pixmap.size() != tile.rect.size()) tile.pixmap = QPixmap(tile.rect.size());
+
+    QPainter painter(&tile.pixmap);
+    painter.drawPixmap(0, 0, renderCache.background(squareSize));
+
+    if (tile.lastMove != NoMove) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(255, 255, 0, 100));  // Ugyanaz az átlátszó sárga, mint a fő táblán
+        for (int square : { moveFrom(tile.lastMove), moveTo(tile.lastMove) }) {
+            painter.drawRect((square % 8) * squareSize, (square / 8) * squareSize, squareSize, squareSize);
+        }
+    }
+
+    for (int square = 0; square < 64; ++square) {
+        char piece = tile.position.pieceAt(square);
+        if (piece != ' ') painter.drawPixmap((square % 8) * squareSize, (square / 8) * squareSize, renderCache.piece(piece, squareSize));
+    }
+
+    if (!tile.result.isEmpty()) {
+        painter.fillRect(tile.pixmap.rect(), QColor(0, 0, 0, 120));
+        painter.setPen(Qt::white);
+        painter.drawText(tile.pixmap.rect(), Qt::AlignCenter, tile.result);
+    }
+    tile.dirty = false;
+}
+
+void MultiBoardView::restartGame(int index)
+{
+    BoardTile &tile = tiles[index];
+    ++tile.generation;
+    tile.position.setStartPosition();
+    tile.lastMove = NoMove;
+    tile.result.clear();
+
+    for (int ply = 0; ply < RandomOpeningPlies; ++ply) {
+        MoveList legal;
+        tile.position.generateLegal(legal);
+        tile.lastMove = legal.moves[std::uniform_int_distribution<int>(0, legal.count - 1)(random)];
+        tile.position.makeMove(tile.lastMove);
+    }
+
+    tile.dirty = true;
+    update(tile.rect);
+    requestMove(index);
+}
+
+void MultiBoardView::requestMove(int index)
+{
+    BoardTile &tile = tiles[index];
+    uint32_t generation = tile.generation;
+    pool.submit(tile.position, engineLimits, [this, index, generation](const SearchResult &result) {
+        Move move = result.bestMove;
+        QMetaObject::invokeMethod(this, [this, index, generation, move]() {
+            onEngineMove(index, generation, move);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MultiBoardView::onEngineMove(int index, uint32_t generation, Move move)
+{
+    BoardTile &tile = tiles[index];
+    if (tile.generation != generation) return;
+
+    if (move != NoMove && tile.position.makeMove(move)) tile.lastMove = move;
+
+    GameOutcome outcome = tile.position.outcome();
+    if (outcome == GameOutcome::Ongoing && move != NoMove) {
+        requestMove(index);
+    } else {
+        bool whiteWon = outcome == GameOutcome::Checkmate && !tile.position.whiteToMove();
+        tile.result = outcome == GameOutcome::Checkmate ? (whiteWon ? "1-0" : "0-1") : "1/2-1/2";
+        QTimer::singleShot(3000, this, [this, index, generation]() {
+            if (tiles[index].generation == generation) restartGame(index);
+        });
+    }
+
+    // Csak ennek a táblának a területét érvénytelenítjük; a Qt összevonja az egy képkockán belüli kéréseket
+    tile.dirty = true;
+    update(tile.rect);
+}
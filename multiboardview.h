@@ -0,0 +1,52 @@
+#ifndef MULTIBOARDVIEW_H
+#define MULTIBOARDVIEW_H
+
+#include <QWidget>
+#include <QPixmap>
+#include <random>
+#include <vector>
+#include "position.h"
+#include "enginepool.h"
+#include "boardrendercache.h"
+
+// Tiled view of many engine-vs-engine games (simuls, bot monitoring).
+// Every board has its own Position; all boards share one EnginePool and one
+// BoardRenderCache. A board is only repainted when its position changed: each
+// tile keeps its own pixmap and only its rectangle is invalidated.
+class MultiBoardView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MultiBoardView(int boardCount = 64, QWidget *parent = nullptr);
+
+    void setEngineLimits(const SearchLimits &limits) { engineLimits = limits; }
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    struct BoardTile
+    {
+        Position position;
+        QRect rect;
+        QPixmap pixmap;              // A legutóbbi kirajzolt állapot
+        bool dirty = true;
+        uint32_t generation = 0;     // Új játszmánál nő, a késő motorválaszt eldobjuk
+        Move lastMove = NoMove;
+        QString result;              // Üres, amíg a játszma tart
+    };
+
+    void layoutTiles();
+    void renderTile(BoardTile &tile);
+    void requestMove(int index);
+    void onEngineMove(int index, uint32_t generation, Move move);
+    void restartGame(int index);
+
+    std::vector<BoardTile> tiles;
+    BoardRenderCache renderCache;
+    SearchLimits engineLimits;
+    std::mt19937 random;
+    EnginePool pool;   // Utolsó tag: elsőként áll le
+};
+
+#endif // MULTIBOARDVIEW_H
@@ -0,0 +1,205 @@
+#include "perft.h"
+#include "trace.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Lockless tábla: a kulcsot a darabszámmal XOR-olva tároljuk, így a félig
+// felülírt bejegyzés egyszerűen nem egyezik (Hyatt-féle megoldás)
+class PerftHash
+{
+public:
+    explicit PerftHash(int sizeMb)
+    {
+        size_t count = 1;
+        while (count * 2 * sizeof(Entry) <= size_t(sizeMb) * 1024 * 1024) count *= 2;
+        entries.reset(new Entry[count]);
+        mask = count - 1;
+    }
+
+    bool probe(uint64_t key, int depth, uint64_t &nodes) const
+    {
+        uint64_t mixed = mix(key, depth);
+        const Entry &entry = entries[mixed & mask];
+        uint64_t count = entry.count.load(std::memory_order_relaxed);
+        if ((entry.check.load(std::memory_order_relaxed) ^ count) != mixed) return false;
+        nodes = count;
+        return true;
+    }
+
+    void store(uint64_t key, int depth, uint64_t nodes)
+    {
+        uint64_t mixed = mix(key, depth);
+        Entry &entry = entries[mixed & mask];
+        entry.check.store(mixed ^ nodes, std::memory_order_relaxed);
+        entry.count.store(nodes, std::memory_order_relaxed);
+    }
+
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check { 0 };
+        std::atomic<uint64_t> count { 0 };
+    };
+
+    static uint64_t mix(uint64_t key, int depth) { return key ^ (uint64_t(depth) * 0x9E3779B97F4A7C15ull); }
+
+    std::unique_ptr<Entry[]> entries;
+    size_t mask = 0;
+};
+
+struct Task
+{
+    std::vector<Move> path;   // A gyökértől
+    int depth = 0;            // Hátralévő mélység a path végétől
+};
+
+struct WorkQueue
+{
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+uint64_t hashedPerft(Position &position, int depth, PerftHash *hash, uint64_t &hits)
+{
+    // Két ply-nál a tömeges számlálás olcsóbb, mint a táblaelérés; találatnál generálni sem kell
+    uint64_t nodes = 0;
+    if (depth < 3) hash = nullptr;
+    if (hash && hash->probe(position.key(), depth, nodes)) {
+        ++hits;
+        return nodes;
+    }
+
+    MoveList list;
+    position.generateLegal(list);
+    if (depth == 1) return uint64_t(list.count);   // Tömeges számlálás az utolsó szinten
+    for (int i = 0; i < list.count; ++i) {
+        position.makeMove(list.moves[i]);
+        nodes += hashedPerft(position, depth - 1, hash, hits);
+        position.unmakeMove();
+    }
+    if (hash) hash->store(position.key(), depth, nodes);
+    return nodes;
+}
+
+} // namespace
+
+uint64_t perft(Position &position, int depth)
+{
+    if (depth <= 0) return 1;
+    uint64_t hits = 0;
+    return hashedPerft(position, depth, nullptr, hits);
+}
+
+ParallelPerft::ParallelPerft(const Options &options) : options(options)
+{
+    threads = options.threads > 0 ? options.threads : int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+}
+
+ParallelPerft::Result ParallelPerft::run(const Position &root, int depth)
+{
+    Result result;
+    result.threads.resize(size_t(threads));
+    auto start = std::chrono::steady_clock::now();
+
+    Position position = root;
+    MoveList rootMoves;
+    position.generateLegal(rootMoves);
+    for (int i = 0; i < rootMoves.count; ++i) result.divide.push_back({ rootMoves.moves[i], 0 });
+    if (depth <= 1) {
+        for (auto &entry : result.divide) entry.second = depth == 1 ? 1 : 0;
+        result.nodes = depth <= 0 ? 1 : uint64_t(rootMoves.count);
+        return result;
+    }
+
+    // Felosztás: gyökérlépésenként, kis elágazásnál egy szinttel mélyebben is
+    std::vector<Task> tasks;
+    for (int i = 0; i < rootMoves.count; ++i) tasks.push_back({ { rootMoves.moves[i] }, depth - 1 });
+    while (int(tasks.size()) < threads * options.minTasksPerThread && !tasks.empty() && tasks.front().depth > 2) {
+        std::vector<Task> deeper;
+        for (const Task &task : tasks) {
+            Position child = root;
+            for (Move move : task.path) child.makeMove(move);
+            MoveList list;
+            child.generateLegal(list);
+            for (int i = 0; i < list.count; ++i) {
+                Task next { task.path, task.depth - 1 };
+                next.path.push_back(list.moves[i]);
+                deeper.push_back(std::move(next));
+            }
+        }
+        tasks.swap(deeper);
+    }
+    result.tasks = int(tasks.size());
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    for (int i = 0; i < threads; ++i) queues.emplace_back(new WorkQueue);
+    for (size_t i = 0; i < tasks.size(); ++i) queues[i % size_t(threads)]->tasks.push_back(std::move(tasks[i]));
+
+    std::unique_ptr<PerftHash> hash(options.hashSizeMb > 0 ? new PerftHash(options.hashSizeMb) : nullptr);
+    std::vector<std::atomic<uint64_t>> rootCounts(result.divide.size());
+    std::atomic<uint64_t> hashHits { 0 };
+
+    auto worker = [&](int index) {
+        if (Trace::enabled()) Trace::setThreadName("perft");
+        ThreadStats &stats = result.threads[size_t(index)];
+        auto workStart = std::chrono::steady_clock::now();
+        uint64_t hits = 0;
+
+        while (true) {
+            Task task;
+            bool found = false;
+            {
+                // Saját sor vége: a legutóbb kiosztott, a gyorsítótárban még meleg részfa
+                std::lock_guard<std::mutex> lock(queues[size_t(index)]->mutex);
+                if (!queues[size_t(index)]->tasks.empty()) {
+                    task = std::move(queues[size_t(index)]->tasks.back());
+                    queues[size_t(index)]->tasks.pop_back();
+                    found = true;
+                }
+            }
+            for (int offset = 1; !found && offset < threads; ++offset) {
+                WorkQueue &victim = *queues[size_t((index + offset) % threads)];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (victim.tasks.empty()) continue;
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                found = true;
+                ++stats.steals;
+            }
+            if (!found) break;   // Új feladat nem keletkezik, üres sorok után vége
+
+            Position child = root;
+            for (Move move : task.path) child.makeMove(move);
+            uint64_t nodes = task.depth > 0 ? hashedPerft(child, task.depth, hash.get(), hits) : 1;
+            for (size_t i = 0; i < result.divide.size(); ++i) {
+                if (result.divide[i].first == task.path.front()) {
+                    rootCounts[i].fetch_add(nodes, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            stats.nodes += nodes;
+            ++stats.tasks;
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - workStart).count();
+        hashHits.fetch_add(hits, std::memory_order_relaxed);
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; ++i) workers.emplace_back(worker, i);
+    for (auto &thread : workers) thread.join();
+
+    for (size_t i = 0; i < result.divide.size(); ++i) {
+        result.divide[i].second = rootCounts[i].load();
+        result.nodes += result.divide[i].second;
+    }
+    result.hashHits = hashHits.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,56 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "position.h"
+
+// Leaf node count of the legal move tree, the standard move generator check.
+uint64_t perft(Position &position, int depth);
+
+// Perft over several threads.
+// The tree is split at the root, and one ply deeper at a time while there are
+// fewer than minTasksPerThread subtrees per thread. Every thread starts with
+// its share of subtrees in its own deque, works from the back and steals from
+// the front of the others when it runs dry, so a few huge subtrees do not
+// leave the other threads idle. With hashSizeMb > 0 subtree counts are shared
+// through a lockless hash table (entry check = key ^ count).
+class ParallelPerft
+{
+public:
+    struct Options
+    {
+        int threads = 0;            // 0 = hardware threads
+        int hashSizeMb = 0;         // 0 = no hash
+        int minTasksPerThread = 8;
+    };
+
+    struct ThreadStats
+    {
+        uint64_t nodes = 0;
+        uint64_t tasks = 0;
+        uint64_t steals = 0;
+        double seconds = 0;         // Munkával töltött idő
+    };
+
+    struct Result
+    {
+        uint64_t nodes = 0;
+        double seconds = 0;
+        int tasks = 0;
+        uint64_t hashHits = 0;
+        std::vector<ThreadStats> threads;
+        std::vector<std::pair<Move, uint64_t>> divide;   // Gyökérlépésenként
+    };
+
+    explicit ParallelPerft(const Options &options);
+    Result run(const Position &root, int depth);
+    int threadCount() const { return threads; }
+
+private:
+    Options options;
+    int threads;
+};
+
+#endif // PERFT_H
@@ -0,0 +1,77 @@
+#include "perft.h"
+#include <QCoreApplication>
+#include <QTextStream>
+
+// Parallel perft as a move generator check and a throughput test.
+//
+//   chess_perft [--depth 6] [--threads n] [--hash mb] [--fen "<fen>"] [--divide] [--scaling]
+//
+// --scaling repeats the run with 1, 2, 4, ... up to --threads threads and
+// prints the speedup and the scaling efficiency (speedup / threads) against
+// the single-threaded run.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int depth = 6;
+    bool divide = false;
+    bool scaling = false;
+    QString fen;
+    ParallelPerft::Options options;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--depth" && i + 1 < args.size()) depth = args[++i].toInt();
+        else if (args[i] == "--threads" && i + 1 < args.size()) options.threads = args[++i].toInt();
+        else if (args[i] == "--hash" && i + 1 < args.size()) options.hashSizeMb = args[++i].toInt();
+        else if (args[i] == "--fen" && i + 1 < args.size()) fen = args[++i];
+        else if (args[i] == "--divide") divide = true;
+        else if (args[i] == "--scaling") scaling = true;
+    }
+
+    QTextStream out(stdout);
+    Position root;
+    if (fen.isEmpty()) root.setStartPosition();
+    else if (!root.setFen(fen.toStdString())) {
+        out << "Invalid FEN: " << fen << "\n";
+        return 1;
+    }
+
+    int maxThreads = ParallelPerft(options).threadCount();
+    QVector<int> threadCounts;
+    if (scaling) {
+        for (int n = 1; n < maxThreads; n *= 2) threadCounts.append(n);
+    }
+    threadCounts.append(maxThreads);
+
+    double singleSeconds = 0;
+    for (int threadCount : threadCounts) {
+        ParallelPerft::Options runOptions = options;
+        runOptions.threads = threadCount;
+        ParallelPerft::Result result = ParallelPerft(runOptions).run(root, depth);
+
+        if (divide && threadCount == threadCounts.last()) {
+            for (const auto &entry : result.divide)
+                out << QString::fromStdString(Position::moveToUci(entry.first)) << ": " << entry.second << "\n";
+        }
+
+        out << QString("perft(%1) = %2 in %3 s, %4 Mnps, %5 threads, %6 tasks, %7 hash hits\n")
+                   .arg(depth).arg(result.nodes).arg(result.seconds, 0, 'f', 3)
+                   .arg(result.seconds > 0 ? result.nodes / result.seconds / 1e6 : 0.0, 0, 'f', 1)
+                   .arg(threadCount).arg(result.tasks).arg(result.hashHits);
+        for (size_t i = 0; i < result.threads.size(); ++i) {
+            const ParallelPerft::ThreadStats &stats = result.threads[i];
+            out << QString("  thread %1: %2 nodes, %3 Mnps, %4 tasks, %5 stolen\n")
+                       .arg(i, 2).arg(stats.nodes, 14)
+                       .arg(stats.seconds > 0 ? stats.nodes / stats.seconds / 1e6 : 0.0, 7, 'f', 1)
+                       .arg(stats.tasks, 5).arg(stats.steals, 5);
+        }
+
+        if (threadCount == 1) singleSeconds = result.seconds;
+        if (singleSeconds > 0 && result.seconds > 0) {
+            double speedup = singleSeconds / result.seconds;
+            out << QString("  speedup %1x, efficiency %2%\n").arg(speedup, 0, 'f', 2).arg(100.0 * speedup / threadCount, 0, 'f', 1);
+        }
+        out.flush();
+    }
+    return 0;
+}
@@ -0,0 +1,799 @@
+#include "position.h"
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+const char pieceChars[] = "PNBRQKpnbrqk";
+const int knightOffsets[8][2] = { {2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2} };
+const int kingOffsets[8][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+const int rookDirections[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+const int bishopDirections[4][2] = { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} };
+
+// Előre kiszámolt táblák, hogy a generálás ne ellenőrizze újra a táblahatárokat
+struct Tables
+{
+    int knightTargets[64][8];
+    int knightCount[64];
+    int kingTargets[64][8];
+    int kingCount[64];
+    int rays[64][8][7];      // 0-3: rook directions, 4-7: bishop directions
+    int rayLength[64][8];
+    int castlingMask[64];
+    uint64_t pieceKeys[128][64];        // Indexed directly by the piece character
+    uint64_t castlingKeys[16];
+    uint64_t enPassantKeys[8];
+    uint64_t sideKey;
+
+    Tables()
+    {
+        for (int square = 0; square < 64; ++square) {
+            int row = square / 8, col = square % 8;
+            knightCount[square] = kingCount[square] = 0;
+            for (int i = 0; i < 8; ++i) {
+                int r = row + knightOffsets[i][0], c = col + knightOffsets[i][1];
+                if (r >= 0 && r < 8 && c >= 0 && c < 8) knightTargets[square][knightCount[square]++] = r * 8 + c;
+                r = row + kingOffsets[i][0];
+                c = col + kingOffsets[i][1];
+                if (r >= 0 && r < 8 && c >= 0 && c < 8) kingTargets[square][kingCount[square]++] = r * 8 + c;
+            }
+            for (int dir = 0; dir < 8; ++dir) {
+                const int *d = dir < 4 ? rookDirections[dir] : bishopDirections[dir - 4];
+                int r = row + d[0], c = col + d[1], length = 0;
+                while (r >= 0 && r < 8 && c >= 0 && c < 8) {
+                    rays[square][dir][length++] = r * 8 + c;
+                    r += d[0];
+                    c += d[1];
+                }
+                rayLength[square][dir] = length;
+            }
+            castlingMask[square] = 15;
+        }
+        castlingMask[60] &= ~(WhiteKingSide | WhiteQueenSide);
+        castlingMask[63] &= ~WhiteKingSide;
+        castlingMask[56] &= ~WhiteQueenSide;
+        castlingMask[4] &= ~(BlackKingSide | BlackQueenSide);
+        castlingMask[7] &= ~BlackKingSide;
+        castlingMask[0] &= ~BlackQueenSide;
+
+        // Rögzített mag, hogy a kulcsok futásról futásra azonosak legyenek (lemezes cache miatt)
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+        auto next = [&seed]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            return seed;
+        };
+        for (auto &piece : pieceKeys)
+            for (uint64_t &key : piece) key = 0;
+        for (int i = 0; i < 12; ++i)
+            for (uint64_t &key : pieceKeys[int(pieceChars[i])]) key = next();
+        for (uint64_t &key : castlingKeys) key = next();
+        for (uint64_t &key : enPassantKeys) key = next();
+        sideKey = next();
+    }
+};
+
+const Tables &tables()
+{
+    static const Tables instance;
+    return instance;
+}
+
+inline bool isWhitePiece(char piece) { return piece >= 'A' && piece <= 'Z'; }
+inline bool isBlackPiece(char piece) { return piece >= 'a' && piece <= 'z'; }
+inline char toLowerPiece(char piece) { return isWhitePiece(piece) ? char(piece + ('a' - 'A')) : piece; }
+
+inline bool isValidPiece(char piece)
+{
+    for (int i = 0; i < 12; ++i) {
+        if (pieceChars[i] == piece) return true;
+    }
+    return false;
+}
+
+int seeValue(char piece)
+{
+    switch (toLowerPiece(piece)) {
+    case 'p': return 100;
+    case 'n': return 320;
+    case 'b': return 330;
+    case 'r': return 500;
+    case 'q': return 900;
+    case 'k': return 20000;
+    }
+    return 0;
+}
+
+// A lépő fél szerinti állandók, hogy a generálás belső ciklusaiban ne kelljen elágazni
+template <bool White>
+struct Side
+{
+    static constexpr char Pawn = White ? 'P' : 'p';
+    static constexpr char Knight = White ? 'N' : 'n';
+    static constexpr char Bishop = White ? 'B' : 'b';
+    static constexpr char Rook = White ? 'R' : 'r';
+    static constexpr char Queen = White ? 'Q' : 'q';
+    static constexpr char King = White ? 'K' : 'k';
+    static constexpr int Forward = White ? -8 : 8;       // A 0. sor a 8. sor
+    static constexpr int StartRow = White ? 6 : 1;
+    static constexpr int LastRow = White ? 0 : 7;
+    static constexpr int KingHome = White ? 60 : 4;
+    static constexpr int KingSide = White ? WhiteKingSide : BlackKingSide;
+    static constexpr int QueenSide = White ? WhiteQueenSide : BlackQueenSide;
+
+    static bool isEnemy(char piece) { return White ? isBlackPiece(piece) : isWhitePiece(piece); }
+};
+
+// A generateMoves Kinds paramétere
+const int GenCaptures = 1;   // Ütések és vezérré alakulás
+const int GenQuiets = 2;     // Csendes lépések, sánc és gyengébb átalakulások
+const int GenAll = GenCaptures | GenQuiets;
+
+char promotionPiece(int promotion, bool white)
+{
+    static const char pieces[] = " nbrq";
+    char piece = pieces[promotion];
+    return white ? char(piece - ('a' - 'A')) : piece;
+}
+
+} // namespace
+
+bool MoveList::contains(Move move) const
+{
+    for (int i = 0; i < count; ++i) {
+        if (moves[i] == move) return true;
+    }
+    return false;
+}
+
+Position::Position()
+{
+    setStartPosition();
+}
+
+void Position::clear()
+{
+    for (char &square : squares) square = ' ';
+    isWhiteTurn = true;
+    castling = 0;
+    enPassant = -1;
+    halfmoves = 0;
+    fullmoves = 1;
+    kings[0] = kings[1] = -1;
+    hashKey = 0;
+    eval.clear();
+    states.clear();
+    attackMap.clear();
+}
+
+void Position::setAttackTracking(bool enabled)
+{
+    trackingAttacks = enabled;
+    attackMap.clear();
+    if (!enabled) return;
+    for (int square = 0; square < 64; ++square) {
+        if (squares[square] != ' ') attackMap.set(square, squares[square]);
+    }
+}
+
+void Position::setStartPosition()
+{
+    setFen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+}
+
+bool Position::setFen(const std::string &fen)
+{
+    clear();
+    const Tables &t = tables();
+    std::istringstream stream(fen);
+    std::string placement, side, rights, ep;
+    stream >> placement >> side >> rights >> ep;
+
+    int row = 0, col = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            ++row;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+        } else {
+            if (!isValidPiece(c) || row > 7 || col > 7) return false;
+            putPiece(c, row * 8 + col);
+            ++col;
+        }
+    }
+    if (kings[0] < 0 || kings[1] < 0) return false;
+
+    isWhiteTurn = side != "b";
+    if (!isWhiteTurn) hashKey ^= t.sideKey;
+
+    for (char c : rights) {
+        if (c == 'K') castling |= WhiteKingSide;
+        else if (c == 'Q') castling |= WhiteQueenSide;
+        else if (c == 'k') castling |= BlackKingSide;
+        else if (c == 'q') castling |= BlackQueenSide;
+    }
+    hashKey ^= t.castlingKeys[castling];
+
+    if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && ep[1] >= '1' && ep[1] <= '8') {
+        enPassant = (8 - (ep[1] - '0')) * 8 + (ep[0] - 'a');
+        hashKey ^= t.enPassantKeys[enPassant % 8];
+    }
+
+    if (!(stream >> halfmoves)) halfmoves = 0;
+    if (!(stream >> fullmoves)) fullmoves = 1;
+    return true;
+}
+
+std::string Position::fen() const
+{
+    std::string result;
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            char piece = squares[row * 8 + col];
+            if (piece == ' ') {
+                ++empty;
+                continue;
+            }
+            if (empty) result += char('0' + empty);
+            empty = 0;
+            result += piece;
+        }
+        if (empty) result += char('0' + empty);
+        if (row < 7) result += '/';
+    }
+
+    result += isWhiteTurn ? " w " : " b ";
+    if (castling & WhiteKingSide) result += 'K';
+    if (castling & WhiteQueenSide) result += 'Q';
+    if (castling & BlackKingSide) result += 'k';
+    if (castling & BlackQueenSide) result += 'q';
+    if (!castling) result += '-';
+
+    if (enPassant >= 0) {
+        result += ' ';
+        result += char('a' + enPassant % 8);
+        result += char('0' + 8 - enPassant / 8);
+    } else {
+        result += " -";
+    }
+    result += ' ' + std::to_string(halfmoves) + ' ' + std::to_string(fullmoves);
+    return result;
+}
+
+void Position::putPiece(char piece, int square)
+{
+    squares[square] = piece;
+    eval.addPiece(piece, square / 8, square % 8);
+    hashKey ^= tables().pieceKeys[piece & 127][square];
+    if (piece == 'K') kings[0] = square;
+    else if (piece == 'k') kings[1] = square;
+    if (trackingAttacks) attackMap.set(square, piece);
+}
+
+void Position::removePiece(int square)
+{
+    char piece = squares[square];
+    squares[square] = ' ';
+    eval.removePiece(piece, square / 8, square % 8);
+    hashKey ^= tables().pieceKeys[piece & 127][square];
+    if (trackingAttacks) attackMap.set(square, ' ');
+}
+
+bool Position::isCapture(Move move) const
+{
+    int to = moveTo(move);
+    if (squares[to] != ' ') return true;
+    char piece = squares[moveFrom(move)];
+    return to == enPassant && (piece == 'P' || piece == 'p');
+}
+
+bool Position::isTactical(Move move) const
+{
+    return isCapture(move) || movePromotion(move) == PromoteQueen;
+}
+
+char Position::capturedPiece(Move move) const
+{
+    int to = moveTo(move);
+    if (squares[to] != ' ') return squares[to];
+    char piece = squares[moveFrom(move)];
+    if (to == enPassant && piece == 'P') return 'p';
+    if (to == enPassant && piece == 'p') return 'P';
+    return ' ';
+}
+
+template <bool ByWhite>
+bool Position::attackedBy(int square) const
+{
+    if (trackingAttacks) return attackMap.isAttacked(square, ByWhite);
+
+    typedef Side<ByWhite> S;
+    const Tables &t = tables();
+    int col = square % 8;
+
+    // Gyalogtámadások: a fehér gyalog alulról, a fekete felülről támad
+    int pawnSquare = square - S::Forward;
+    if (pawnSquare >= 0 && pawnSquare < 64) {
+        if (col > 0 && squares[pawnSquare - 1] == S::Pawn) return true;
+        if (col < 7 && squares[pawnSquare + 1] == S::Pawn) return true;
+    }
+
+    for (int i = 0; i < t.knightCount[square]; ++i) {
+        if (squares[t.knightTargets[square][i]] == S::Knight) return true;
+    }
+    for (int i = 0; i < t.kingCount[square]; ++i) {
+        if (squares[t.kingTargets[square][i]] == S::King) return true;
+    }
+
+    for (int dir = 0; dir < 8; ++dir) {
+        char slider = dir < 4 ? S::Rook : S::Bishop;
+        for (int i = 0; i < t.rayLength[square][dir]; ++i) {
+            char piece = squares[t.rays[square][dir][i]];
+            if (piece == ' ') continue;
+            if (piece == slider || piece == S::Queen) return true;
+            break;
+        }
+    }
+    return false;
+}
+
+bool Position::isSquareAttacked(int square, bool byWhite) const
+{
+    return byWhite ? attackedBy<true>(square) : attackedBy<false>(square);
+}
+
+template <bool White, int Kinds>
+void Position::addPawnMoves(int from, MoveList &captures, MoveList &quiets) const
+{
+    typedef Side<White> S;
+    int row = from / 8, col = from % 8;
+    int nextRow = row + S::Forward / 8;
+    if (nextRow < 0 || nextRow > 7) return;
+    bool promotes = nextRow == S::LastRow;
+
+    auto addMove = [&](int to, bool capture) {
+        if (promotes) {
+            if (Kinds & GenCaptures) captures.add(createMove(from, to, PromoteQueen));
+            if (Kinds & GenQuiets) {
+                quiets.add(createMove(from, to, PromoteRook));
+                quiets.add(createMove(from, to, PromoteBishop));
+                quiets.add(createMove(from, to, PromoteKnight));
+            }
+        } else if (capture) {
+            if (Kinds & GenCaptures) captures.add(createMove(from, to));
+        } else if (Kinds & GenQuiets) {
+            quiets.add(createMove(from, to));
+        }
+    };
+
+    int forward = from + S::Forward;
+    if (squares[forward] == ' ') {
+        // A vezérré alakulás taktikai lépés, akkor is generáljuk, ha csak ütéseket kérünk
+        addMove(forward, false);
+        if ((Kinds & GenQuiets) && row == S::StartRow && squares[forward + S::Forward] == ' ') {
+            quiets.add(createMove(from, forward + S::Forward));
+        }
+    }
+
+    if (col > 0 && (S::isEnemy(squares[forward - 1]) || forward - 1 == enPassant)) addMove(forward - 1, true);
+    if (col < 7 && (S::isEnemy(squares[forward + 1]) || forward + 1 == enPassant)) addMove(forward + 1, true);
+}
+
+template <bool White, int Kinds, char Type>
+void Position::addLeaperMoves(int from, MoveList &captures, MoveList &quiets) const
+{
+    typedef Side<White> S;
+    const Tables &t = tables();
+    const int *targets = Type == 'n' ? t.knightTargets[from] : t.kingTargets[from];
+    int count = Type == 'n' ? t.knightCount[from] : t.kingCount[from];
+    for (int i = 0; i < count; ++i) {
+        int to = targets[i];
+        if (squares[to] == ' ') {
+            if (Kinds & GenQuiets) quiets.add(createMove(from, to));
+        } else if ((Kinds & GenCaptures) && S::isEnemy(squares[to])) {
+            captures.add(createMove(from, to));
+        }
+    }
+
+    // Sánc: a király és a bástya nem mozdult, az útvonal üres és nincs támadva
+    if (Type == 'k' && (Kinds & GenQuiets) && from == S::KingHome && !attackedBy<!White>(from)) {
+        const int home = S::KingHome;
+        if ((castling & S::KingSide) && squares[home + 1] == ' ' && squares[home + 2] == ' ' &&
+            !attackedBy<!White>(home + 1) && !attackedBy<!White>(home + 2)) {
+            quiets.add(createMove(home, home + 2));
+        }
+        if ((castling & S::QueenSide) && squares[home - 1] == ' ' && squares[home - 2] == ' ' && squares[home - 3] == ' ' &&
+            !attackedBy<!White>(home - 1) && !attackedBy<!White>(home - 2)) {
+            quiets.add(createMove(home, home - 2));
+        }
+    }
+}
+
+template <bool White, int Kinds, char Type>
+void Position::addSliderMoves(int from, MoveList &captures, MoveList &quiets) const
+{
+    typedef Side<White> S;
+    const Tables &t = tables();
+    const int firstDir = Type == 'b' ? 4 : 0;
+    const int lastDir = Type == 'r' ? 4 : 8;
+    for (int dir = firstDir; dir < lastDir; ++dir) {
+        const int *ray = t.rays[from][dir];
+        for (int i = 0; i < t.rayLength[from][dir]; ++i) {
+            int to = ray[i];
+            if (squares[to] == ' ') {
+                if (Kinds & GenQuiets) quiets.add(createMove(from, to));
+                continue;
+            }
+            if ((Kinds & GenCaptures) && S::isEnemy(squares[to])) captures.add(createMove(from, to));
+            break;
+        }
+    }
+}
+
+template <bool White, int Kinds>
+void Position::generatePieceMoves(int from, MoveList &captures, MoveList &quiets) const
+{
+    typedef Side<White> S;
+    // Az ellenfél bábuja és az üres mező egyik ágra sem illeszkedik
+    switch (squares[from]) {
+    case S::Pawn: addPawnMoves<White, Kinds>(from, captures, quiets); break;
+    case S::Knight: addLeaperMoves<White, Kinds, 'n'>(from, captures, quiets); break;
+    case S::Bishop: addSliderMoves<White, Kinds, 'b'>(from, captures, quiets); break;
+    case S::Rook: addSliderMoves<White, Kinds, 'r'>(from, captures, quiets); break;
+    case S::Queen: addSliderMoves<White, Kinds, 'q'>(from, captures, quiets); break;
+    case S::King: addLeaperMoves<White, Kinds, 'k'>(from, captures, quiets); break;
+    }
+}
+
+template <bool White, int Kinds>
+void Position::generateMoves(MoveList &captures, MoveList &quiets) const
+{
+    for (int square = 0; square < 64; ++square) generatePieceMoves<White, Kinds>(square, captures, quiets);
+}
+
+void Position::generateCaptures(MoveList &list) const
+{
+    // Állásonként egyetlen futásidejű elágazás a lépő fél szerint
+    if (isWhiteTurn) generateMoves<true, GenCaptures>(list, list);
+    else generateMoves<false, GenCaptures>(list, list);
+}
+
+void Position::generateQuiets(MoveList &list) const
+{
+    if (isWhiteTurn) generateMoves<true, GenQuiets>(list, list);
+    else generateMoves<false, GenQuiets>(list, list);
+}
+
+void Position::generatePieceMoves(int from, MoveList &list) const
+{
+    if (isWhiteTurn) generatePieceMoves<true, GenAll>(from, list, list);
+    else generatePieceMoves<false, GenAll>(from, list, list);
+}
+
+void Position::generateLegal(MoveList &list)
+{
+    // Egy menetben mindkét fajta, a sorrend ugyanaz marad: előbb az ütések
+    MoveList captures, quiets;
+    if (isWhiteTurn) generateMoves<true, GenAll>(captures, quiets);
+    else generateMoves<false, GenAll>(captures, quiets);
+
+    list.count = 0;
+    for (const MoveList *pseudo : { &captures, &quiets }) {
+        for (int i = 0; i < pseudo->count; ++i) {
+            if (makeMove(pseudo->moves[i])) {
+                unmakeMove();
+                list.add(pseudo->moves[i]);
+            }
+        }
+    }
+}
+
+bool Position::isPseudoLegal(Move move) const
+{
+    if (move == NoMove) return false;
+    int from = moveFrom(move);
+    char piece = squares[from];
+    if (piece == ' ' || isWhitePiece(piece) != isWhiteTurn) return false;
+
+    // Csak a kérdéses bábu lépéseit generáljuk újra
+    MoveList captures, quiets;
+    if (isWhiteTurn) generatePieceMoves<true, GenAll>(from, captures, quiets);
+    else generatePieceMoves<false, GenAll>(from, captures, quiets);
+    return captures.contains(move) || quiets.contains(move);
+}
+
+bool Position::makeMove(Move move)
+{
+    const Tables &t = tables();
+    int from = moveFrom(move);
+    int to = moveTo(move);
+    int promotion = movePromotion(move);
+    char piece = squares[from];
+    bool white = isWhiteTurn;
+
+    StateInfo state;
+    state.key = hashKey;
+    state.move = move;
+    state.captured = ' ';
+    state.capturedSquare = -1;
+    state.enPassant = int8_t(enPassant);
+    state.castling = uint8_t(castling);
+    state.halfmoves = halfmoves;
+
+    hashKey ^= t.sideKey;
+    if (enPassant >= 0) hashKey ^= t.enPassantKeys[enPassant % 8];
+
+    bool pawnMove = piece == 'P' || piece == 'p';
+    int captureSquare = to;
+    if (pawnMove && to == enPassant) captureSquare = to + (white ? 8 : -8);
+    if (squares[captureSquare] != ' ') {
+        state.captured = squares[captureSquare];
+        state.capturedSquare = int8_t(captureSquare);
+        removePiece(captureSquare);
+    }
+
+    removePiece(from);
+    putPiece(promotion ? promotionPiece(promotion, white) : piece, to);
+
+    // Sánc esetén a bástyát is áthelyezzük
+    if ((piece == 'K' || piece == 'k') && (to - from == 2 || from - to == 2)) {
+        int rookFrom = to > from ? from + 3 : from - 4;
+        int rookTo = to > from ? from + 1 : from - 1;
+        char rook = squares[rookFrom];
+        removePiece(rookFrom);
+        putPiece(rook, rookTo);
+    }
+
+    hashKey ^= t.castlingKeys[castling];
+    castling &= t.castlingMask[from] & t.castlingMask[to];
+    hashKey ^= t.castlingKeys[castling];
+
+    enPassant = -1;
+    if (pawnMove && (to - from == 16 || from - to == 16)) {
+        enPassant = (from + to) / 2;
+        hashKey ^= t.enPassantKeys[enPassant % 8];
+    }
+
+    halfmoves = (pawnMove || state.captured != ' ') ? 0 : halfmoves + 1;
+    if (!white) ++fullmoves;
+    isWhiteTurn = !white;
+    states.push_back(state);
+
+    if (isSquareAttacked(kings[white ? 0 : 1], !white)) {
+        unmakeMove();
+        return false;
+    }
+    return true;
+}
+
+void Position::unmakeMove()
+{
+    StateInfo state = states.back();
+    states.pop_back();
+
+    isWhiteTurn = !isWhiteTurn;
+    bool white = isWhiteTurn;
+    if (!white) --fullmoves;
+
+    int from = moveFrom(state.move);
+    int to = moveTo(state.move);
+    char piece = squares[to];
+    if (movePromotion(state.move)) piece = white ? 'P' : 'p';
+
+    if ((piece == 'K' || piece == 'k') && (to - from == 2 || from - to == 2)) {
+        int rookFrom = to > from ? from + 3 : from - 4;
+        int rookTo = to > from ? from + 1 : from - 1;
+        char rook = squares[rookTo];
+        removePiece(rookTo);
+        putPiece(rook, rookFrom);
+    }
+
+    removePiece(to);
+    putPiece(piece, from);
+    if (state.captured != ' ') putPiece(state.captured, state.capturedSquare);
+
+    castling = state.castling;
+    enPassant = state.enPassant;
+    halfmoves = state.halfmoves;
+    hashKey = state.key;
+}
+
+bool Position::isRepetition() const
+{
+    int size = int(states.size());
+    for (int i = size - 2; i >= 0 && i >= size - halfmoves; i -= 2) {
+        if (states[i].key == hashKey) return true;
+    }
+    return false;
+}
+
+int Position::repetitionCount() const
+{
+    int count = 0;
+    int size = int(states.size());
+    for (int i = size - 2; i >= 0 && i >= size - halfmoves; i -= 2) {
+        if (states[i].key == hashKey) ++count;
+    }
+    return count;
+}
+
+GameOutcome Position::outcome()
+{
+    MoveList list;
+    generateLegal(list);
+    if (list.count == 0) return inCheck() ? GameOutcome::Checkmate : GameOutcome::Stalemate;
+    if (halfmoves >= 100) return GameOutcome::FiftyMoves;
+    if (repetitionCount() >= 2) return GameOutcome::Repetition;
+    if (eval.isInsufficientMaterial()) return GameOutcome::InsufficientMaterial;
+    return GameOutcome::Ongoing;
+}
+
+int Position::leastValuableAttacker(int square, bool byWhite, uint64_t occupied) const
+{
+    const Tables &t = tables();
+    auto present = [&](int sq, char piece) { return squares[sq] == piece && (occupied >> sq & 1); };
+
+    int row = square / 8, col = square % 8;
+    char pawn = byWhite ? 'P' : 'p';
+    int pawnRow = byWhite ? row + 1 : row - 1;
+    if (pawnRow >= 0 && pawnRow < 8) {
+        if (col > 0 && present(pawnRow * 8 + col - 1, pawn)) return pawnRow * 8 + col - 1;
+        if (col < 7 && present(pawnRow * 8 + col + 1, pawn)) return pawnRow * 8 + col + 1;
+    }
+
+    char knight = byWhite ? 'N' : 'n';
+    for (int i = 0; i < t.knightCount[square]; ++i) {
+        if (present(t.knightTargets[square][i], knight)) return t.knightTargets[square][i];
+    }
+
+    // A sugarak első, még le nem vett bábuja; az x-ray támadók így automatikusan előkerülnek
+    int blockers[8];
+    for (int dir = 0; dir < 8; ++dir) {
+        blockers[dir] = -1;
+        for (int i = 0; i < t.rayLength[square][dir]; ++i) {
+            int sq = t.rays[square][dir][i];
+            if (occupied >> sq & 1) {
+                blockers[dir] = sq;
+                break;
+            }
+        }
+    }
+
+    char bishop = byWhite ? 'B' : 'b';
+    for (int dir = 4; dir < 8; ++dir) {
+        if (blockers[dir] >= 0 && squares[blockers[dir]] == bishop) return blockers[dir];
+    }
+    char rook = byWhite ? 'R' : 'r';
+    for (int dir = 0; dir < 4; ++dir) {
+        if (blockers[dir] >= 0 && squares[blockers[dir]] == rook) return blockers[dir];
+    }
+    char queen = byWhite ? 'Q' : 'q';
+    for (int dir = 0; dir < 8; ++dir) {
+        if (blockers[dir] >= 0 && squares[blockers[dir]] == queen) return blockers[dir];
+    }
+
+    char king = byWhite ? 'K' : 'k';
+    for (int i = 0; i < t.kingCount[square]; ++i) {
+        if (present(t.kingTargets[square][i], king)) return t.kingTargets[square][i];
+    }
+    return -1;
+}
+
+int Position::see(Move move) const
+{
+    int from = moveFrom(move);
+    int to = moveTo(move);
+
+    uint64_t occupied = 0;
+    for (int square = 0; square < 64; ++square) {
+        if (squares[square] != ' ') occupied |= 1ULL << square;
+    }
+
+    char attacker = squares[from];
+    int gain[32];
+    int depth = 0;
+    gain[0] = seeValue(capturedPiece(move));
+    if ((attacker == 'P' || attacker == 'p') && to == enPassant) {
+        occupied &= ~(1ULL << (to + (isWhitePiece(attacker) ? 8 : -8)));
+    }
+
+    bool sideWhite = !isWhitePiece(attacker);
+    int attackerValue = seeValue(attacker);
+    occupied &= ~(1ULL << from);
+
+    while (depth < 31) {
+        ++depth;
+        gain[depth] = attackerValue - gain[depth - 1];
+        if ((-gain[depth - 1] > gain[depth] ? -gain[depth - 1] : gain[depth]) < 0) break;
+        int square = leastValuableAttacker(to, sideWhite, occupied);
+        if (square < 0) break;
+        occupied &= ~(1ULL << square);
+        attackerValue = seeValue(squares[square]);
+        sideWhite = !sideWhite;
+    }
+    while (--depth) {
+        gain[depth - 1] = -(-gain[depth - 1] > gain[depth] ? -gain[depth - 1] : gain[depth]);
+    }
+    return gain[0];
+}
+
+Move Position::parseUciMove(const std::string &uci)
+{
+    MoveList legal;
+    generateLegal(legal);
+    for (int i = 0; i < legal.count; ++i) {
+        if (moveToUci(legal.moves[i]) == uci) return legal.moves[i];
+    }
+    return NoMove;
+}
+
+std::string Position::moveToSan(Move move)
+{
+    int from = moveFrom(move), to = moveTo(move);
+    char piece = squares[from];
+    char type = char(std::toupper(static_cast<unsigned char>(piece)));
+    std::string san;
+
+    if (type == 'K' && (to - from == 2 || from - to == 2)) {
+        san = to > from ? "O-O" : "O-O-O";
+    } else {
+        bool capture = isCapture(move);
+        if (type == 'P') {
+            if (capture) san += char('a' + from % 8);
+        } else {
+            san += type;
+            // Ugyanarra a mezőre lépő azonos bábuk: előbb oszlop, aztán sor, végül mindkettő
+            MoveList legal;
+            generateLegal(legal);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (int i = 0; i < legal.count; ++i) {
+                int other = moveFrom(legal.moves[i]);
+                if (other == from || moveTo(legal.moves[i]) != to || squares[other] != piece) continue;
+                ambiguous = true;
+                sameFile = sameFile || other % 8 == from % 8;
+                sameRank = sameRank || other / 8 == from / 8;
+            }
+            if (ambiguous) {
+                if (!sameFile) san += char('a' + from % 8);
+                else if (!sameRank) san += char('0' + 8 - from / 8);
+                else {
+                    san += char('a' + from % 8);
+                    san += char('0' + 8 - from / 8);
+                }
+            }
+        }
+        if (capture) san += 'x';
+        san += char('a' + to % 8);
+        san += char('0' + 8 - to / 8);
+        if (movePromotion(move)) {
+            san += '=';
+            san += " NBRQ"[movePromotion(move)];
+        }
+    }
+
+    if (makeMove(move)) {
+        if (inCheck()) {
+            MoveList replies;
+            generateLegal(replies);
+            san += replies.count == 0 ? '#' : '+';
+        }
+        unmakeMove();
+    }
+    return san;
+}
+
+std::string Position::moveToUci(Move move)
+{
+    if (move == NoMove) return "0000";
+    int from = moveFrom(move), to = moveTo(move);
+    std::string result;
+    result += char('a' + from % 8);
+    result += char('0' + 8 - from / 8);
+    result += char('a' + to % 8);
+    result += char('0' + 8 - to / 8);
+    if (movePromotion(move)) result += " nbrq"[movePromotion(move)];
+    return result;
+}
@@ -0,0 +1,133 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "evaluation.h"
+#include "attackmap.h"
+
+// Compact board used by the in-process search.
+// Squares are numbered row * 8 + col with row 0 being the 8th rank, the same
+// layout as Widget::board, and pieces use the same characters ('P', 'n', ' ').
+
+typedef uint16_t Move;   // from | to << 6 | promotion << 12
+const Move NoMove = 0;
+
+enum Promotion { NoPromotion = 0, PromoteKnight = 1, PromoteBishop = 2, PromoteRook = 3, PromoteQueen = 4 };
+
+inline Move createMove(int from, int to, int promotion = NoPromotion) { return Move(from | (to << 6) | (promotion << 12)); }
+inline int moveFrom(Move move) { return move & 63; }
+inline int moveTo(Move move) { return (move >> 6) & 63; }
+inline int movePromotion(Move move) { return move >> 12; }
+
+struct MoveList
+{
+    Move moves[256];
+    int count = 0;
+
+    void add(Move move) { moves[count++] = move; }
+    bool contains(Move move) const;
+};
+
+enum CastlingRight { WhiteKingSide = 1, WhiteQueenSide = 2, BlackKingSide = 4, BlackQueenSide = 8 };
+
+enum class GameOutcome { Ongoing, Checkmate, Stalemate, FiftyMoves, Repetition, InsufficientMaterial };
+
+class Position
+{
+public:
+    Position();
+
+    void setStartPosition();
+    bool setFen(const std::string &fen);
+    std::string fen() const;
+
+    char pieceAt(int square) const { return squares[square]; }
+    bool whiteToMove() const { return isWhiteTurn; }
+    uint64_t key() const { return hashKey; }
+    int halfmoveClock() const { return halfmoves; }
+    int castlingRights() const { return castling; }
+    int enPassantSquare() const { return enPassant; }
+    int kingSquare(bool white) const { return kings[white ? 0 : 1]; }
+    const Evaluation &evaluation() const { return eval; }
+
+    // Bekapcsolva a make/unmake egy AttackMap-et is frissít, és a sakk-, sánc-
+    // és legalitásvizsgálat abból olvas bitet sugárjárás helyett. A keresés
+    // kikapcsolva hagyja: ott a lépésenkénti frissítés drágább, mint a néhány
+    // célzott vizsgálat.
+    void setAttackTracking(bool enabled);
+    bool attackTracking() const { return trackingAttacks; }
+    const AttackMap &attacks() const { return attackMap; }
+
+    // Pseudo-legal generation. Captures also contain queen promotions, quiets
+    // contain castling and under-promotions, so the two lists never overlap.
+    void generateCaptures(MoveList &list) const;
+    void generateQuiets(MoveList &list) const;
+    void generateLegal(MoveList &list);
+    void generatePieceMoves(int from, MoveList &list) const;   // Pseudo-legal moves of one piece of the side to move
+    bool isPseudoLegal(Move move) const;
+
+    // Returns false and leaves the position untouched if the move would leave
+    // the mover's king in check.
+    bool makeMove(Move move);
+    void unmakeMove();
+    int ply() const { return int(states.size()); }
+    Move historyMove(int index) const { return states[size_t(index)].move; }   // Az index-edik megtett lépés
+
+    bool isCapture(Move move) const;
+    bool isTactical(Move move) const;
+    char capturedPiece(Move move) const;
+    bool isSquareAttacked(int square, bool byWhite) const;
+    bool inCheck() const { return isSquareAttacked(kings[isWhiteTurn ? 0 : 1], !isWhiteTurn); }
+    bool isRepetition() const;
+    int repetitionCount() const;   // Earlier occurrences of the current position
+    GameOutcome outcome();         // Result by the rules for the side to move
+    int see(Move move) const;
+
+    Move parseUciMove(const std::string &uci);
+    static std::string moveToUci(Move move);
+    // Standard algebraic notation of a legal move, with the minimal
+    // disambiguation and the check/mate suffix
+    std::string moveToSan(Move move);
+
+private:
+    struct StateInfo
+    {
+        uint64_t key;
+        Move move;
+        char captured;
+        int8_t capturedSquare;
+        int8_t enPassant;
+        uint8_t castling;
+        int halfmoves;
+    };
+
+    void clear();
+    void putPiece(char piece, int square);
+    void removePiece(int square);
+    // Színre és bábufajtára specializált generálás: a lépő fél szerint állásonként,
+    // a bábu szerint mezőnként egyszer ágazunk el (position.cpp)
+    template <bool White, int Kinds> void generateMoves(MoveList &captures, MoveList &quiets) const;
+    template <bool White, int Kinds> void generatePieceMoves(int from, MoveList &captures, MoveList &quiets) const;
+    template <bool White, int Kinds> void addPawnMoves(int from, MoveList &captures, MoveList &quiets) const;
+    template <bool White, int Kinds, char Type> void addLeaperMoves(int from, MoveList &captures, MoveList &quiets) const;
+    template <bool White, int Kinds, char Type> void addSliderMoves(int from, MoveList &captures, MoveList &quiets) const;
+    template <bool ByWhite> bool attackedBy(int square) const;
+    int leastValuableAttacker(int square, bool byWhite, uint64_t occupied) const;
+
+    char squares[64];
+    bool isWhiteTurn = true;
+    int castling = 0;
+    int enPassant = -1;
+    int halfmoves = 0;
+    int fullmoves = 1;
+    int kings[2] = { -1, -1 };
+    uint64_t hashKey = 0;
+    Evaluation eval;
+    std::vector<StateInfo> states;
+    bool trackingAttacks = false;
+    AttackMap attackMap;
+};
+
+#endif // POSITION_H
@@ -0,0 +1,258 @@
+#include "puzzleminer.h"
+#include "search.h"
+#include "analysiscache.h"
+#include "trace.h"
+#include "logger.h"
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+int resolveThreads(int threads)
+{
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    return threads > 0 ? threads : 1;
+}
+
+} // namespace
+
+PuzzleMiner::PuzzleMiner(const Options &options)
+    : options(options)
+    , scanQueue(size_t(resolveThreads(options.threads)) * 2)
+    , verifyQueue(size_t(resolveThreads(options.threads)) * 4)
+    , writeQueue(256)
+{
+    int threads = resolveThreads(options.threads);
+    for (int i = 0; i < threads; ++i) searches.emplace_back(new Search(options.hashSizeMb));
+}
+
+PuzzleMiner::~PuzzleMiner() = default;
+
+bool PuzzleMiner::parseGame(const std::string &line, std::string &startFen, std::vector<Move> &moves)
+{
+    std::istringstream tokens(line);
+    std::string token;
+    std::vector<std::string> words;
+    while (tokens >> token) words.push_back(token);
+    if (words.empty() || words[0][0] == '#') return false;
+
+    size_t i = 0;
+    startFen.clear();
+    if (words[0] == "position") {
+        if (words.size() > 1 && words[1] == "fen") {
+            // A FEN hat mezője a "moves" kulcsszóig tart
+            for (i = 2; i < words.size() && words[i] != "moves"; ++i) startFen += (startFen.empty() ? "" : " ") + words[i];
+        } else {
+            i = 2;
+        }
+        if (i < words.size() && words[i] == "moves") ++i;
+    }
+
+    Position position;
+    if (startFen.empty()) position.setStartPosition();
+    else if (!position.setFen(startFen)) return false;
+
+    moves.clear();
+    for (; i < words.size(); ++i) {
+        Move move = position.parseUciMove(words[i]);
+        if (move == NoMove || !position.makeMove(move)) return false;
+        moves.push_back(move);
+    }
+    return !moves.empty();
+}
+
+void PuzzleMiner::run(std::istream &input, std::ostream &output)
+{
+    LOG_INFO("puzzle_mining_started", {"threads", threadCount()}, {"scan_depth", options.scanDepth},
+             {"verify_depth", options.verifyDepth});
+
+    std::thread parser(&PuzzleMiner::parseStage, this, std::ref(input));
+    std::thread writer(&PuzzleMiner::writeStage, this, std::ref(output));
+    std::vector<std::thread> engines;
+    for (int i = 0; i < threadCount(); ++i) engines.emplace_back(&PuzzleMiner::engineStage, this, i);
+
+    parser.join();
+    for (auto &engine : engines) engine.join();
+    writeQueue.close();
+    writer.join();
+
+    LOG_INFO("puzzle_mining_finished", {"games", counters.games.load()}, {"positions", counters.positions.load()},
+             {"candidates", counters.candidates.load()}, {"puzzles", counters.puzzles.load()});
+}
+
+void PuzzleMiner::parseStage(std::istream &input)
+{
+    if (Trace::enabled()) Trace::setThreadName("puzzle parse");
+    std::string line;
+    uint64_t lineNumber = 0;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        Game game;
+        game.index = lineNumber;
+        if (!parseGame(line, game.startFen, game.moves)) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos && line[0] != '#') ++counters.invalidGames;
+            continue;
+        }
+        ++counters.games;
+        if (!scanQueue.push(std::move(game))) break;   // Tele sor: itt várunk a motorokra
+    }
+    scanQueue.close();
+}
+
+void PuzzleMiner::engineStage(int index)
+{
+    if (Trace::enabled()) Trace::setThreadName("puzzle engine");
+    Search &search = *searches[index];
+
+    while (true) {
+        // Előbb a mélyebb szakasz, így a jelöltek nem gyűlnek fel
+        Candidate candidate;
+        if (verifyQueue.tryPop(candidate)) {
+            verify(search, candidate);
+            continue;
+        }
+
+        // A számlálót a kivétel előtt növeljük: amíg nem nulla, jöhet még jelölt
+        ++scanning;
+        Game game;
+        if (scanQueue.pop(game, std::chrono::milliseconds(5))) {
+            scan(search, game);
+            --scanning;
+            continue;
+        }
+        --scanning;
+        if (scanQueue.drained() && scanning.load() == 0 && verifyQueue.size() == 0) return;
+    }
+}
+
+void PuzzleMiner::writeStage(std::ostream &output)
+{
+    if (Trace::enabled()) Trace::setThreadName("puzzle write");
+    Puzzle puzzle;
+    while (writeQueue.pop(puzzle)) {
+        output << puzzle.fen << ';';
+        for (size_t i = 0; i < puzzle.solution.size(); ++i)
+            output << (i ? " " : "") << Position::moveToUci(puzzle.solution[i]);
+        output << ';' << puzzle.score << ';' << puzzle.game << ':' << puzzle.ply << '\n';
+        ++counters.puzzles;
+    }
+    output.flush();
+}
+
+int PuzzleMiner::evaluate(Search &search, Position &position, int depth, Move *bestMove, bool useCache)
+{
+    if (useCache && options.cache) {
+        AnalysisCache::Entry entry;
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (options.cache->probe(position, depth, entry)) {
+            ++counters.cacheHits;
+            if (bestMove) *bestMove = entry.bestMove;
+            // A gyorsítótár mattnál lépésszámot tárol, a keresés pontszámára váltjuk vissza
+            return entry.mate ? Search::mateScore(entry.score) : entry.score;
+        }
+    }
+
+    SearchLimits limits;
+    limits.depth = depth;
+    auto start = std::chrono::steady_clock::now();
+    SearchResult result = search.think(position, limits);
+    counters.engineBusyNs += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - start).count());
+
+    if (bestMove) *bestMove = result.bestMove;
+    if (result.bestMove == NoMove) return position.inCheck() ? -Search::MateScore : 0;   // Matt vagy patt
+
+    if (useCache && options.cache) {
+        AnalysisCache::Entry entry;
+        entry.bestMove = result.bestMove;
+        entry.mate = Search::isMateScore(result.score);
+        entry.score = entry.mate ? Search::mateMoves(result.score) : result.score;
+        entry.depth = result.depth;
+        entry.pv = result.pv;
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        options.cache->store(position.key(), entry);
+    }
+    return result.score;
+}
+
+void PuzzleMiner::scan(Search &search, const Game &game)
+{
+    TRACE_SCOPE("PuzzleMiner::scan");
+    Position position;
+    if (game.startFen.empty()) position.setStartPosition();
+    else position.setFen(game.startFen);
+
+    // Minden állást a lépésen lévő fél szemszögéből értékelünk; ha a lépés után
+    // az ellenfél helyzete hirtelen nyerővé válik, a lépés hiba volt és az új állás jelölt
+    int previous = 0;
+    for (size_t ply = 0; ply <= game.moves.size(); ++ply) {
+        if (int(ply) >= options.minPly - 1) {
+            int score = evaluate(search, position, options.scanDepth, nullptr, true);
+            ++counters.positions;
+            int before = -previous;   // Az előző állás értéke a mostani lépő szemszögéből
+            if (int(ply) >= options.minPly && score >= options.winning && before < options.winning
+                && score - before >= options.swing && !Search::isMateScore(before)) {
+                MoveList legal;
+                position.generateLegal(legal);
+                if (legal.count > 1) {
+                    ++counters.candidates;
+                    Candidate candidate { game.index, int(ply), position.fen() };
+                    // Tele sornál a szál maga ellenőriz, így a motorszálak sosem várnak egymásra
+                    if (!verifyQueue.tryPush(candidate)) verify(search, candidate);
+                }
+            }
+            previous = score;
+        }
+        if (ply < game.moves.size()) position.makeMove(game.moves[ply]);
+    }
+}
+
+void PuzzleMiner::verify(Search &search, const Candidate &candidate)
+{
+    TRACE_SCOPE("PuzzleMiner::verify");
+    Position position;
+    if (!position.setFen(candidate.fen)) return;
+
+    Puzzle puzzle;
+    puzzle.game = candidate.game;
+    puzzle.ply = candidate.ply;
+    puzzle.fen = candidate.fen;
+
+    for (int solverMove = 0; solverMove < options.maxSolverMoves; ++solverMove) {
+        Move best = NoMove;
+        int score = evaluate(search, position, options.verifyDepth, &best, solverMove == 0);
+        if (best == NoMove || score < options.winning) break;
+        if (solverMove == 0) puzzle.score = score;
+
+        // Egyértelmű, ha a legjobbon kívül egyetlen lépés sem tartja a nyerő előnyt
+        MoveList legal;
+        position.generateLegal(legal);
+        bool unique = true;
+        for (int i = 0; i < legal.count && unique; ++i) {
+            Move move = legal.moves[i];
+            if (move == best) continue;
+            position.makeMove(move);
+            int alternative = -evaluate(search, position, options.verifyDepth - 1);
+            position.unmakeMove();
+            if (alternative >= options.winning) unique = false;
+        }
+        if (!unique) break;
+
+        puzzle.solution.push_back(best);
+        position.makeMove(best);
+
+        Move reply = NoMove;
+        evaluate(search, position, options.verifyDepth - 1, &reply);
+        if (reply == NoMove || solverMove + 1 == options.maxSolverMoves) break;   // Matt, patt vagy vége
+        puzzle.solution.push_back(reply);
+        position.makeMove(reply);
+    }
+
+    // A feladvány mindig a megoldó lépésével zárul
+    if (puzzle.solution.size() % 2 == 0 && !puzzle.solution.empty()) puzzle.solution.pop_back();
+    if (puzzle.solution.empty()) return;
+    writeQueue.push(std::move(puzzle));
+}
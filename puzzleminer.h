@@ -0,0 +1,109 @@
+#ifndef PUZZLEMINER_H
+#define PUZZLEMINER_H
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "position.h"
+#include "boundedqueue.h"
+
+class AnalysisCache;
+class Search;
+
+// Tactics puzzle mining over a game list.
+//
+// Input: one game per line, either bare UCI moves ("e2e4 e7e5 ...") or a UCI
+// position command ("position startpos moves ..." / "position fen <fen> moves ...").
+// Output: one puzzle per line, "<fen>;<solution uci moves>;<score>;<game>:<ply>".
+//
+// Stages run concurrently and are connected by bounded queues:
+//   parse (1 thread) -> shallow scan -> deep verify -> write (1 thread)
+// Scan and verify share one set of engine threads, each with its own Search.
+// An engine thread always prefers verify work, so candidates never pile up and
+// the engines stay busy as long as there are games left to scan.
+class PuzzleMiner
+{
+public:
+    struct Options
+    {
+        int threads = 0;            // Motorszálak, 0 = hardware threads
+        int hashSizeMb = 16;        // Szálanként
+        int scanDepth = 5;
+        int verifyDepth = 9;
+        int minPly = 10;            // A megnyitást kihagyjuk
+        int swing = 200;            // Ennyi cp változás egy lépés után jelölt
+        int winning = 200;          // Ennyi cp fölött számít nyerőnek
+        int maxSolverMoves = 3;
+        AnalysisCache *cache = nullptr;   // Opcionális, a szkennelés és a fő keresés eredményeihez
+    };
+
+    struct Stats
+    {
+        std::atomic<uint64_t> games { 0 };
+        std::atomic<uint64_t> invalidGames { 0 };
+        std::atomic<uint64_t> positions { 0 };
+        std::atomic<uint64_t> cacheHits { 0 };
+        std::atomic<uint64_t> candidates { 0 };
+        std::atomic<uint64_t> puzzles { 0 };
+        std::atomic<uint64_t> engineBusyNs { 0 };
+    };
+
+    explicit PuzzleMiner(const Options &options);
+    ~PuzzleMiner();
+
+    // Blocks until the input is exhausted and every puzzle has been written
+    void run(std::istream &input, std::ostream &output);
+
+    const Stats &stats() const { return counters; }
+    int threadCount() const { return int(searches.size()); }
+
+    // Parses one input line; false for empty, comment or malformed lines
+    static bool parseGame(const std::string &line, std::string &startFen, std::vector<Move> &moves);
+
+private:
+    struct Game
+    {
+        uint64_t index = 0;
+        std::string startFen;
+        std::vector<Move> moves;
+    };
+
+    struct Candidate
+    {
+        uint64_t game = 0;
+        int ply = 0;
+        std::string fen;
+    };
+
+    struct Puzzle
+    {
+        uint64_t game = 0;
+        int ply = 0;
+        std::string fen;
+        std::vector<Move> solution;
+        int score = 0;
+    };
+
+    void parseStage(std::istream &input);
+    void engineStage(int index);
+    void writeStage(std::ostream &output);
+
+    void scan(Search &search, const Game &game);
+    void verify(Search &search, const Candidate &candidate);
+    int evaluate(Search &search, Position &position, int depth, Move *bestMove = nullptr, bool useCache = false);
+
+    Options options;
+    std::vector<std::unique_ptr<Search>> searches;
+    BoundedQueue<Game> scanQueue;
+    BoundedQueue<Candidate> verifyQueue;
+    BoundedQueue<Puzzle> writeQueue;
+    std::atomic<int> scanning { 0 };   // Szkennelés alatt álló játszmák, ezekből még jöhet jelölt
+    std::mutex cacheMutex;
+    Stats counters;
+};
+
+#endif // PUZZLEMINER_H
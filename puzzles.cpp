@@ -0,0 +1,81 @@
+#include "puzzleminer.h"
+#include "analysiscache.h"
+#include "logger.h"
+#include <QCoreApplication>
+#include <QTextStream>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// Tactics puzzle miner.
+//
+//   chess_puzzles [--threads n] [--scan-depth d] [--verify-depth d] [--swing cp]
+//                 [--min-ply n] [--cache file] games.txt [puzzles.txt]
+//
+// games.txt holds one game per line as UCI moves (see PuzzleMiner). Puzzles go
+// to puzzles.txt or stdout, the summary to stderr.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    PuzzleMiner::Options options;
+    QString cachePath;
+    QStringList files;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--threads" && i + 1 < args.size()) options.threads = args[++i].toInt();
+        else if (args[i] == "--scan-depth" && i + 1 < args.size()) options.scanDepth = args[++i].toInt();
+        else if (args[i] == "--verify-depth" && i + 1 < args.size()) options.verifyDepth = args[++i].toInt();
+        else if (args[i] == "--swing" && i + 1 < args.size()) options.swing = args[++i].toInt();
+        else if (args[i] == "--min-ply" && i + 1 < args.size()) options.minPly = args[++i].toInt();
+        else if (args[i] == "--cache" && i + 1 < args.size()) cachePath = args[++i];
+        else files.append(args[i]);
+    }
+
+    QTextStream err(stderr);
+    if (files.isEmpty()) {
+        err << "usage: chess_puzzles [options] games.txt [puzzles.txt]\n";
+        return 2;
+    }
+
+    Log::Level logLevel = Log::levelFromName(qEnvironmentVariable("CHESS_LOG_LEVEL", "off").toStdString());
+    if (logLevel != Log::Off) Log::start(qEnvironmentVariable("CHESS_LOG", "chess_puzzles.log").toStdString(), logLevel);
+
+    std::ifstream input(files[0].toStdString());
+    if (!input) {
+        err << "Cannot read " << files[0] << "\n";
+        return 1;
+    }
+    std::ofstream outputFile;
+    if (files.size() > 1) {
+        outputFile.open(files[1].toStdString());
+        if (!outputFile) {
+            err << "Cannot write " << files[1] << "\n";
+            return 1;
+        }
+    }
+
+    AnalysisCache cache;
+    if (!cachePath.isEmpty() && cache.open(cachePath)) options.cache = &cache;
+
+    PuzzleMiner miner(options);
+    auto start = std::chrono::steady_clock::now();
+    miner.run(input, files.size() > 1 ? static_cast<std::ostream &>(outputFile) : std::cout);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Motorkihasználtság: a keresésben töltött idő a teljes szálidő arányában
+    const PuzzleMiner::Stats &stats = miner.stats();
+    double busy = double(stats.engineBusyNs.load()) / 1e9;
+    err << QString("games %1 (invalid %2), positions %3, candidates %4, puzzles %5\n")
+               .arg(stats.games.load()).arg(stats.invalidGames.load()).arg(stats.positions.load())
+               .arg(stats.candidates.load()).arg(stats.puzzles.load());
+    err << QString("%1 s, %2 games/s, %3 positions/s, engine utilization %4% on %5 threads, cache hits %6\n")
+               .arg(seconds, 0, 'f', 2)
+               .arg(seconds > 0 ? stats.games.load() / seconds : 0.0, 0, 'f', 1)
+               .arg(seconds > 0 ? stats.positions.load() / seconds : 0.0, 0, 'f', 1)
+               .arg(seconds > 0 ? 100.0 * busy / (seconds * miner.threadCount()) : 0.0, 0, 'f', 1)
+               .arg(miner.threadCount())
+               .arg(stats.cacheHits.load());
+    Log::stop();
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "search.h"
+#include <cstring>
+#include "trace.h"
+
+namespace {
+
+const int Infinity = Search::MateScore + 1;
+
+} // namespace
+
+Search::Search(int hashSizeMb)
+{
+    size_t entries = size_t(hashSizeMb) * 1024 * 1024 / sizeof(TTEntry);
+    size_t size = 1;
+    while (size * 2 <= entries) size *= 2;   // Kettő hatványa, hogy maszkolással indexelhessünk
+    table.resize(size);
+    clear();
+}
+
+void Search::clear()
+{
+    std::fill(table.begin(), table.end(), TTEntry { 0, NoMove, 0, 0, 0 });
+    std::memset(killers, 0, sizeof(killers));
+    std::memset(history, 0, sizeof(history));
+}
+
+void Search::checkTime()
+{
+    if (abortFlag && abortFlag->load(std::memory_order_relaxed)) stopped = true;
+    if (timeLimit <= 0) return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+    if (elapsed >= timeLimit) stopped = true;
+}
+
+void Search::storeEntry(uint64_t key, Move move, int score, int depth, int flag, int ply)
+{
+    // Mattértékeket a csomóponthoz viszonyítva tároljuk
+    if (score > MateScore - MaxPly) score += ply;
+    else if (score < -MateScore + MaxPly) score -= ply;
+
+    TTEntry &entry = table[key & (table.size() - 1)];
+    if (entry.key == key && depth < entry.depth && flag != ExactBound) return;
+    if (move != NoMove || entry.key != key) entry.move = move;
+    entry.key = key;
+    entry.score = int16_t(score);
+    entry.depth = int8_t(depth);
+    entry.flag = uint8_t(flag);
+}
+
+SearchResult Search::think(Position &position, const SearchLimits &limits)
+{
+    TRACE_SCOPE("Search::think");
+    SearchResult result;
+    stopped = false;
+    nodes = 0;
+    timeLimit = limits.movetime;
+    startTime = std::chrono::steady_clock::now();
+
+    int clockTime = position.whiteToMove() ? limits.wtime : limits.btime;
+    useTimeManager = limits.movetime <= 0 && clockTime > 0;
+    if (useTimeManager) {
+        int increment = position.whiteToMove() ? limits.winc : limits.binc;
+        timeManager.init(clockTime, increment, limits.movestogo, position.ply());
+        timeLimit = timeManager.maximumTime();
+    }
+
+    // A history táblát öregítjük, hogy a korábbi keresések ne domináljanak
+    for (auto &side : history)
+        for (auto &from : side)
+            for (int &value : from) value /= 8;
+    std::memset(killers, 0, sizeof(killers));
+
+    MoveList legal;
+    position.generateLegal(legal);
+    if (legal.count == 0) return result;
+    result.bestMove = legal.moves[0];
+
+    // Egyetlen legális lépésnél nincs mit gondolkodni
+    if (legal.count == 1 && useTimeManager) return result;
+
+    int maxDepth = limits.depth < MaxPly - 1 ? limits.depth : MaxPly - 1;
+    int stability = 0;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        Trace::Scope iterationScope("Search::iteration");
+        int score = alphaBeta(position, depth, -Infinity, Infinity, 0);
+        if (stopped && depth > 1) break;
+
+        Move previousBest = result.bestMove;
+        result.score = score;
+        result.depth = depth;
+        result.pv.assign(pvTable[0], pvTable[0] + pvLength[0]);
+        if (!result.pv.empty()) result.bestMove = result.pv.front();
+        stability = (depth > 1 && result.bestMove == previousBest) ? stability + 1 : 0;
+
+        int elapsed = int(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+        if (useTimeManager) {
+            if (timeManager.shouldStop(elapsed, stability)) break;
+        } else if (timeLimit > 0 && elapsed * 2 >= timeLimit) {
+            break; // Ha az idő fele elfogyott, a következő iteráció úgysem fejeződne be
+        }
+        if (score > MateScore - MaxPly || score < -MateScore + MaxPly) break;
+    }
+
+    result.nodes = nodes;
+    result.elapsed = int(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+    return result;
+}
+
+int Search::alphaBeta(Position &pos, int depth, int alpha, int beta, int ply)
+{
+    pvLength[ply] = 0;
+    if (ply >= MaxPly - 1) return pos.evaluation().evaluate(pos.whiteToMove());
+
+    bool inCheck = pos.inCheck();
+    if (inCheck) ++depth;   // Sakk esetén meghosszabbítunk
+    if (depth <= 0) return quiescence(pos, alpha, beta, ply);
+
+    if ((++nodes & 2047) == 0) checkTime();
+    if (stopped) return 0;
+
+    if (ply > 0 && (pos.isRepetition() || pos.halfmoveClock() >= 100)) return 0;
+
+    bool pvNode = beta - alpha > 1;
+    uint64_t key = pos.key();
+    const TTEntry &entry = table[key & (table.size() - 1)];
+    Move hashMove = NoMove;
+    if (entry.key == key) {
+        hashMove = entry.move;
+        int score = entry.score;
+        if (score > MateScore - MaxPly) score -= ply;
+        else if (score < -MateScore + MaxPly) score += ply;
+        if (!pvNode && ply > 0 && entry.depth >= depth) {
+            if (entry.flag == ExactBound) return score;
+            if (entry.flag == LowerBound && score >= beta) return score;
+            if (entry.flag == UpperBound && score <= alpha) return score;
+        }
+    }
+
+    bool white = pos.whiteToMove();
+    MovePicker picker(pos, hashMove, killers[ply], &history[white ? 0 : 1]);
+    int originalAlpha = alpha;
+    int bestScore = -Infinity;
+    Move bestMove = NoMove;
+    int legalMoves = 0;
+
+    Move move;
+    while ((move = picker.next()) != NoMove) {
+        bool quiet = !pos.isTactical(move);
+        if (!pos.makeMove(move)) continue;
+        ++legalMoves;
+
+        int score;
+        if (legalMoves == 1) {
+            score = -alphaBeta(pos, depth - 1, -beta, -alpha, ply + 1);
+        } else {
+            // Nullablakos keresés, csak javulás esetén keresünk újra teljes ablakkal
+            score = -alphaBeta(pos, depth - 1, -alpha - 1, -alpha, ply + 1);
+            if (score > alpha && score < beta) score = -alphaBeta(pos, depth - 1, -beta, -alpha, ply + 1);
+        }
+        pos.unmakeMove();
+        if (stopped) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                pvTable[ply][0] = move;
+                for (int i = 0; i < pvLength[ply + 1]; ++i) pvTable[ply][i + 1] = pvTable[ply + 1][i];
+                pvLength[ply] = pvLength[ply + 1] + 1;
+            }
+        }
+        if (alpha >= beta) {
+            if (quiet) {
+                if (killers[ply][0] != move) {
+                    killers[ply][1] = killers[ply][0];
+                    killers[ply][0] = move;
+                }
+                int &value = history[white ? 0 : 1][moveFrom(move)][moveTo(move)];
+                value += depth * depth;
+                if (value > 1000000) {
+                    for (auto &from : history[white ? 0 : 1])
+                        for (int &v : from) v /= 2;
+                }
+            }
+            break;
+        }
+    }
+
+    if (legalMoves == 0) return inCheck ? -MateScore + ply : 0;
+
+    int flag = bestScore >= beta ? LowerBound : (bestScore > originalAlpha ? ExactBound : UpperBound);
+    storeEntry(key, bestMove, bestScore, depth, flag, ply);
+    return bestScore;
+}
+
+int Search::quiescence(Position &pos, int alpha, int beta, int ply)
+{
+    pvLength[ply] = 0;
+    if ((++nodes & 2047) == 0) checkTime();
+    if (stopped) return 0;
+
+    int standPat = pos.evaluation().evaluate(pos.whiteToMove());
+    if (ply >= MaxPly - 1 || standPat >= beta) return standPat;
+    if (standPat > alpha) alpha = standPat;
+
+    uint64_t key = pos.key();
+    const TTEntry &entry = table[key & (table.size() - 1)];
+    MovePicker picker(pos, entry.key == key ? entry.move : NoMove);
+
+    Move move;
+    while ((move = picker.next()) != NoMove) {
+        if (!pos.makeMove(move)) continue;
+        int score = -quiescence(pos, -beta, -alpha, ply + 1);
+        pos.unmakeMove();
+        if (stopped) return 0;
+
+        if (score > alpha) {
+            if (score >= beta) return score;
+            alpha = score;
+        }
+    }
+    return alpha;
+}
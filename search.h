@@ -0,0 +1,89 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include "position.h"
+#include "movepicker.h"
+#include "timemanager.h"
+
+struct SearchLimits
+{
+    int depth = 64;
+    int movetime = 0;   // ms, 0 = no time limit
+    int wtime = 0;      // Clock times in ms, used when movetime is 0
+    int btime = 0;
+    int winc = 0;
+    int binc = 0;
+    int movestogo = 0;
+};
+
+struct SearchResult
+{
+    Move bestMove = NoMove;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+    int elapsed = 0;    // ms
+    std::vector<Move> pv;
+};
+
+// In-process alpha-beta search used when no external UCI engine is running.
+// Principal variation search with a transposition table, quiescence search and
+// the staged MovePicker (hash move, captures, killers, history).
+class Search
+{
+public:
+    explicit Search(int hashSizeMb = 16);
+
+    SearchResult think(Position &position, const SearchLimits &limits);
+    void stop() { stopped = true; }
+    // Extra stop request polled together with the clock, for owners that
+    // cannot call stop() at the right moment (EnginePool::cancel)
+    void setAbortFlag(const std::atomic<bool> *flag) { abortFlag = flag; }
+    void clear();
+
+    static const int MateScore = 32000;
+    static const int MaxPly = 64;
+
+    // A matt MateScore - (fél lépések a mattig); a gyorsítótár és a felület a UCI
+    // "score mate n" szerinti lépésszámot tárolja, előjellel
+    static bool isMateScore(int score) { return std::abs(score) >= MateScore - MaxPly; }
+    static int mateMoves(int score) { return score > 0 ? (MateScore - score + 1) / 2 : -((MateScore + score + 1) / 2); }
+    static int mateScore(int moves) { return moves > 0 ? MateScore - 2 * moves + 1 : -MateScore - 2 * moves; }
+
+private:
+    struct TTEntry
+    {
+        uint64_t key;
+        Move move;
+        int16_t score;
+        int8_t depth;
+        uint8_t flag;
+    };
+    enum { ExactBound, LowerBound, UpperBound };
+
+    int alphaBeta(Position &pos, int depth, int alpha, int beta, int ply);
+    int quiescence(Position &pos, int alpha, int beta, int ply);
+    void checkTime();
+    void storeEntry(uint64_t key, Move move, int score, int depth, int flag, int ply);
+
+    std::vector<TTEntry> table;
+    Move killers[MaxPly][2];
+    MovePicker::HistoryTable history[2];
+    Move pvTable[MaxPly][MaxPly];
+    int pvLength[MaxPly];
+
+    std::atomic<bool> stopped { false };
+    const std::atomic<bool> *abortFlag = nullptr;
+    uint64_t nodes = 0;
+    int timeLimit = 0;
+    TimeManager timeManager;
+    bool useTimeManager = false;
+    std::chrono::steady_clock::time_point startTime;
+};
+
+#endif // SEARCH_H
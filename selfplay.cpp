@@ -0,0 +1,149 @@
+#include "selfplay.h"
+#include "search.h"
+#include "trace.h"
+#include "logger.h"
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+SelfPlayGame::SelfPlayGame(const SelfPlayOptions &options, uint64_t seed)
+    : options(options)
+{
+    std::mt19937_64 random(seed);
+    // Ha a véletlen nyitás matthoz vagy patthoz vezet, újrakezdjük
+    do {
+        board.setStartPosition();
+        for (int ply = 0; ply < options.randomPlies; ++ply) {
+            MoveList legal;
+            board.generateLegal(legal);
+            if (legal.count == 0) break;
+            board.makeMove(legal.moves[random() % uint64_t(legal.count)]);
+        }
+    } while (board.outcome() != GameOutcome::Ongoing);
+}
+
+bool SelfPlayGame::play(Move move, int score, bool mate)
+{
+    if (over) return false;
+    if (move == NoMove || !board.isPseudoLegal(move)) {
+        abandon();
+        return false;
+    }
+
+    bool quiet = !board.inCheck() && !board.isTactical(move) && !mate && std::abs(score) <= options.maxScore;
+    if (quiet && board.ply() >= options.minPly) {
+        TrainingSample sample;
+        if (TrainingData::pack(board, score, GameResult::Unknown, sample)) kept.push_back(sample);
+    } else {
+        ++filtered;
+    }
+
+    int whiteScore = board.whiteToMove() ? score : -score;
+    if (!board.makeMove(move)) {
+        abandon();
+        return false;
+    }
+
+    GameOutcome outcome = board.outcome();
+    if (outcome == GameOutcome::Checkmate) {
+        finish(board.whiteToMove() ? GameResult::BlackWins : GameResult::WhiteWins);
+        return true;
+    }
+    if (outcome != GameOutcome::Ongoing || board.ply() >= options.maxPly) {
+        finish(GameResult::Draw);
+        return true;
+    }
+
+    // Döntés a tartós értékelés alapján, mindkét fél egyetértésével
+    bool winning = mate || std::abs(whiteScore) >= options.winScore;
+    int side = winning ? (whiteScore > 0 ? 1 : -1) : 0;
+    winStreak = side == 0 ? 0 : (winStreak * side > 0 ? winStreak + side : side);
+    if (std::abs(winStreak) >= options.winPlies) {
+        finish(winStreak > 0 ? GameResult::WhiteWins : GameResult::BlackWins);
+        return true;
+    }
+    drawStreak = std::abs(whiteScore) <= options.drawScore ? drawStreak + 1 : 0;
+    if (board.ply() >= options.drawMinPly && drawStreak >= options.drawPlies) finish(GameResult::Draw);
+    return true;
+}
+
+void SelfPlayGame::abandon()
+{
+    // A külső motor szabálytalan lépése: a játszmát nem címkézzük
+    kept.clear();
+    over = true;
+}
+
+void SelfPlayGame::finish(GameResult result)
+{
+    over = true;
+    gameResult = result;
+    for (TrainingSample &sample : kept) TrainingData::setResult(sample, result);
+}
+
+void SelfPlayStats::add(SelfPlayGame &game)
+{
+    ++games;
+    plies += uint64_t(game.position().ply());
+    positions += game.samples().size();
+    skipped += uint64_t(game.skipped());
+    ++results[int(game.result())];
+}
+
+DataGenerator::DataGenerator(const Options &options)
+    : options(options)
+{
+    int threads = options.threads;
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    for (int i = 0; i < threads; ++i) searches.emplace_back(new Search(options.hashSizeMb));
+}
+
+DataGenerator::~DataGenerator() = default;
+
+uint64_t DataGenerator::gameSeed(uint64_t seed, uint64_t game)
+{
+    // splitmix64, hogy a szomszédos sorszámok se adjanak hasonló nyitást
+    uint64_t z = seed * 0x9E3779B97F4A7C15ULL + game + 1;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void DataGenerator::run(TrainingDataWriter &writer)
+{
+    LOG_INFO("datagen_started", {"threads", threadCount()}, {"depth", options.depth}, {"games", options.games});
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount(); ++i) threads.emplace_back(&DataGenerator::worker, this, i, std::ref(writer));
+    for (auto &thread : threads) thread.join();
+    LOG_INFO("datagen_finished", {"games", counters.games.load()}, {"positions", counters.positions.load()});
+}
+
+void DataGenerator::worker(int index, TrainingDataWriter &writer)
+{
+    if (Trace::enabled()) Trace::setThreadName("datagen");
+    Search &search = *searches[index];
+    SearchLimits limits;
+    limits.depth = options.depth;
+
+    while (!stopping) {
+        uint64_t number = nextGame++;
+        if (number >= options.games) return;
+
+        TRACE_SCOPE("DataGenerator::game");
+        SelfPlayGame game(options.game, gameSeed(options.seed, number));
+        search.clear();   // A játszmák egymástól függetlenek legyenek
+        while (!game.isOver() && !stopping) {
+            auto start = std::chrono::steady_clock::now();
+            SearchResult result = search.think(game.position(), limits);
+            counters.engineBusyNs += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            bool mate = std::abs(result.score) >= Search::MateScore - Search::MaxPly;
+            if (!game.play(result.bestMove, result.score, mate)) break;
+        }
+        if (!game.isOver()) return;
+
+        counters.add(game);
+        writer.append(std::move(game.samples()));
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "position.h"
+#include "trainingdata.h"
+
+class Search;
+
+struct SelfPlayOptions
+{
+    int randomPlies = 8;        // Véletlen nyitólépések, hogy a játszmák eltérjenek
+    int minPly = 16;            // Ennél korábbi állást nem írunk ki
+    int maxPly = 400;           // Utána döntetlen
+    int maxScore = 3000;        // Ennél nagyobb értékelésű állás nem tanítóminta
+    int winScore = 2000;        // Feladás: winPlies egymást követő lépésen ekkora előny
+    int winPlies = 6;
+    int drawScore = 10;         // Döntetlen: drawMinPly után drawPlies lépésen ekkora eltérés
+    int drawPlies = 12;
+    int drawMinPly = 80;
+};
+
+// One self-play game. Starts with random legal moves, then takes the moves the
+// engine chose together with their scores. Quiet positions (not in check,
+// best move neither a capture nor a promotion, no mate score) are kept as
+// samples and labelled with the result when the game ends: by the rules, at
+// maxPly, or adjudicated on a lasting score.
+class SelfPlayGame
+{
+public:
+    SelfPlayGame(const SelfPlayOptions &options, uint64_t seed);
+
+    // The engine may search on it but has to leave it unchanged
+    Position &position() { return board; }
+    bool isOver() const { return over; }
+    GameResult result() const { return gameResult; }
+
+    // score: the engine's score of the current position, side to move's point
+    // of view; false if the move is illegal (the game is then abandoned)
+    bool play(Move move, int score, bool mate);
+
+    std::vector<TrainingSample> &samples() { return kept; }
+    int skipped() const { return filtered; }
+
+private:
+    void finish(GameResult result);
+    void abandon();
+
+    SelfPlayOptions options;
+    Position board;
+    std::vector<TrainingSample> kept;
+    int filtered = 0;
+    int winStreak = 0;          // Előjeles: fehér javára pozitív
+    int drawStreak = 0;
+    bool over = false;
+    GameResult gameResult = GameResult::Unknown;
+};
+
+struct SelfPlayStats
+{
+    std::atomic<uint64_t> games { 0 };
+    std::atomic<uint64_t> plies { 0 };
+    std::atomic<uint64_t> positions { 0 };      // Kiírt minták
+    std::atomic<uint64_t> skipped { 0 };        // Nem csendes vagy túl korai állások
+    std::atomic<uint64_t> results[4] {};         // GameResult szerint
+    std::atomic<uint64_t> engineBusyNs { 0 };
+
+    void add(SelfPlayGame &game);
+};
+
+// Self-play with the in-process search on every core. Each thread plays whole
+// games with its own Search; finished games go to the writer as one batch.
+// Game n is seeded from seed and n only, so a run is reproducible for any
+// thread count.
+class DataGenerator
+{
+public:
+    struct Options
+    {
+        int threads = 0;            // 0 = hardware threads
+        int hashSizeMb = 4;         // Szálanként, játszmánként törölve
+        int depth = 6;
+        uint64_t games = 100;
+        uint64_t seed = 1;
+        SelfPlayOptions game;
+    };
+
+    explicit DataGenerator(const Options &options);
+    ~DataGenerator();
+
+    // Blocks until every game has been played and queued to the writer
+    void run(TrainingDataWriter &writer);
+    void stop() { stopping = true; }   // A félbehagyott játszmák mintái elvesznek
+
+    const SelfPlayStats &stats() const { return counters; }
+    int threadCount() const { return int(searches.size()); }
+
+    static uint64_t gameSeed(uint64_t seed, uint64_t game);
+
+private:
+    void worker(int index, TrainingDataWriter &writer);
+
+    Options options;
+    std::vector<std::unique_ptr<Search>> searches;
+    std::atomic<uint64_t> nextGame { 0 };
+    std::atomic<bool> stopping { false };
+    SelfPlayStats counters;
+};
+
+#endif // SELFPLAY_H
@@ -0,0 +1,43 @@
+#include "gameserver.h"
+#include "logger.h"
+#include <QCoreApplication>
+#include <QDebug>
+
+// chess_server [--port 7878 | --unix name] [--threads n] [--hash mb] [--depth n] [--movetime ms] [--cache file]
+//              [--archive file]
+//
+// Headless game server: only QtCore and QtNetwork, no display needed.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    GameServer::Options options;
+    options.engineLimits.depth = 4;   // Alapból gyors, sekély motorválasz
+    quint16 port = 7878;
+    QString localName;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        if (args[i] == "--port" && i + 1 < args.size()) port = quint16(args[++i].toUInt());
+        else if (args[i] == "--unix" && i + 1 < args.size()) localName = args[++i];
+        else if (args[i] == "--threads" && i + 1 < args.size()) options.engineThreads = args[++i].toInt();
+        else if (args[i] == "--hash" && i + 1 < args.size()) options.engineHashMb = args[++i].toInt();
+        else if (args[i] == "--depth" && i + 1 < args.size()) options.engineLimits.depth = args[++i].toInt();
+        else if (args[i] == "--movetime" && i + 1 < args.size()) options.engineLimits.movetime = args[++i].toInt();
+        else if (args[i] == "--cache" && i + 1 < args.size()) options.cachePath = args[++i];
+        else if (args[i] == "--archive" && i + 1 < args.size()) options.archivePath = args[++i];
+    }
+
+    Log::Level logLevel = Log::levelFromName(qEnvironmentVariable("CHESS_LOG_LEVEL", "info").toStdString());
+    if (logLevel != Log::Off) Log::start(qEnvironmentVariable("CHESS_LOG", "chess_server.log").toStdString(), logLevel);
+
+    GameServer server(options);
+    bool listening = localName.isEmpty() ? server.listenTcp(port) : server.listenLocal(localName);
+    if (!listening) {
+        qDebug() << "❌ Nem sikerült elindítani a szervert:" << server.errorString();
+        return 1;
+    }
+    qDebug() << "✅ chess_server fut:" << (localName.isEmpty() ? QString("127.0.0.1:%1").arg(port) : localName);
+    int result = app.exec();
+    Log::stop();
+    return result;
+}
@@ -0,0 +1,205 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+// Eagerly started coroutine with a result of type T.
+//
+//   Task<int> depthOf(AsyncEngine &engine, Position position)
+//   {
+//       EngineReply reply = co_await engine.search(position, limits);
+//       co_return reply.result.depth;
+//   }
+//
+// A Task can be awaited from another coroutine (once) or waited for with the
+// blocking get(). Dropping an unfinished Task detaches it: the coroutine runs
+// to completion and frees itself, which is the fire-and-forget form used by
+// event loop code. The coroutine may finish on any thread.
+template <typename T = void>
+class Task;
+
+namespace TaskDetail {
+
+// A korutin állapota egy atomikus mutató: nullptr = fut, különben a rá váró
+// korutin címe, vagy a két jelölő egyike (kész / eldobott)
+inline void *doneMarker()
+{
+    static char marker;
+    return &marker;
+}
+
+inline void *detachedMarker()
+{
+    static char marker;
+    return &marker;
+}
+
+struct PromiseBase
+{
+    std::atomic<void *> state { nullptr };
+    std::exception_ptr exception;
+
+    struct FinalAwaiter
+    {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            void *previous = handle.promise().state.exchange(doneMarker(), std::memory_order_acq_rel);
+            if (previous == detachedMarker()) handle.destroy();
+            else if (previous) std::coroutine_handle<>::from_address(previous).resume();
+        }
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() { exception = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase
+{
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    template <typename U>
+    void return_value(U &&result) { value.emplace(std::forward<U>(result)); }
+    T take()
+    {
+        if (exception) std::rethrow_exception(exception);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase
+{
+    Task<void> get_return_object();
+    void return_void() {}
+    void take()
+    {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+// A blokkoló get() segédje: megvárja a Taskot, majd jelez a várakozó szálnak
+struct SyncWaiter
+{
+    struct promise_type
+    {
+        SyncWaiter get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+} // namespace TaskDetail
+
+template <typename T>
+class Task
+{
+public:
+    typedef TaskDetail::Promise<T> promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    explicit Task(Handle handle) : handle(handle) {}
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other) {
+            release();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task() { release(); }
+
+    bool done() const { return handle && handle.promise().state.load(std::memory_order_acquire) == TaskDetail::doneMarker(); }
+
+    // Blocks the calling thread until the coroutine finished; rethrows its exception
+    T get()
+    {
+        if (!done()) {
+            std::mutex mutex;
+            std::condition_variable finished;
+            bool ready = false;
+            waitFor(mutex, finished, ready);
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&ready]() { return ready; });
+        }
+        return handle.promise().take();
+    }
+
+    struct Awaiter
+    {
+        Handle handle;
+
+        bool await_ready() const noexcept
+        {
+            return handle.promise().state.load(std::memory_order_acquire) == TaskDetail::doneMarker();
+        }
+        bool await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            // Ha közben befejeződött, nem függesztünk fel
+            void *expected = nullptr;
+            return handle.promise().state.compare_exchange_strong(expected, awaiting.address(), std::memory_order_acq_rel);
+        }
+        T await_resume() { return handle.promise().take(); }
+    };
+
+    // Waits for completion without taking the result
+    struct Completion : Awaiter
+    {
+        void await_resume() noexcept {}
+    };
+
+    Awaiter operator co_await() & noexcept { return Awaiter { handle }; }
+    Awaiter operator co_await() && noexcept { return Awaiter { handle }; }
+
+private:
+    TaskDetail::SyncWaiter waitFor(std::mutex &mutex, std::condition_variable &finished, bool &ready)
+    {
+        co_await Completion { { handle } };
+        std::lock_guard<std::mutex> lock(mutex);
+        ready = true;
+        finished.notify_one();
+    }
+
+    void release()
+    {
+        if (!handle) return;
+        void *previous = handle.promise().state.exchange(TaskDetail::detachedMarker(), std::memory_order_acq_rel);
+        if (previous == TaskDetail::doneMarker()) handle.destroy();
+        handle = nullptr;
+    }
+
+    Handle handle;
+};
+
+namespace TaskDetail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object()
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+} // namespace TaskDetail
+
+#endif // TASK_H
@@ -0,0 +1,649 @@
+#include "position.h"
+#include "perft.h"
+#include "attackmap.h"
+#include "gamearchive.h"
+#include "trainingdata.h"
+#include "gamerecord.h"
+#include "analysiscache.h"
+#include "analysistree.h"
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// Checks of the engine core without the GUI (QtCore only for the analysis
+// cache), registered with CTest.
+//
+//   chess_tests [group...]
+//
+// Groups: perft, positions, attackmap, archive, trainingdata, gamerecord,
+// analysiscache, analysistree, san (all by default).
+// Files are written to the working directory. Exit code 1 if any check failed.
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) check(condition, #condition, __FILE__, __LINE__)
+
+void check(bool ok, const char *expression, const char *file, int line)
+{
+    if (ok) return;
+    ++failures;
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+}
+
+const char *const StartFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Véletlen játszmák: minden megtett lépés után meghívja a visitort
+void randomGames(uint32_t seed, int games, int maxPly, const std::function<void(Position &)> &visit,
+                 bool trackAttacks = false)
+{
+    std::mt19937 random(seed);
+    for (int game = 0; game < games; ++game) {
+        Position position;
+        position.setAttackTracking(trackAttacks);
+        position.setStartPosition();
+        for (int ply = 0; ply < maxPly; ++ply) {
+            MoveList legal;
+            position.generateLegal(legal);
+            if (legal.count == 0) break;
+            position.makeMove(legal.moves[random() % uint32_t(legal.count)]);
+            visit(position);
+        }
+    }
+}
+
+void testPerft()
+{
+    struct Case { const char *fen; int depth; uint64_t nodes; };
+    const Case cases[] = {
+        { StartFen, 5, 4865609 },
+        { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603 },
+        { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624 },
+        { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333 },
+        { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487 },
+        { "8/8/8/8/k2Pp2Q/8/8/3K4 b - d3 0 1", 1, 6 },           // En passant saját királyt nyitna
+        { "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467 },
+        { "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001 },     // Átváltozás sakkal
+        { "r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476 },
+    };
+    for (const Case &test : cases) {
+        Position position;
+        CHECK(position.setFen(test.fen));
+        uint64_t nodes = perft(position, test.depth);
+        CHECK(nodes == test.nodes);
+        if (nodes != test.nodes)
+            std::fprintf(stderr, "  perft %s d%d = %llu, expected %llu\n", test.fen, test.depth,
+                         (unsigned long long)nodes, (unsigned long long)test.nodes);
+
+        ParallelPerft::Options options;
+        options.threads = 4;
+        options.hashSizeMb = 16;
+        CHECK(ParallelPerft(options).run(position, test.depth).nodes == test.nodes);
+    }
+}
+
+void testPositions()
+{
+    // makeMove/unmakeMove visszaállítja az állást, a FEN oda-vissza ugyanazt adja
+    randomGames(1, 200, 200, [](Position &position) {
+        std::string fen = position.fen();
+        uint64_t key = position.key();
+        Position parsed;
+        CHECK(parsed.setFen(fen));
+        CHECK(parsed.fen() == fen);
+        CHECK(parsed.key() == key);
+
+        MoveList legal;
+        position.generateLegal(legal);
+        for (int i = 0; i < legal.count; ++i) {
+            CHECK(position.makeMove(legal.moves[i]));
+            position.unmakeMove();
+        }
+        CHECK(position.fen() == fen);
+        CHECK(position.key() == key);
+
+        // A mezőnkénti generálás együtt ugyanaz, mint az egész állásé
+        MoveList pseudo, perPiece;
+        position.generateCaptures(pseudo);
+        position.generateQuiets(pseudo);
+        for (int square = 0; square < 64; ++square) position.generatePieceMoves(square, perPiece);
+        CHECK(perPiece.count == pseudo.count);
+    });
+}
+
+void testAttackMap()
+{
+    // Az inkrementálisan frissített térkép egyezik a sugárjárással és az újraépítettel
+    AttackMap map;
+    int mismatches = 0;
+    randomGames(5, 300, 200, [&](Position &position) {
+        // Csak a megváltozott mezők frissülnek ténylegesen
+        for (int square = 0; square < 64; ++square) map.set(square, position.pieceAt(square));
+        AttackMap fresh;
+        for (int square = 0; square < 64; ++square) fresh.set(square, position.pieceAt(square));
+        for (int square = 0; square < 64; ++square) {
+            for (int white = 0; white < 2; ++white) {
+                if (map.isAttacked(square, white) != position.isSquareAttacked(square, white)
+                    || map.attackCount(square, white) != fresh.attackCount(square, white)) ++mismatches;
+            }
+        }
+    });
+    CHECK(mismatches == 0);
+
+    // A Position saját térképe (make/unmake közben frissítve) ugyanazt adja, mint a sugárjárás
+    mismatches = 0;
+    randomGames(6, 200, 200, [&](Position &position) {
+        Position plain = position;
+        plain.setAttackTracking(false);
+        AttackMap fresh;
+        for (int square = 0; square < 64; ++square) fresh.set(square, position.pieceAt(square));
+        for (int square = 0; square < 64; ++square) {
+            for (int white = 0; white < 2; ++white) {
+                if (position.isSquareAttacked(square, white) != plain.isSquareAttacked(square, white)
+                    || position.attacks().attackCount(square, white) != fresh.attackCount(square, white)) ++mismatches;
+            }
+        }
+        MoveList tracked, reference;
+        position.generateLegal(tracked);
+        plain.generateLegal(reference);
+        if (tracked.count != reference.count) ++mismatches;
+    }, true);
+    CHECK(mismatches == 0);
+
+    Position kiwipete;
+    kiwipete.setAttackTracking(true);
+    kiwipete.setFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    CHECK(perft(kiwipete, 3) == 97862);
+}
+
+// Nyers bájtok a fájlba: "ab" módban egy összeomláskor félbe írt rekordot, "wb" módban idegen fájlt állít elő
+void writeBytes(const char *path, const char *mode, const void *data, size_t size)
+{
+    if (FILE *file = std::fopen(path, mode)) {
+        std::fwrite(data, 1, size, file);
+        std::fclose(file);
+    }
+}
+
+ArchivedGame sampleGame()
+{
+    const char *moves[] = { "e2e4", "e7e5", "g1f3", "b8c6", "f1b5", "a7a6", "b5a4", "g8f6", "e1g1", "f8e7",
+                            "f1e1", "b7b5", "a4b3", "d7d6", "c2c3", "e8g8", "h2h3", "c6b8", "d2d4", "b8d7" };
+    Position position;
+    position.setStartPosition();
+    ArchivedGame game;
+    for (const char *uci : moves) {
+        Move move = position.parseUciMove(uci);
+        game.moves.push_back(move);
+        position.makeMove(move);
+    }
+    game.white = "Player \"A\"";
+    game.black = "Engine";
+    game.result = GameResult::Draw;
+    game.date = 1700000000;
+    return game;
+}
+
+bool sameGame(const ArchivedGame &a, const ArchivedGame &b)
+{
+    return a.startFen == b.startFen && a.moves == b.moves && a.result == b.result && a.date == b.date
+           && a.white == b.white && a.black == b.black;
+}
+
+void testArchive()
+{
+    const char *path = "chess_tests.cga";
+    const int Games = 100000;
+    ArchivedGame game = sampleGame();
+    std::remove(path);
+    {
+        GameArchiveWriter writer;
+        CHECK(writer.open(path));
+        for (int i = 0; i < Games; ++i) {
+            game.result = GameResult(i % 4);
+            writer.append(game);
+        }
+        writer.close();
+        CHECK(writer.gamesWritten() == uint64_t(Games));
+    }
+
+    GameArchiveReader reader;
+    CHECK(reader.open(path));
+    ArchivedGame read;
+    int count = 0;
+    bool same = true;
+    while (reader.next(read)) {
+        game.result = GameResult(count % 4);
+        same = same && sameGame(read, game);
+        ++count;
+    }
+    CHECK(count == Games);
+    CHECK(same);
+    CHECK(reader.skipped() == 0);
+
+    ArchivedGame custom;
+    custom.startFen = "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1";
+    custom.moves.push_back(createMove(25, 17));   // b5-b6
+    std::string encoded;
+    GameArchive::encode(custom, encoded);
+    size_t consumed = 0;
+    CHECK(GameArchive::decode(encoded.data(), encoded.size(), consumed, read));
+    CHECK(consumed == encoded.size());
+    CHECK(read.startFen == custom.startFen && read.moves == custom.moves);
+    CHECK(!GameArchive::decode(encoded.data(), encoded.size() - 1, consumed, read));
+
+    // Összeomlás a rekord írása közben: újranyitás után a csonka rekord helyére kerülnek az új játszmák
+    std::string torn;
+    GameArchive::encode(game, torn);
+    writeBytes(path, "ab", torn.data(), torn.size() / 2);
+    {
+        GameArchiveWriter writer;
+        CHECK(writer.open(path));
+        writer.append(custom);
+        writer.append(custom);
+    }
+    CHECK(reader.open(path));
+    count = 0;
+    while (reader.next(read)) ++count;
+    CHECK(count == Games + 2);
+    CHECK(read.startFen == custom.startFen);
+    CHECK(reader.skipped() == 0);
+
+    // Sérülés a fájl közepén: semmit nem vágunk le, az olvasó csak a hibás rekordot ugorja át
+    std::remove(path);
+    std::string record, customRecord;
+    GameArchive::encode(game, record);
+    GameArchive::encode(custom, customRecord);
+    {
+        GameArchiveWriter writer;
+        CHECK(writer.open(path));
+        for (int i = 0; i < 1000; ++i) writer.append(game);
+    }
+    if (FILE *file = std::fopen(path, "r+b")) {
+        long damaged = long(4 + 10 * record.size() + 20);   // A 11. játszma egyik lépése
+        std::fseek(file, damaged, SEEK_SET);
+        int byte = std::fgetc(file);
+        std::fseek(file, damaged, SEEK_SET);
+        std::fputc(byte ^ 0x40, file);
+        std::fclose(file);
+    }
+    {
+        GameArchiveWriter writer;
+        CHECK(writer.open(path));
+        writer.append(custom);
+    }
+    if (FILE *file = std::fopen(path, "rb")) {
+        std::fseek(file, 0, SEEK_END);
+        CHECK(uint64_t(std::ftell(file)) == 4 + 1000 * record.size() + customRecord.size());
+        std::fclose(file);
+    }
+    CHECK(reader.open(path));
+    count = 0;
+    while (reader.next(read)) ++count;
+    CHECK(count == 1000);
+    CHECK(read.startFen == custom.startFen);
+    CHECK(reader.skipped() == 1);
+
+    // A félbe írt fejléc még archívum, a más fájl nem
+    writeBytes(path, "wb", "CG", 2);
+    {
+        GameArchiveWriter writer;
+        CHECK(writer.open(path));
+        writer.append(custom);
+    }
+    CHECK(reader.open(path));
+    CHECK(reader.next(read) && !reader.next(read) && reader.skipped() == 0);
+    writeBytes(path, "wb", "PGN?", 4);
+    GameArchiveWriter refused;
+    CHECK(!refused.open(path));
+    std::remove(path);
+
+    const char *journalPath = "chess_tests.journal";
+    GameJournal journal;
+    CHECK(journal.begin(journalPath));
+    for (int i = 0; i < 5; ++i) journal.appendMove(game.moves[size_t(i)]);
+    ArchivedGame recovered;
+    GameJournal other;
+    CHECK(other.recover(journalPath, recovered));
+    CHECK(recovered.moves.size() == 5);
+    journal.discard();
+    CHECK(!other.recover(journalPath, recovered));
+}
+
+void testTrainingData()
+{
+    int mismatches = 0;
+    int samples = 0;
+    randomGames(3, 200, 150, [&](Position &position) {
+        TrainingSample sample;
+        int score = -123 + position.ply();
+        CHECK(TrainingData::pack(position, score, GameResult::Draw, sample));
+        // A teljes lépésszámot a fél lépésekből számoljuk, azt nem hasonlítjuk
+        std::string fen = TrainingData::fen(sample), expected = position.fen();
+        if (fen.substr(0, fen.rfind(' ')) != expected.substr(0, expected.rfind(' '))
+            || TrainingData::score(sample) != score || TrainingData::ply(sample) != position.ply()
+            || TrainingData::result(sample) != GameResult::Draw) ++mismatches;
+        ++samples;
+    });
+    CHECK(samples > 0);
+    CHECK(mismatches == 0);
+
+    const char *path = "chess_tests.ctd";
+    std::remove(path);
+    std::vector<TrainingSample> batch;
+    randomGames(4, 20, 100, [&](Position &position) {
+        TrainingSample sample;
+        if (TrainingData::pack(position, 0, GameResult::WhiteWins, sample)) batch.push_back(sample);
+    });
+    {
+        TrainingDataWriter writer;
+        CHECK(writer.open(path));
+        writer.append(batch);
+        writer.close();
+        CHECK(writer.samplesWritten() == batch.size());
+    }
+    TrainingDataReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.size() == batch.size());
+    TrainingSample sample;
+    size_t count = 0;
+    while (reader.next(sample)) {
+        if (count < batch.size()) CHECK(std::memcmp(sample.data, batch[count].data, sizeof(sample.data)) == 0);
+        ++count;
+    }
+    CHECK(count == batch.size());
+
+    // Összeomlás egy minta írása közben: újranyitás után a minták a helyükre kerülnek
+    writeBytes(path, "ab", batch[0].data, 13);
+    {
+        TrainingDataWriter writer;
+        CHECK(writer.open(path));
+        writer.append(batch);
+    }
+    CHECK(reader.open(path));
+    CHECK(reader.size() == 2 * batch.size());
+    count = 0;
+    bool same = true;
+    while (reader.next(sample)) {
+        same = same && std::memcmp(sample.data, batch[count % batch.size()].data, sizeof(sample.data)) == 0;
+        ++count;
+    }
+    CHECK(count == 2 * batch.size());
+    CHECK(same);
+
+    writeBytes(path, "wb", "CGA1", 4);
+    TrainingDataWriter refused;
+    CHECK(!refused.open(path));
+    std::remove(path);
+}
+
+void testGameRecord()
+{
+    // Főváltozat és minden ötödik csomópontból egy mellékváltozat; a goTo bármely
+    // két csomópont között ugyanazt az állást adja, mint a kezdőállásból visszajátszott vonal
+    const char *startFen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    std::mt19937 random(7);
+    GameRecord record(8);
+    CHECK(record.reset(startFen));
+    auto playRandom = [&](int plies) {
+        for (int i = 0; i < plies; ++i) {
+            Position position = record.position();
+            MoveList legal;
+            position.generateLegal(legal);
+            if (legal.count == 0) break;
+            CHECK(record.play(legal.moves[random() % uint32_t(legal.count)]) >= 0);
+        }
+    };
+    playRandom(120);
+    int mainEnd = record.current();
+    for (int node = 5; node < mainEnd; node += 5) {
+        CHECK(record.goTo(node));
+        playRandom(int(random() % 30));
+    }
+    CHECK(record.snapshotCount() > 1);
+
+    int mismatches = 0;
+    for (int jump = 0; jump < 2000; ++jump) {
+        int node = int(random() % uint32_t(record.nodeCount()));
+        CHECK(record.goTo(node));
+        Position expected;
+        expected.setFen(startFen);
+        for (Move move : record.line(node)) expected.makeMove(move);
+        if (record.current() != node || record.position().fen() != expected.fen()
+            || record.position().key() != expected.key() || record.position().ply() != expected.ply()) ++mismatches;
+        // A pillanatképből visszajátszott állásban is lehet visszalépni
+        if (node != GameRecord::Root) {
+            CHECK(record.back());
+            expected.unmakeMove();
+            if (record.position().fen() != expected.fen()) ++mismatches;
+        }
+    }
+    CHECK(mismatches == 0);
+
+    CHECK(record.goTo(GameRecord::Root));
+    CHECK(record.goToPly(40) && record.current() == 40);   // A főváltozat csomópontjai sorban jöttek létre
+    CHECK(!record.goTo(record.nodeCount()));
+    CHECK(!record.goTo(-1));
+}
+
+void testAnalysisCache()
+{
+    const char *path = "chess_tests.cache";
+    std::remove(path);
+    Position start;
+    start.setStartPosition();
+    Move e4 = start.parseUciMove("e2e4"), d4 = start.parseUciMove("d2d4"), e5 = createMove(12, 28);
+    const int Keys = 10000;
+    {
+        AnalysisCache cache;
+        CHECK(cache.open(path));
+        for (int i = 1; i <= Keys; ++i) {
+            AnalysisCache::Entry entry;
+            entry.bestMove = e4;
+            entry.score = i;
+            entry.depth = 10;
+            entry.pv = { e4, e5 };
+            cache.store(uint64_t(i), entry);
+        }
+        AnalysisCache::Entry mate;
+        mate.bestMove = d4;
+        mate.score = 3;
+        mate.mate = true;
+        mate.depth = 20;
+        cache.store(start.key(), mate);
+    }
+
+    // Újranyitás után minden megvan; a csonka utolsó rekordot az open() levágja
+    writeBytes(path, "ab", "torn", 4);
+    AnalysisCache cache;
+    CHECK(cache.open(path));
+    CHECK(cache.size() == Keys + 1);
+    AnalysisCache::Entry entry;
+    CHECK(cache.probe(uint64_t(77), 10, entry) && entry.score == 77 && entry.bestMove == e4);
+    CHECK(entry.pv.size() == 2 && entry.pv[1] == e5);
+    CHECK(!cache.probe(uint64_t(77), 11, entry));
+    CHECK(!cache.probe(uint64_t(Keys + 1), 0, entry));
+    CHECK(cache.probe(start, 20, entry) && entry.mate && entry.score == 3 && entry.bestMove == d4);
+
+    // Mélyebb eredmény felülírja, sekélyebb vagy egyenlő nem
+    AnalysisCache::Entry deeper;
+    deeper.bestMove = d4;
+    deeper.score = -5;
+    deeper.depth = 12;
+    cache.store(uint64_t(77), deeper);
+    AnalysisCache::Entry shallower = deeper;
+    shallower.score = 99;
+    shallower.depth = 9;
+    cache.store(uint64_t(78), shallower);
+    CHECK(cache.probe(uint64_t(77), 12, entry) && entry.score == -5);
+    CHECK(cache.probe(uint64_t(78), 10, entry) && entry.score == 78);
+
+    // Kulcsütközés elleni védelem: az állásban nem lépés legjobb lépés nem találat
+    Position other;
+    other.setFen("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1");
+    AnalysisCache::Entry foreign;
+    foreign.bestMove = d4;   // A d2 mező üres
+    foreign.depth = 5;
+    cache.store(other.key(), foreign);
+    CHECK(!cache.probe(other, 0, entry));
+    cache.close();
+
+    CHECK(cache.open(path));
+    CHECK(cache.size() == Keys + 2);
+    CHECK(cache.probe(uint64_t(77), 12, entry) && entry.score == -5 && entry.bestMove == d4);
+    cache.close();
+    if (FILE *file = std::fopen(path, "rb")) {
+        std::fseek(file, 0, SEEK_END);
+        CHECK(std::ftell(file) == long(16 + (Keys + 3) * 40));   // Fejléc és rekordok, a csonka vég nélkül
+        std::fclose(file);
+    }
+    std::remove(path);
+}
+
+void testAnalysisTree()
+{
+    // 1. Nf3 Nc6 2. Nc3 és 1. Nc3 Nc6 2. Nf3 ugyanabba a csomópontba fut
+    AnalysisTree tree;
+    Position position;
+    position.setStartPosition();
+    uint32_t root = tree.add(position);
+    auto playLine = [&](std::initializer_list<const char *> moves) {
+        Position line;
+        line.setStartPosition();
+        uint32_t node = root;
+        for (const char *uci : moves) {
+            Move move = line.parseUciMove(uci);
+            line.makeMove(move);
+            node = tree.addChild(node, move, line);
+        }
+        return node;
+    };
+    uint32_t first = playLine({ "g1f3", "b8c6", "b1c3" });
+    uint32_t second = playLine({ "b1c3", "b8c6", "g1f3" });
+    CHECK(first == second);
+    CHECK(tree.parentCount(first) == 2);
+    CHECK(tree.nodeCount() == 6 && tree.edgeCount() == 6);
+    CHECK(playLine({ "g1f3", "b8c6", "b1c3" }) == first && tree.edgeCount() == 6);   // Meglévő él
+
+    // Az egyik vonalon talált eredményt a másik is látja; sekélyebb nem írja felül
+    AnalysisTree::Result result;
+    result.score = 35;
+    result.depth = 18;
+    result.bestMove = createMove(12, 28);
+    CHECK(tree.store(first, result));
+    Position other;
+    other.setStartPosition();
+    uint32_t node = root;
+    for (const char *uci : { "b1c3", "b8c6", "g1f3" }) {
+        Move move = other.parseUciMove(uci);
+        other.makeMove(move);
+        node = tree.child(node, move);
+    }
+    CHECK(node == first && tree.find(other.key()) == first);
+    CHECK(tree.result(node).score == 35 && tree.result(node).depth == 18);
+    result.depth = 10;
+    result.score = -100;
+    CHECK(!tree.store(node, result));
+    CHECK(tree.result(node).score == 35);
+
+    // A teljes 3 mélységű fa: csomópont állásonként egy, él szülő-lépés páronként egy
+    tree.clear();
+    position.setStartPosition();
+    root = tree.add(position);
+    std::set<uint64_t> keys = { position.key() };
+    size_t edges = 0;
+    int wrongNodes = 0;
+    std::function<void(uint32_t, int)> expand = [&](uint32_t parent, int depth) {
+        MoveList legal;
+        position.generateLegal(legal);
+        for (int i = 0; i < legal.count; ++i) {
+            position.makeMove(legal.moves[i]);
+            keys.insert(position.key());
+            ++edges;
+            uint32_t child = tree.addChild(parent, legal.moves[i], position);
+            if (tree.key(child) != position.key()) ++wrongNodes;
+            if (depth > 1) expand(child, depth - 1);
+            position.unmakeMove();
+        }
+    };
+    expand(root, 3);
+    CHECK(wrongNodes == 0);
+    CHECK(tree.nodeCount() == keys.size());
+    CHECK(tree.edgeCount() == edges);
+    size_t parents = 0;
+    for (uint32_t id = 0; id < uint32_t(tree.nodeCount()); ++id) parents += size_t(tree.parentCount(id));
+    CHECK(parents == edges);
+    CHECK(tree.parentCount(root) == 0);
+}
+
+void testSan()
+{
+    struct Case { const char *fen; const char *move; const char *san; };
+    const Case cases[] = {
+        { "4k3/8/8/8/8/8/8/1N1K1N2 w - - 0 1", "b1d2", "Nbd2" },         // Oszlop dönt
+        { "4k3/8/8/R7/8/8/8/R3K3 w - - 0 1", "a1a3", "R1a3" },           // Egy oszlopban: sor dönt
+        { "4k3/8/8/R7/8/8/8/R3K3 w - - 0 1", "a5a3", "R5a3" },
+        { "4k3/8/8/8/8/Q7/8/Q1Q1K3 w - - 0 1", "a1b2", "Qa1b2" },        // Oszlop és sor is kell
+        { "k3r3/8/8/8/8/8/N3N3/4K3 w - - 0 1", "a2c3", "Nc3" },          // A kötött huszár nem számít
+        { "4k3/8/8/8/8/8/8/R3K3 w - - 0 1", "a1a8", "Ra8+" },
+        { "6k1/5ppp/8/8/8/8/8/R3K3 w - - 0 1", "a1a8", "Ra8#" },
+        { "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1g1", "O-O" },
+        { "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", "e1c1", "O-O-O" },
+        { "1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", "a7b8q", "axb8=Q+" },
+        { "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", "exd6" },
+    };
+    for (const Case &test : cases) {
+        Position position;
+        CHECK(position.setFen(test.fen));
+        Move move = position.parseUciMove(test.move);
+        CHECK(move != NoMove);
+        std::string san = position.moveToSan(move);
+        CHECK(san == test.san);
+        if (san != test.san) std::fprintf(stderr, "  %s %s = %s, expected %s\n", test.fen, test.move, san.c_str(), test.san);
+        CHECK(position.fen() == test.fen);
+    }
+
+    // Egy állás legális lépéseinek SAN alakja mind különböző
+    int collisions = 0;
+    randomGames(8, 100, 150, [&](Position &position) {
+        MoveList legal;
+        position.generateLegal(legal);
+        std::set<std::string> names;
+        for (int i = 0; i < legal.count; ++i) names.insert(position.moveToSan(legal.moves[i]));
+        if (int(names.size()) != legal.count) ++collisions;
+    });
+    CHECK(collisions == 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    struct Group { const char *name; void (*run)(); };
+    const Group groups[] = {
+        { "perft", testPerft },
+        { "positions", testPositions },
+        { "attackmap", testAttackMap },
+        { "archive", testArchive },
+        { "trainingdata", testTrainingData },
+        { "gamerecord", testGameRecord },
+        { "analysiscache", testAnalysisCache },
+        { "analysistree", testAnalysisTree },
+        { "san", testSan },
+    };
+
+    for (const Group &group : groups) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) selected = selected || std::strcmp(argv[i], group.name) == 0;
+        if (!selected) continue;
+        int before = failures;
+        group.run();
+        std::printf("%-14s %s\n", group.name, failures == before ? "ok" : "FAILED");
+    }
+    return failures ? 1 : 0;
+}
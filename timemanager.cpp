@@ -0,0 +1,28 @@
+#include "timemanager.h"
+#include <algorithm>
+
+void TimeManager::init(int timeLeft, int increment, int movesToGo, int ply)
+{
+    int available = std::max(timeLeft - MoveOverhead, 1);
+
+    // Ha nincs megadva a hátralévő lépések száma, a játszma elején többet,
+    // később kevesebbet feltételezünk
+    int movesLeft = movesToGo > 0 ? std::min(movesToGo, 50) : std::max(40 - ply / 4, 20);
+
+    optimum = available / movesLeft + increment * 3 / 4;
+    maximum = std::min(available * 4 / 5, optimum * 5);
+
+    // Bullet: nagyon kevés időnél az inkrementre támaszkodunk, de sosem lépjük túl a maradékot
+    optimum = std::max(1, std::min(optimum, maximum));
+    maximum = std::max(optimum, maximum);
+}
+
+bool TimeManager::shouldStop(int elapsed, int stability) const
+{
+    // Stabil legjobb lépésnél korábban megállunk, változékony állásban tovább gondolkodunk
+    int scale = std::max(50, 160 - 25 * stability);   // százalékban
+    int target = optimum * scale / 100;
+
+    // A következő iteráció kb. 2-3-szor annyi ideig tart, így a cél felénél már nem kezdünk újat
+    return elapsed * 2 >= target;
+}
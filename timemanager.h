@@ -0,0 +1,26 @@
+#ifndef TIMEMANAGER_H
+#define TIMEMANAGER_H
+
+// Splits the remaining clock time of the side to move into a per-move budget.
+// optimumTime is the soft target the search aims for when the best move is
+// stable, maximumTime is the hard limit it never exceeds.
+class TimeManager
+{
+public:
+    void init(int timeLeft, int increment, int movesToGo, int ply);
+
+    int optimumTime() const { return optimum; }
+    int maximumTime() const { return maximum; }
+
+    // Called after every completed iteration. stability is the number of
+    // consecutive iterations that returned the same best move.
+    bool shouldStop(int elapsed, int stability) const;
+
+    static const int MoveOverhead = 30;   // ms reserved for GUI and process latency
+
+private:
+    int optimum = 0;
+    int maximum = 0;
+};
+
+#endif // TIMEMANAGER_H
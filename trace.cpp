@@ -0,0 +1,143 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+std::atomic<bool> enabledFlag { false };
+
+namespace {
+
+struct Event
+{
+    const char *name;
+    int64_t timestamp;   // ns since Trace::start
+    char phase;          // 'B', 'E' or 'i'
+};
+
+// Egyetlen író (a saját szál), olvasni csak a fájl kiírásakor olvasunk
+struct ThreadBuffer
+{
+    static const uint32_t Capacity = 1 << 16;
+
+    Event events[Capacity];
+    std::atomic<uint64_t> head { 0 };
+    int threadId = 0;
+    std::string threadName;
+};
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;   // Kilépett szálak puffereit is megtartjuk
+std::string outputPath;
+std::chrono::steady_clock::time_point startTime;
+
+ThreadBuffer *threadBuffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.emplace_back(new ThreadBuffer);
+        buffer = registry.back().get();
+        buffer->threadId = int(registry.size());
+    }
+    return buffer;
+}
+
+void record(const char *name, char phase)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    uint64_t index = buffer->head.load(std::memory_order_relaxed);
+    Event &event = buffer->events[index & (ThreadBuffer::Capacity - 1)];
+    event.name = name;
+    event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+    event.phase = phase;
+    buffer->head.store(index + 1, std::memory_order_release);
+}
+
+void writeString(std::ofstream &out, const std::string &text)
+{
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+} // namespace
+
+void start(const std::string &path)
+{
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        outputPath = path;
+        startTime = std::chrono::steady_clock::now();
+        for (auto &buffer : registry) buffer->head.store(0, std::memory_order_relaxed);
+    }
+    enabledFlag.store(true, std::memory_order_release);
+}
+
+bool stop()
+{
+    if (!enabledFlag.exchange(false)) return true;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::ofstream out(outputPath);
+    if (!out) return false;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (auto &buffer : registry) {
+        if (!buffer->threadName.empty()) {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId
+                << ",\"args\":{\"name\":";
+            writeString(out, buffer->threadName);
+            out << "}}";
+            first = false;
+        }
+
+        // Körpuffer: ha körbeért, csak az utolsó Capacity eseményt írjuk ki
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t begin = head > ThreadBuffer::Capacity ? head - ThreadBuffer::Capacity : 0;
+        for (uint64_t i = begin; i < head; ++i) {
+            const Event &event = buffer->events[i & (ThreadBuffer::Capacity - 1)];
+            out << (first ? "" : ",\n") << "{\"name\":";
+            writeString(out, event.name);
+            out << ",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestamp / 1000 << '.'
+                << (event.timestamp % 1000) / 100 << ",\"pid\":1,\"tid\":" << buffer->threadId;
+            if (event.phase == 'i') out << ",\"s\":\"t\"";
+            out << '}';
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+    return bool(out);
+}
+
+void begin(const char *name)
+{
+    if (enabled()) record(name, 'B');
+}
+
+void end(const char *name)
+{
+    if (enabled()) record(name, 'E');
+}
+
+void instant(const char *name)
+{
+    if (enabled()) record(name, 'i');
+}
+
+void setThreadName(const char *name)
+{
+    ThreadBuffer *buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->threadName = name;
+}
+
+} // namespace Trace
@@ -0,0 +1,50 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <string>
+
+// Begin/end event tracing in the Chrome trace event format
+// (chrome://tracing, ui.perfetto.dev).
+// Every thread writes into its own fixed-size ring buffer without locking;
+// the buffers are only read when the trace file is written. Event names must
+// be string literals, they are stored as pointers.
+// When tracing is off a TRACE_SCOPE costs one relaxed load and one branch;
+// direct begin/end/instant calls are no-ops as well.
+namespace Trace {
+
+extern std::atomic<bool> enabledFlag;
+
+inline bool enabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+void start(const std::string &path);
+bool stop();   // Writes the trace file, returns false on I/O error
+
+void begin(const char *name);
+void end(const char *name);
+void instant(const char *name);
+void setThreadName(const char *name);
+
+class Scope
+{
+public:
+    explicit Scope(const char *name) : name(enabled() ? name : nullptr)
+    {
+        if (this->name) begin(this->name);
+    }
+    ~Scope()
+    {
+        if (name) end(name);
+    }
+
+private:
+    const char *name;
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+#endif // TRACE_H
@@ -0,0 +1,185 @@
+#include "trainingdata.h"
+#include "logger.h"
+#include <cstring>
+
+namespace {
+
+const char Magic[4] = { 'C', 'T', 'D', '1' };
+const char pieceCodes[] = "PNBRQKpnbrqk";
+const size_t ChunkSamples = 32768;   // 1 MB olvasásonként
+
+int pieceCode(char piece)
+{
+    for (int i = 0; i < 12; ++i) {
+        if (pieceCodes[i] == piece) return i;
+    }
+    return -1;
+}
+
+} // namespace
+
+namespace TrainingData {
+
+bool pack(const Position &position, int score, GameResult result, TrainingSample &sample)
+{
+    std::memset(sample.data, 0, sizeof(sample.data));
+    uint64_t occupied = 0;
+    int pieces = 0;
+    for (int square = 0; square < 64; ++square) {
+        int code = pieceCode(position.pieceAt(square));
+        if (code < 0) continue;
+        if (pieces == 32) return false;
+        occupied |= uint64_t(1) << square;
+        sample.data[8 + pieces / 2] |= uint8_t(code << (4 * (pieces % 2)));
+        ++pieces;
+    }
+    for (int i = 0; i < 8; ++i) sample.data[i] = uint8_t(occupied >> (8 * i));
+
+    sample.data[24] = uint8_t((position.whiteToMove() ? 0 : 1) | (position.castlingRights() << 1));
+    sample.data[25] = uint8_t(position.enPassantSquare() < 0 ? 64 : position.enPassantSquare());
+    sample.data[26] = uint8_t(position.halfmoveClock() < 255 ? position.halfmoveClock() : 255);
+    sample.data[27] = uint8_t(result);
+    int16_t clamped = int16_t(score < -32767 ? -32767 : score > 32767 ? 32767 : score);
+    sample.data[28] = uint8_t(uint16_t(clamped) & 0xFF);
+    sample.data[29] = uint8_t(uint16_t(clamped) >> 8);
+    int ply = position.ply() < 65535 ? position.ply() : 65535;
+    sample.data[30] = uint8_t(ply & 0xFF);
+    sample.data[31] = uint8_t(ply >> 8);
+    return true;
+}
+
+std::string fen(const TrainingSample &sample)
+{
+    uint64_t occupied = 0;
+    for (int i = 0; i < 8; ++i) occupied |= uint64_t(sample.data[i]) << (8 * i);
+
+    std::string result;
+    int pieces = 0;
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            int square = row * 8 + col;
+            if (!((occupied >> square) & 1)) {
+                ++empty;
+                continue;
+            }
+            int code = (sample.data[8 + pieces / 2] >> (4 * (pieces % 2))) & 15;
+            ++pieces;
+            if (empty) result += char('0' + empty);
+            empty = 0;
+            result += code < 12 ? pieceCodes[code] : '?';
+        }
+        if (empty) result += char('0' + empty);
+        if (row < 7) result += '/';
+    }
+
+    int flags = sample.data[24];
+    result += (flags & 1) ? " b " : " w ";
+    int castling = flags >> 1;
+    if (castling & WhiteKingSide) result += 'K';
+    if (castling & WhiteQueenSide) result += 'Q';
+    if (castling & BlackKingSide) result += 'k';
+    if (castling & BlackQueenSide) result += 'q';
+    if (!castling) result += '-';
+
+    int enPassant = sample.data[25];
+    if (enPassant < 64) {
+        result += ' ';
+        result += char('a' + enPassant % 8);
+        result += char('0' + 8 - enPassant / 8);
+    } else {
+        result += " -";
+    }
+    result += ' ' + std::to_string(sample.data[26]) + ' ' + std::to_string(ply(sample) / 2 + 1);
+    return result;
+}
+
+int score(const TrainingSample &sample)
+{
+    return int16_t(uint16_t(sample.data[28] | (sample.data[29] << 8)));
+}
+
+GameResult result(const TrainingSample &sample)
+{
+    return GameResult(sample.data[27] & 3);
+}
+
+void setResult(TrainingSample &sample, GameResult result)
+{
+    sample.data[27] = uint8_t(result);
+}
+
+int ply(const TrainingSample &sample)
+{
+    return sample.data[30] | (sample.data[31] << 8);
+}
+
+} // namespace TrainingData
+
+bool TrainingDataWriter::open(const std::string &path)
+{
+    close();
+    if (FILE *existing = std::fopen(path.c_str(), "rb")) {
+        char magic[4];
+        size_t read = std::fread(magic, 1, 4, existing);
+        std::fseek(existing, 0, SEEK_END);
+        uint64_t size = uint64_t(std::ftell(existing));
+        std::fclose(existing);
+        if (std::memcmp(magic, Magic, read) != 0) {
+            LOG_ERROR("training_data_not_ctd", {"path", path});
+            return false;
+        }
+        uint64_t valid = read == 4 ? 4 + (size - 4) / sizeof(TrainingSample) * sizeof(TrainingSample) : 0;
+        if (!truncateTornTail(path, valid)) return false;
+    }
+    return appender.open(path, std::string(Magic, 4));
+}
+
+void TrainingDataWriter::append(std::vector<TrainingSample> samples)
+{
+    if (!samples.empty()) appender.append(std::move(samples));
+}
+
+void TrainingDataWriter::encode(const std::vector<TrainingSample> &samples, std::string &out)
+{
+    out.append(reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(TrainingSample));
+}
+
+TrainingDataReader::~TrainingDataReader()
+{
+    if (file) std::fclose(file);
+}
+
+bool TrainingDataReader::open(const std::string &path)
+{
+    if (file) std::fclose(file);
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    char magic[4];
+    if (std::fread(magic, 1, 4, file) != 4 || std::memcmp(magic, Magic, 4) != 0) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    total = uint64_t(std::ftell(file) - 4) / sizeof(TrainingSample);
+    std::fseek(file, 4, SEEK_SET);
+    buffer.clear();
+    position = 0;
+    return true;
+}
+
+bool TrainingDataReader::next(TrainingSample &sample)
+{
+    if (position == buffer.size()) {
+        if (!file) return false;
+        // Csonka utolsó mintát az fread egész rekordos számlálása eldob
+        buffer.resize(ChunkSamples);
+        buffer.resize(std::fread(buffer.data(), sizeof(TrainingSample), ChunkSamples, file));
+        position = 0;
+        if (buffer.empty()) return false;
+    }
+    sample = buffer[position++];
+    return true;
+}
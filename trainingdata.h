@@ -0,0 +1,82 @@
+#ifndef TRAININGDATA_H
+#define TRAININGDATA_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "position.h"
+#include "gamearchive.h"
+#include "fileappender.h"
+
+// Labelled positions for evaluation training.
+//
+// File: "CTD1" followed by fixed 32 byte samples (little endian):
+//   0-7    occupancy bitboard, bit n = square n (Position layout, 0 = a8)
+//   8-23   one 4 bit piece code per occupied square in square order, low
+//          nibble first; code = index in "PNBRQKpnbrqk"
+//   24     bit 0 black to move, bits 1-4 castling rights
+//   25     en passant square, 64 = none
+//   26     halfmove clock (saturates at 255)
+//   27     game result (GameResult)
+//   28-29  search score in centipawns, side to move's point of view
+//   30-31  ply of the game
+// Fixed size records can be shuffled and indexed without parsing; a torn
+// sample at the end of the file is ignored by the reader and cut off when the
+// writer opens the file again.
+
+struct TrainingSample
+{
+    uint8_t data[32];
+};
+
+namespace TrainingData {
+
+// false if the position has more than 32 pieces
+bool pack(const Position &position, int score, GameResult result, TrainingSample &sample);
+std::string fen(const TrainingSample &sample);
+int score(const TrainingSample &sample);
+GameResult result(const TrainingSample &sample);
+void setResult(TrainingSample &sample, GameResult result);   // A játszma végén derül ki
+int ply(const TrainingSample &sample);
+
+} // namespace TrainingData
+
+// Appends samples from a background thread (FileAppender), one batch per
+// finished game. append() waits while 1024 batches are queued, so a generator
+// that outruns the disk is slowed down instead of piling up samples in memory.
+class TrainingDataWriter
+{
+public:
+    // false if the file exists but is not CTD1; a torn last sample is removed
+    bool open(const std::string &path);
+    void append(std::vector<TrainingSample> samples);
+    void close() { appender.close(); }
+    bool isOpen() const { return appender.isOpen(); }
+
+    uint64_t samplesWritten() const { return appender.bytesWritten() / sizeof(TrainingSample); }
+
+private:
+    static void encode(const std::vector<TrainingSample> &samples, std::string &out);
+
+    FileAppender<std::vector<TrainingSample>> appender { encode, "training data writer", 1024 };
+};
+
+// Streams the file in large chunks, so data sets bigger than memory work
+class TrainingDataReader
+{
+public:
+    ~TrainingDataReader();
+
+    bool open(const std::string &path);
+    bool next(TrainingSample &sample);   // false at the end
+    uint64_t size() const { return total; }   // Teljes minták a fájlban
+
+private:
+    FILE *file = nullptr;
+    std::vector<TrainingSample> buffer;
+    size_t position = 0;
+    uint64_t total = 0;
+};
+
+#endif // TRAININGDATA_H
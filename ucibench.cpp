@@ -0,0 +1,192 @@
+#include "uciengine.h"
+#include "latency.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+
+// Protocol-layer benchmark of UCIEngine against chess_mockengine (or any engine).
+//
+//   chess_ucibench [--engine path] [--iterations 1000] [--info 10] [--rate 0]
+//                  [--delay 0] [--stream-ms 1000] [--transcript file] [--json out.json]
+//
+// Measures engine startup (start -> uciok + options), the round trip of
+// "position + go" -> searchFinished, and how many info lines per second the
+// adapter parses during "go infinite". The mock options are passed through,
+// so the same run is reproducible on any machine without a real engine.
+
+namespace {
+
+// Egy jelzésre vár, legfeljebb timeoutMs ideig; false, ha lejárt
+template<class Signal>
+bool waitFor(UCIEngine &engine, Signal signal, int timeoutMs)
+{
+    QEventLoop loop;
+    bool fired = false;
+    QObject::connect(&engine, signal, &loop, [&]() {
+        fired = true;
+        loop.quit();
+    });
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return fired;
+}
+
+// Egy címkézett keresés válaszára vár; a többi kérés searchFinished-je nem számít
+bool waitForSearch(UCIEngine &engine, UCIEngine::RequestId id, int timeoutMs)
+{
+    QEventLoop loop;
+    bool fired = false;
+    QObject::connect(&engine, &UCIEngine::searchFinished, &loop, [&](quint64 finished) {
+        if (finished != id) return;
+        fired = true;
+        loop.quit();
+    });
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return fired;
+}
+
+// Megvárja, hogy a motor minden kiadott keresésre (a leállítottakra is) válaszoljon
+bool waitUntilIdle(UCIEngine &engine, int timeoutMs)
+{
+    QElapsedTimer clock;
+    clock.start();
+    while (engine.expectsBestMove() && clock.elapsed() < timeoutMs) {
+        QEventLoop loop;
+        QTimer::singleShot(1, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    return !engine.expectsBestMove();
+}
+
+QJsonObject histogramJson(const LatencyHistogram &histogram)
+{
+    QJsonObject object;
+    object["count"] = qint64(histogram.count());
+    object["mean_us"] = qint64(histogram.mean());
+    object["p50_us"] = qint64(histogram.percentile(0.50));
+    object["p99_us"] = qint64(histogram.percentile(0.99));
+    object["max_us"] = qint64(histogram.max());
+    return object;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    EngineSettings settings;
+    settings.path = QStandardPaths::findExecutable("chess_mockengine", { QCoreApplication::applicationDirPath() });
+    int iterations = 1000;
+    int streamMs = 1000;
+    QString jsonPath;
+    QStringList mockArguments;
+    QStringList args = app.arguments();
+    for (int i = 1; i < args.size(); ++i) {
+        bool hasValue = i + 1 < args.size();
+        if (args[i] == "--engine" && hasValue) settings.path = args[++i];
+        else if (args[i] == "--iterations" && hasValue) iterations = args[++i].toInt();
+        else if (args[i] == "--stream-ms" && hasValue) streamMs = args[++i].toInt();
+        else if (args[i] == "--json" && hasValue) jsonPath = args[++i];
+        else if ((args[i] == "--info" || args[i] == "--rate" || args[i] == "--delay" || args[i] == "--transcript") && hasValue) {
+            mockArguments << args[i] << args[i + 1];   // A mock motornak szól
+            ++i;
+        }
+    }
+
+    QTextStream out(stdout);
+    if (settings.path.isEmpty()) {
+        out << "chess_mockengine not found, use --engine\n";
+        return 1;
+    }
+    settings.arguments = mockArguments;
+
+    // Az opció-gyorsítótár ne a felhasználó chess.ini-jébe kerüljön
+    QTemporaryDir settingsDir;
+    qputenv("CHESS_SETTINGS", settingsDir.filePath("chess.ini").toUtf8());
+
+    UCIEngine engine;
+    engine.setSettings(settings);
+
+    QElapsedTimer timer;
+    timer.start();
+    engine.startEngine();
+    if (!waitFor(engine, &UCIEngine::engineReady, 10000)) {
+        out << "Engine did not reach uciok: " << settings.path << "\n";
+        return 1;
+    }
+    qint64 startupUs = timer.nsecsElapsed() / 1000;
+
+    // Körút: néhány különböző állás, hogy a motor ne ugyanazt a sort ismételje
+    const QStringList openings[] = { {}, { "e2e4" }, { "e2e4", "e7e5" }, { "d2d4", "g8f6", "c2c4" } };
+    LatencyHistogram roundTrip;
+    SearchLimits limits;
+    limits.movetime = 1;
+    int timeouts = 0;
+    timer.restart();
+    for (int i = 0; i < iterations; ++i) {
+        QElapsedTimer request;
+        request.start();
+        UCIEngine::RequestId id = engine.requestSearch(openings[i % 4], QString(), limits);
+        if (!waitForSearch(engine, id, 5000)) {
+            ++timeouts;
+            // "stop", és a késő bestmove-ot itt várjuk ki, hogy ne a következő körút idejébe essen
+            engine.cancel(id);
+            if (!waitUntilIdle(engine, 5000)) {
+                out << "Engine did not answer stop, round trips aborted\n";
+                break;
+            }
+            continue;
+        }
+        roundTrip.record(request.nsecsElapsed() / 1000);
+    }
+    double roundTripSeconds = timer.nsecsElapsed() / 1e9;
+
+    // Info-folyam: minden analysisUpdated egy feldolgozott változatsor
+    quint64 infoLines = 0;
+    QObject::connect(&engine, &UCIEngine::analysisUpdated, &engine, [&]() { ++infoLines; });
+    engine.startAnalysis({ "e2e4" });
+    timer.restart();
+    QEventLoop streamLoop;
+    QTimer::singleShot(streamMs, &streamLoop, &QEventLoop::quit);
+    streamLoop.exec();
+    engine.stopAnalysis();
+    double streamSeconds = timer.nsecsElapsed() / 1e9;
+
+    double movesPerSecond = roundTripSeconds > 0 ? roundTrip.count() / roundTripSeconds : 0;
+    double infoPerSecond = streamSeconds > 0 ? infoLines / streamSeconds : 0;
+    out << QString("startup            %1 us\n").arg(startupUs);
+    out << QString("round trip         %1 req/s, p50 %2 us, p99 %3 us, max %4 us, %5 timeouts\n")
+               .arg(movesPerSecond, 0, 'f', 1).arg(roundTrip.percentile(0.50)).arg(roundTrip.percentile(0.99))
+               .arg(roundTrip.max()).arg(timeouts);
+    out << QString("info stream        %1 lines/s (%2 lines)\n").arg(infoPerSecond, 0, 'f', 0).arg(infoLines);
+    out.flush();
+
+    if (!jsonPath.isEmpty()) {
+        QJsonObject root;
+        root["version"] = 1;
+        root["engine"] = settings.path;
+        root["arguments"] = mockArguments.join(' ');
+        root["startup_us"] = startupUs;
+        root["round_trip"] = histogramJson(roundTrip);
+        root["round_trips_per_second"] = movesPerSecond;
+        root["timeouts"] = timeouts;
+        root["info_lines_per_second"] = infoPerSecond;
+
+        QFile file(jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            out << "Cannot write " << jsonPath << "\n";
+            return 1;
+        }
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    }
+    return timeouts ? 2 : 0;
+}
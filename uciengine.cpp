@@ -1,45 +1,204 @@
-#include "UCIEngine.h"
-#include <QDebug>
-#include <QThread>
+#include "uciengine.h"
 #include <QDir>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include <algorithm>
+#include "timemanager.h"
+#include "trace.h"
+#include "logger.h"
 
-UCIEngine::UCIEngine(QObject *parent) : QObject(parent), uciProcess(new QProcess(this)) // Dinamikusan létrehozott QProcess
+QString EngineSettings::settingsFile()
+{
+    QString file = qEnvironmentVariable("CHESS_SETTINGS");
+    if (!file.isEmpty()) return file;
+    // A program könyvtára gyakran írásvédett (Program Files, /usr/bin): a felhasználói beállítások közé kerül
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+    QDir().mkpath(dir);
+    return dir + "/chess.ini";
+}
+
+EngineSettings EngineSettings::load()
+{
+    QSettings file(settingsFile(), QSettings::IniFormat);
+    EngineSettings settings;
+
+    // Üres útvonal = nincs beállított motor; a PATH-ban lévő stockfish-t később is megtaláljuk
+    settings.path = file.value("engine/path").toString();
+    if (settings.path.isEmpty()) settings.path = QStandardPaths::findExecutable("stockfish");
+    settings.arguments = file.value("engine/arguments").toStringList();
+    settings.hash = file.value("engine/hash", settings.hash).toInt();
+    settings.threads = file.value("engine/threads", settings.threads).toInt();
+    settings.skill = file.value("engine/skill", settings.skill).toInt();
+
+    // A program könyvtára gyakran írásvédett: az adatfájlok alapból a felhasználói adatkönyvtárba kerülnek,
+    // ha az sem hozható létre, kikapcsolva maradnak
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (!dataDir.isEmpty() && !QDir().mkpath(dataDir)) dataDir.clear();
+    auto dataFile = [&dataDir](const char *name) { return dataDir.isEmpty() ? QString() : dataDir + "/" + name; };
+    settings.cachePath = file.value("analysisCache/path", dataFile("analysis.cache")).toString();
+    settings.cacheDepth = file.value("analysisCache/depth", settings.cacheDepth).toInt();
+    settings.archivePath = file.value("games/archive", dataFile("games.cga")).toString();
+    settings.journalPath = file.value("games/journal", dataFile("current.journal")).toString();
+
+    // Első futáskor kiírjuk az alapértékeket, hogy a fájl szerkeszthető legyen
+    if (!file.contains("engine/path")) {
+        file.setValue("engine/path", settings.path);
+        file.setValue("engine/hash", settings.hash);
+        file.setValue("engine/threads", settings.threads);
+        file.setValue("engine/skill", settings.skill);
+        file.setValue("analysisCache/path", settings.cachePath);
+        file.setValue("analysisCache/depth", settings.cacheDepth);
+        file.setValue("games/archive", settings.archivePath);
+        file.setValue("games/journal", settings.journalPath);
+    }
+    return settings;
+}
+
+UCIEngine::UCIEngine(QObject *parent)
+    : QObject(parent)
+    , uciProcess(new QProcess(this)) // Dinamikusan létrehozott QProcess
+    , watchdog(new QTimer(this))
+    , recoveryDeadline(new QTimer(this))
 {
-    enginePath = QDir::toNativeSeparators("C:/Users/Mark/Documents/grafikus_felhasznaloi_feluletek_fejlesztese_C++_nyelven/chess/stockfish/stockfish/stockfish-windows-x86-64-avx2.exe");
-    uciProcess->setProgram(enginePath);
     uciProcess->setProcessChannelMode(QProcess::SeparateChannels);
+    sessionClock.start();
+    watchdog->setSingleShot(true);
+    recoveryDeadline->setSingleShot(true);
+    connect(watchdog, &QTimer::timeout, this, &UCIEngine::onSearchHung);
+    connect(recoveryDeadline, &QTimer::timeout, this, &UCIEngine::onRecoveryTimeout);
+    connect(uciProcess, &QProcess::started, this, [this]() {
+        Trace::instant("engine started");
+        LOG_INFO("engine_started", {"path", engineSettings.path});
+        uciProcess->write("uci\n");   // Az uciok-ig a többi parancs várakozik
+    });
+    connect(uciProcess, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) {
+            LOG_ERROR("engine_start_failed", {"path", engineSettings.path}, {"error", uciProcess->errorString()});
+            pendingCommands.clear();
+            if (recovering) {
+                ++engineHealth.failedRecoveries;
+                scheduleRecovery("start_failed");
+            }
+        }
+    });
+    connect(uciProcess, &QProcess::readyReadStandardOutput, this, &UCIEngine::handleEngineOutput);
+    connect(uciProcess, &QProcess::readyReadStandardError, this, &UCIEngine::handleEngineErrorOutput);
+    connect(uciProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &UCIEngine::handleProcessFinished);
 }
 
 UCIEngine::~UCIEngine()
 {
-    sendCommand("quit");
-    uciProcess->waitForFinished();
+    shuttingDown = true;   // A saját leállítás nem összeomlás
+    if (uciProcess->state() == QProcess::Running) {
+        uciProcess->write("quit\n");
+        if (!uciProcess->waitForFinished(1000)) uciProcess->kill();
+    }
     delete uciProcess; // Memória felszabadítása
 }
 
+void UCIEngine::setSettings(const EngineSettings &settings)
+{
+    engineSettings = settings;
+    uciProcess->setProgram(settings.path);
+    uciProcess->setArguments(settings.arguments);
+    loadOptionCache();
+    if (ready) applySettings();
+}
+
 void UCIEngine::startEngine()
 {
-    if (uciProcess->state() == QProcess::Running) {
-        qDebug() << "⚠️ A sakkmotor már fut!";
+    TRACE_SCOPE("UCIEngine::startEngine");
+    if (uciProcess->state() != QProcess::NotRunning) {
+        LOG_WARNING("engine_already_running");
         return;
     }
-    uciProcess->start();
-    if (!uciProcess->waitForStarted(5000)) {
-        qDebug() << "❌ Nem sikerült elindítani a sakkmotort! Hiba: " << uciProcess->errorString();
+    if (!isConfigured()) {
+        LOG_WARNING("engine_not_configured", {"settings", EngineSettings::settingsFile()});
         return;
     }
-    QThread::msleep(500);
-    sendCommand("uci");
+    // Nem várunk az indulásra: a started jelzés küldi az "uci" parancsot
+    ready = false;
+    optionLines.clear();
+    uciProcess->start();
 }
 
 void UCIEngine::sendCommand(const QString &command)
 {
-    if (uciProcess->state() == QProcess::Running) {
-        uciProcess->write(command.toUtf8() + "\n");
-        uciProcess->waitForBytesWritten();
+    TRACE_SCOPE("UCIEngine::sendCommand");
+    if (uciProcess->state() == QProcess::NotRunning && !recovering) {
+        LOG_WARNING("engine_not_running", {"command", command});
+    } else if (!ready) {
+        pendingCommands.append(command);   // Indulás közben sorba állítjuk
     } else {
-        qDebug() << "⚠️ A sakkmotor nem fut!";
+        uciProcess->write(command.toUtf8() + "\n");   // Az eseményhurok üríti, nem blokkolunk
+    }
+}
+
+void UCIEngine::setOption(const QString &name, const QString &value)
+{
+    if (sendOption(name, value)) sentOptions.insert(name, value);
+}
+
+bool UCIEngine::sendOption(const QString &name, const QString &value)
+{
+    if (!hasOption(name)) {
+        LOG_DEBUG("engine_option_unsupported", {"name", name});
+        return false;
+    }
+    sendCommand(QString("setoption name %1 value %2").arg(name, value));
+    return true;
+}
+
+void UCIEngine::applySettings()
+{
+    // A beállításokat minden uciok után ebből küldjük, ezért nem kerülnek a sentOptions-be
+    sendOption("Hash", QString::number(engineSettings.hash));
+    sendOption("Threads", QString::number(engineSettings.threads));
+    sendOption("Skill Level", QString::number(engineSettings.skill));
+}
+
+void UCIEngine::parseOption(const QString &response)
+{
+    // option name Skill Level type spin default 20 min 0 max 20
+    int nameStart = response.indexOf(" name ");
+    int typeStart = response.indexOf(" type ");
+    if (nameStart < 0 || typeStart < nameStart) return;
+
+    QString name = response.mid(nameStart + 6, typeStart - nameStart - 6).trimmed();
+    QStringList tokens = response.mid(typeStart + 1).split(' ', Qt::SkipEmptyParts);
+    EngineOption option;
+    for (int i = 0; i < tokens.size(); ++i) {
+        if (tokens[i] == "type") option.type = tokens.value(++i);
+        else if (tokens[i] == "default") option.defaultValue = tokens.value(++i);
+        else if (tokens[i] == "min") option.min = tokens.value(++i).toInt();
+        else if (tokens[i] == "max") option.max = tokens.value(++i).toInt();
+        else if (tokens[i] == "var") option.vars.append(tokens.value(++i));
     }
+    engineOptions.insert(name, option);
+}
+
+void UCIEngine::loadOptionCache()
+{
+    // Az opciólista a motor fájljához kötött: ha a fájl változott, újra lekérdezzük
+    QSettings file(EngineSettings::settingsFile(), QSettings::IniFormat);
+    QFileInfo info(engineSettings.path);
+    engineOptions.clear();
+    if (file.value("engineCache/path").toString() != engineSettings.path ||
+        file.value("engineCache/modified").toDateTime() != info.lastModified()) return;
+
+    for (const QString &line : file.value("engineCache/options").toStringList()) parseOption(line);
+    LOG_DEBUG("engine_options_cached", {"count", int(engineOptions.size())});
+}
+
+void UCIEngine::saveOptionCache()
+{
+    QSettings file(EngineSettings::settingsFile(), QSettings::IniFormat);
+    file.setValue("engineCache/path", engineSettings.path);
+    file.setValue("engineCache/modified", QFileInfo(engineSettings.path).lastModified());
+    file.setValue("engineCache/options", optionLines);
 }
 
 void UCIEngine::startNewGame()
@@ -48,54 +207,368 @@ void UCIEngine::startNewGame()
     sendCommand("isready");
 }
 
-void UCIEngine::setPosition(const QStringList &moves)
+void UCIEngine::setPosition(const QStringList &moves, const QString &fen)
 {
-    QString positionCommand = "position startpos";
+    positionCommand = fen.isEmpty() ? QString("position startpos") : "position fen " + fen;
     if (!moves.isEmpty()) {
         positionCommand += " moves " + moves.join(" ");
     }
     sendCommand(positionCommand);
+    QStringList fields = fen.split(' ', Qt::SkipEmptyParts);
+    bool whiteStarts = fields.value(1) != "b";
+    positionWhiteToMove = whiteStarts == (moves.size() % 2 == 0);
+    positionPly = 2 * (qMax(1, fields.value(5, "1").toInt()) - 1) + (whiteStarts ? 0 : 1) + int(moves.size());
 }
 
 void UCIEngine::requestBestMove(int movetime)
 {
-    sendCommand(QString("go movetime %1").arg(movetime));
+    lastInfo = AnalysisLine();
+    pendingGo = QString("go movetime %1").arg(movetime);
+    pendingGoMs = movetime;
+    sendCommand(pendingGo);
+    armWatchdog(pendingGoMs);
+}
+
+void UCIEngine::requestBestMove(int wtime, int btime, int winc, int binc)
+{
+    // A motor maga osztja be az időt az órák alapján
+    lastInfo = AnalysisLine();
+    pendingGo = QString("go wtime %1 btime %2 winc %3 binc %4").arg(wtime).arg(btime).arg(winc).arg(binc);
+    // A határidő a lépésre jutó kemény időkorlát, nem a teljes hátralévő idő
+    TimeManager budget;
+    budget.init(positionWhiteToMove ? wtime : btime, positionWhiteToMove ? winc : binc, 0, positionPly);
+    pendingGoMs = budget.maximumTime();
+    sendCommand(pendingGo);
+    armWatchdog(pendingGoMs);
+}
+
+UCIEngine::RequestId UCIEngine::requestSearch(const QStringList &moves, const QString &fen, const SearchLimits &limits)
+{
+    RequestId id = ++lastSearchId;
+    searchQueue.enqueue({ id, moves, fen, limits });
+    startQueuedSearch();
+    return id;
+}
+
+UciSearch UCIEngine::search(const QStringList &moves, const QString &fen, const SearchLimits &limits)
+{
+    UciSearch request;
+    std::shared_ptr<UciSearch::State> state = request.state;
+    // A válasz a co_await előtt is megjöhet (pl. egy korai cancel()), ezt a done őrzi meg
+    state->connection = connect(this, &UCIEngine::searchFinished, this,
+                                [this, state](quint64 id, const QString &bestMove, bool cancelled) {
+        if (id != state->id) return;
+        disconnect(state->connection);
+        state->reply.bestMove = bestMove;
+        state->reply.info = lastInfo;
+        state->reply.cancelled = cancelled;
+        state->done = true;
+        // Nem a jelzés közepén folytatjuk: a korutin új keresést vagy cancel()-t is kiadhat
+        if (state->waiting) QMetaObject::invokeMethod(this, [state]() { state->waiting.resume(); }, Qt::QueuedConnection);
+    });
+    state->id = requestSearch(moves, fen, limits);
+    return request;
+}
+
+void UCIEngine::cancel(RequestId id)
+{
+    if (id == 0) return;
+    if (id == activeSearch) {
+        activeSearch = 0;
+        stopSearch();
+    } else {
+        auto queued = std::find_if(searchQueue.begin(), searchQueue.end(), [id](const QueuedSearch &s) { return s.id == id; });
+        if (queued == searchQueue.end()) return;   // Már megjött a válasza
+        searchQueue.erase(queued);
+    }
+    LOG_DEBUG("uci_search_cancelled", {"id", id});
+    emit searchFinished(id, QString(), true);
+    startQueuedSearch();
+}
+
+void UCIEngine::startQueuedSearch()
+{
+    // Egyszerre egy "go": a kézi keresés és az elemzés is kivárja a sorát
+    if (activeSearch || searchQueue.isEmpty() || analyzing || !pendingGo.isEmpty()) return;
+    QueuedSearch next = searchQueue.dequeue();
+    activeSearch = next.id;
+    setPosition(next.moves, next.fen);
+    if (next.limits.movetime > 0) {
+        requestBestMove(next.limits.movetime);
+    } else {
+        requestBestMove(next.limits.wtime, next.limits.btime, next.limits.winc, next.limits.binc);
+    }
+}
+
+void UCIEngine::finishAllSearches()
+{
+    QVector<RequestId> finished;
+    if (activeSearch) finished.append(activeSearch);
+    for (const QueuedSearch &queued : searchQueue) finished.append(queued.id);
+    activeSearch = 0;
+    searchQueue.clear();
+    for (RequestId id : finished) emit searchFinished(id, QString(), true);
+}
+
+void UCIEngine::setMultiPV(int lines)
+{
+    sentOptions.insert("MultiPV", QString::number(lines));
+    sendCommand(QString("setoption name MultiPV value %1").arg(lines));
+}
+
+void UCIEngine::startAnalysis(const QStringList &moves, const QString &fen)
+{
+    // Futó elemzésnél előbb leállítjuk; az erre jövő bestmove-ot és info sorokat eldobjuk.
+    // A sorban álló címkézett keresések az elemzés végéig várnak.
+    stopInfinite();
+    lines.clear();
+    setPosition(moves, fen);
+    sendCommand("go infinite");
+    analyzing = true;
+    emit analysisUpdated();
+}
+
+void UCIEngine::stopAnalysis()
+{
+    if (!analyzing) return;
+    stopInfinite();
+    startQueuedSearch();   // Az elemzés alatt sorba állt keresések
+}
+
+void UCIEngine::stopInfinite()
+{
+    if (!analyzing) return;
+    if (recovering) {
+        analyzing = false;   // Az új folyamatnak még nem küldtük el a "go infinite"-et
+        return;
+    }
+    sendCommand("stop");
+    ++ignoredBestMoves;
+    analyzing = false;
+}
+
+void UCIEngine::stopSearch()
+{
+    if (pendingGo.isEmpty()) return;
+    watchdog->stop();
+    pendingGo.clear();   // Újraindításkor a replayState sem küldi el újra
+    if (recovering) return;
+    sendCommand("stop");
+    ++ignoredBestMoves;
 }
 
 void UCIEngine::handleEngineOutput()
 {
+    TRACE_SCOPE("UCIEngine::handleEngineOutput");
     while (uciProcess->canReadLine()) {
-        QString response = uciProcess->readLine().trimmed();
-        qDebug() << "UCI Engine válasz: " << response;
+        processLine(uciProcess->readLine().trimmed());
+    }
+}
 
-        if (response == "uciok") {
-            qDebug() << "✅ UCI motor készen áll.";
-        }
-        else if (response == "readyok") {
-            qDebug() << "✅ Motor készen áll a parancsokra.";
+void UCIEngine::processLine(const QString &response)
+{
+    if (response.startsWith("info ")) {
+        // Elemzés közben másodpercenként sok száz sor is jöhet, ezeket nem naplózzuk
+        if (ignoredBestMoves == 0) parseInfo(response);
+        return;
+    }
+    LOG_DEBUG("uci_output", {"line", response});
+
+    if (response.startsWith("option ")) {
+        if (optionLines.isEmpty()) engineOptions.clear();   // Friss lista, a gyorsítótárat felülírjuk
+        optionLines.append(response);
+        parseOption(response);
+    }
+    else if (response == "uciok") {
+        LOG_INFO("uci_ok", {"options", int(engineOptions.size())});
+        ready = true;
+        saveOptionCache();
+        applySettings();
+        if (recovering) replayState();
+        QStringList pending = pendingCommands;
+        pendingCommands.clear();
+        for (const QString &command : pending) sendCommand(command);
+        emit engineReady();
+    }
+    else if (response == "readyok") {
+        LOG_DEBUG("uci_readyok");
+    }
+    else if (response.startsWith("bestmove")) {
+        if (ignoredBestMoves > 0) {
+            --ignoredBestMoves;   // Leállított elemzés vége
+            return;
         }
-        else if (response.startsWith("bestmove")) {
-            QString bestMove = response.split(" ").value(1, "");
+        watchdog->stop();
+        pendingGo.clear();
+        QString bestMove = response.split(" ").value(1, "");
+        Trace::instant("bestmove");
+        LOG_INFO("uci_bestmove", {"move", bestMove});
+        if (activeSearch) {
+            RequestId id = activeSearch;
+            activeSearch = 0;
+            emit searchFinished(id, bestMove, false);
+        } else {
             emit bestMoveFound(bestMove);
         }
+        startQueuedSearch();
+    }
+}
+
+void UCIEngine::parseInfo(const QString &response)
+{
+    QStringList tokens = response.split(' ', Qt::SkipEmptyParts);
+    AnalysisLine line;
+    bool hasScore = false;
+
+    for (int i = 1; i < tokens.size(); ++i) {
+        const QString &token = tokens[i];
+        if (token == "multipv") line.multipv = tokens.value(++i).toInt();
+        else if (token == "depth") line.depth = tokens.value(++i).toInt();
+        else if (token == "seldepth") line.seldepth = tokens.value(++i).toInt();
+        else if (token == "nodes") line.nodes = tokens.value(++i).toLongLong();
+        else if (token == "nps") line.nps = tokens.value(++i).toLongLong();
+        else if (token == "score") {
+            line.mate = tokens.value(++i) == "mate";
+            line.score = tokens.value(++i).toInt();
+            hasScore = true;
+        }
+        else if (token == "pv") {
+            line.pv = tokens.mid(i + 1);
+            break;
+        }
+    }
+
+    // "info currmove ..." és hasonló sorok nem hoznak új változatot
+    if (!hasScore || line.pv.isEmpty() || line.multipv < 1) return;
+    if (!analyzing) {
+        if (line.multipv == 1) lastInfo = line;   // Lépéskérésnél csak a gyorsítótárnak kell
+        return;
     }
+    if (lines.size() < line.multipv) lines.resize(line.multipv);
+    lines[line.multipv - 1] = line;
+    emit analysisUpdated();
 }
 
 void UCIEngine::handleEngineErrorOutput()
 {
     while (uciProcess->canReadLine()) {
         QString errorOutput = uciProcess->readLine().trimmed();
-        qDebug() << "❌ Engine hiba: " << errorOutput;
+        LOG_ERROR("engine_stderr", {"line", errorOutput});
     }
 }
 
 void UCIEngine::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
-    qDebug() << "⚠️ A sakkmotor leállt. Kilépési kód: " << exitCode;
+    ready = false;
+    watchdog->stop();
+    if (shuttingDown) {
+        LOG_INFO("engine_finished", {"exit_code", exitCode});
+        return;
+    }
 
+    // Mi sosem állítjuk le menet közben: bármilyen kilépés hiba, az elemzés és a "go" újraindul
+    if (killRequested) {
+        killRequested = false;
+        scheduleRecovery("killed");
+        return;
+    }
     if (exitStatus == QProcess::CrashExit) {
-        qDebug() << "❌ A sakkmotor összeomlott!";
+        LOG_ERROR("engine_crashed", {"exit_code", exitCode}, {"pending_go", !pendingGo.isEmpty()});
     } else {
-        qDebug() << "✅ A sakkmotor normálisan leállt.";
+        LOG_ERROR("engine_exited", {"exit_code", exitCode}, {"pending_go", !pendingGo.isEmpty()});
     }
+    ++engineHealth.crashes;
+    scheduleRecovery("exit");
+}
+
+void UCIEngine::armWatchdog(int searchMs)
+{
+    // Indulás közben a parancs a sorban vár, a határidő ezt is lefedi
+    watchdog->start(searchMs + hangGrace + (ready ? 0 : RecoveryTimeoutMs));
+}
+
+void UCIEngine::onSearchHung()
+{
+    if (pendingGo.isEmpty()) return;
+    ++engineHealth.hangs;
+    LOG_ERROR("engine_hung", {"command", pendingGo}, {"grace_ms", hangGrace});
+    // A kill után a finished jelzés indítja az újraindítást
+    killRequested = true;
+    uciProcess->kill();
+}
+
+void UCIEngine::scheduleRecovery(const char *reason)
+{
+    ready = false;
+    qint64 now = sessionClock.elapsed();
+    while (!restartTimes.isEmpty() && now - restartTimes.first() > RestartWindowMs) restartTimes.removeFirst();
+
+    if (restartTimes.size() >= MaxRestarts) {
+        LOG_ERROR("engine_recovery_abandoned", {"reason", reason}, {"restarts", int(restartTimes.size())});
+        recovering = false;
+        analyzing = false;
+        pendingGo.clear();
+        pendingCommands.clear();
+        recoveryDeadline->stop();
+        finishAllSearches();
+        emit engineFailed();
+        return;
+    }
+
+    if (!recovering) {
+        recovering = true;
+        recoveryClock.start();
+    }
+    restartTimes.append(now);
+    ++engineHealth.restarts;
+
+    // Az új folyamat nem küldi el a régi "stop"-ok bestmove-jait; az állapotot a replayState küldi
+    ignoredBestMoves = 0;
+    pendingCommands.clear();
+    int delay = restartTimes.size() == 1 ? 0 : 250 << (restartTimes.size() - 2);
+    LOG_WARNING("engine_restarting", {"reason", reason}, {"attempt", int(restartTimes.size())}, {"delay_ms", delay});
+    QTimer::singleShot(delay, this, &UCIEngine::startEngine);
+    recoveryDeadline->start(delay + RecoveryTimeoutMs);
+}
+
+void UCIEngine::onRecoveryTimeout()
+{
+    if (!recovering || ready) return;
+    ++engineHealth.failedRecoveries;
+    LOG_ERROR("engine_recovery_timeout", {"timeout_ms", RecoveryTimeoutMs});
+    if (uciProcess->state() != QProcess::NotRunning) {
+        killRequested = true;
+        uciProcess->kill();
+    } else {
+        scheduleRecovery("timeout");
+    }
+}
+
+void UCIEngine::replayState()
+{
+    // uciok után: az applySettings már lefutott, a kézzel állított opciók (sentOptions) egyszer mennek ki
+    for (auto it = sentOptions.constBegin(); it != sentOptions.constEnd(); ++it)
+        sendCommand(QString("setoption name %1 value %2").arg(it.key(), it.value()));
+
+    // Ha a hívó közben új keresést adott ki, az a sorban van és az számít
+    bool goQueued = false;
+    for (const QString &command : pendingCommands) goQueued = goQueued || command.startsWith("go ");
+    if (!goQueued) {
+        if (!positionCommand.isEmpty()) sendCommand(positionCommand);
+        if (analyzing) {
+            sendCommand("go infinite");
+        } else if (!pendingGo.isEmpty()) {
+            sendCommand(pendingGo);
+            armWatchdog(pendingGoMs);
+        }
+    }
+
+    recovering = false;
+    recoveryDeadline->stop();
+    ++engineHealth.recoveries;
+    engineHealth.lastRecoveryMs = recoveryClock.elapsed();
+    engineHealth.maxRecoveryMs = qMax(engineHealth.maxRecoveryMs, engineHealth.lastRecoveryMs);
+    LOG_INFO("engine_recovered", {"ms", engineHealth.lastRecoveryMs}, {"restarts", engineHealth.restarts},
+             {"resent_go", !pendingGo.isEmpty() || analyzing});
+    emit engineRecovered();
 }
@@ -3,28 +3,238 @@
 
 #include <QObject>
 #include <QProcess>
+#include <QVector>
+#include <QStringList>
+#include <QMap>
+#include <QQueue>
+#include <QElapsedTimer>
+#include <coroutine>
+#include <memory>
+#include "search.h"
 
+class QSettings;
+class QTimer;
+
+// Egy "option name ... type ..." sor a motor uci válaszából
+struct EngineOption
+{
+    QString type;           // spin, check, combo, string, button
+    QString defaultValue;
+    int min = 0;
+    int max = 0;
+    QStringList vars;       // combo értékek
+};
+
+// Settings file keys (chess.ini in the per-user config directory, or the file
+// named by CHESS_SETTINGS): [engine] path, arguments, hash, threads, skill;
+// [analysisCache] path, depth; [games] archive, journal
+struct EngineSettings
+{
+    QString path;
+    QStringList arguments;  // A motor parancssori argumentumai (pl. chess_mockengine)
+    int hash = 64;          // MB
+    int threads = 1;
+    int skill = 20;         // "Skill Level", 0-20
+    QString cachePath;      // Elemzési gyorsítótár, üres = kikapcsolva
+    int cacheDepth = 12;    // Időre kért lépésnél ennyi mélységű tárolt eredmény elég
+    QString archivePath;    // Befejezett játszmák (bináris archívum)
+    QString journalPath;    // A folyamatban lévő játszma naplója
+
+    static QString settingsFile();
+    static EngineSettings load();
+};
+
+// Egy MultiPV sor az "info" kimenetből, a score a lépésen lévő fél szemszögéből
+struct AnalysisLine
+{
+    int multipv = 1;
+    int depth = 0;
+    int seldepth = 0;
+    int score = 0;        // Centipawn, vagy matt esetén lépésszám
+    bool mate = false;
+    qint64 nodes = 0;
+    qint64 nps = 0;
+    QStringList pv;
+};
+
+// Felügyeleti számlálók: összeomlások, elakadt keresések és az újraindítások ideje
+struct EngineHealth
+{
+    int crashes = 0;
+    int hangs = 0;              // Nem jött bestmove a határidőig
+    int restarts = 0;
+    int failedRecoveries = 0;   // Az újraindítás maga sem sikerült időben
+    int recoveries = 0;
+    qint64 lastRecoveryMs = 0;  // Hibától az állás és a "go" újraküldéséig
+    qint64 maxRecoveryMs = 0;
+};
+
+class UciSearch;
+
+// Supervision: an unexpected exit or a search without bestmove before its
+// deadline (search time + hangGrace) restarts the engine. With a clock the
+// search time is the per-move hard limit (TimeManager::maximumTime). After uciok the
+// options, the last position and the pending "go" (or "go infinite") are sent
+// again, so the caller still gets its searchFinished. At most MaxRestarts
+// restarts are tried within RestartWindowMs, each must reach uciok within
+// RecoveryTimeoutMs; after that engineFailed() is emitted and the caller
+// should fall back to another engine.
+//
+// Tagged searches: search() queues a request and returns its id, and the
+// answer comes back as searchFinished with the same id. One "go" is
+// outstanding per process, the rest wait in order and start when the previous
+// bestmove arrives (or an analysis is stopped), so a late bestmove of a
+// stopped search is never taken for the answer of a newer request. cancel()
+// and engineFailed finish the request with cancelled = true. The untagged
+// requestBestMove/bestMoveFound pair is the primitive the queue is built on;
+// the two should not be mixed on one engine.
 class UCIEngine : public QObject
 {
     Q_OBJECT
 public:
     explicit UCIEngine(QObject *parent = nullptr);
     ~UCIEngine();
+    void setSettings(const EngineSettings &settings);
+    const EngineSettings &settings() const { return engineSettings; }
+    bool isReady() const { return ready; }
+    bool isConfigured() const { return !engineSettings.path.isEmpty(); }   // [engine] path or stockfish on PATH
+    const QMap<QString, EngineOption> &options() const { return engineOptions; }
+    bool hasOption(const QString &name) const { return engineOptions.contains(name); }
+    void setOption(const QString &name, const QString &value);
     void handleEngineOutput();
+    void processLine(const QString &response);
     void handleEngineErrorOutput();
     void handleProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
     void startEngine();
     void sendCommand(const QString &command);
     void startNewGame();
-    void setPosition(const QStringList &moves);
+    void setPosition(const QStringList &moves, const QString &fen = QString());   // Üres FEN = alapállás
     void requestBestMove(int movetime = 1000);
+    void requestBestMove(int wtime, int btime, int winc, int binc);
+    void setMultiPV(int lines);
+    void startAnalysis(const QStringList &moves, const QString &fen = QString());
+    void stopAnalysis();
+    void stopSearch();   // A függő "go" megszakítása, a rá jövő bestmove-ot eldobjuk
+
+    typedef quint64 RequestId;
+    // movetime, vagy ha az 0, az órák (wtime, btime, winc, binc); a többi mezőt nem küldjük
+    RequestId requestSearch(const QStringList &moves, const QString &fen, const SearchLimits &limits);
+    UciSearch search(const QStringList &moves, const QString &fen, const SearchLimits &limits);   // co_await-elhető
+    void cancel(RequestId id);   // Várakozó vagy futó kérés; a már befejezettnél nem csinál semmit
+    bool isSearching() const { return activeSearch != 0 || !searchQueue.isEmpty(); }
+    bool expectsBestMove() const { return !pendingGo.isEmpty() || ignoredBestMoves > 0; }   // Leállított keresésé is
+    bool isAnalyzing() const { return analyzing; }
+    const QVector<AnalysisLine> &analysisLines() const { return lines; }
+    const AnalysisLine &searchInfo() const { return lastInfo; }   // Az utolsó "go" fő változata
+    const EngineHealth &health() const { return engineHealth; }
+    void setHangGrace(int ms) { hangGrace = ms; }
+
+    static const int MaxRestarts = 3;
+    static const int RestartWindowMs = 60000;
+    static const int RecoveryTimeoutMs = 5000;
     QProcess *uciProcess;
 
 signals:
     void bestMoveFound(QString bestMove);
+    void searchFinished(quint64 id, QString bestMove, bool cancelled);   // cancelled: a bestMove üres
+    void engineReady();       // uciok után, a beállítások elküldve
+    void analysisUpdated();   // Minden info sorra jön, a fogadó fél vonja össze
+    void engineRecovered();   // Újraindítás után az állapot visszaküldve
+    void engineFailed();      // Feladtuk, a motor nem fut
 
 private:
-    QString enginePath;
+    void parseInfo(const QString &response);
+    void parseOption(const QString &response);
+    void applySettings();
+    bool sendOption(const QString &name, const QString &value);
+    void loadOptionCache();
+    void saveOptionCache();
+    void armWatchdog(int searchMs);
+    void onSearchHung();
+    void scheduleRecovery(const char *reason);
+    void onRecoveryTimeout();
+    void replayState();
+    void stopInfinite();
+    void startQueuedSearch();
+    void finishAllSearches();
+
+    EngineSettings engineSettings;
+    QMap<QString, EngineOption> engineOptions;
+    QStringList optionLines;      // Nyers sorok a gyorsítótárhoz
+    QStringList pendingCommands;  // uciok előtt kiadott parancsok
+    bool ready = false;
+    bool analyzing = false;
+    int ignoredBestMoves = 0;   // "stop" után érkező bestmove-ok, nem valódi lépések
+
+    struct QueuedSearch
+    {
+        RequestId id;
+        QStringList moves;
+        QString fen;
+        SearchLimits limits;
+    };
+    QQueue<QueuedSearch> searchQueue;
+    RequestId activeSearch = 0;   // A kiadott "go" kérése, 0 = nincs vagy nem címkézett
+    RequestId lastSearchId = 0;
+    QVector<AnalysisLine> lines;
+    AnalysisLine lastInfo;
+
+    // Felügyelet
+    QMap<QString, QString> sentOptions;   // A kézzel küldött opciók, újraindításkor újra elküldjük
+    QString positionCommand;
+    bool positionWhiteToMove = true;
+    int positionPly = 0;                  // A játszma eleje óta, az időbeosztáshoz
+    QString pendingGo;                    // Kiadott "go", amire még nem jött bestmove
+    int pendingGoMs = 0;                  // A kiadott keresés leghosszabb ideje
+    QTimer *watchdog;
+    QTimer *recoveryDeadline;
+    QElapsedTimer recoveryClock;
+    QElapsedTimer sessionClock;
+    QVector<qint64> restartTimes;
+    EngineHealth engineHealth;
+    int hangGrace = 5000;                 // ms a keresési idő fölött
+    bool recovering = false;
+    bool shuttingDown = false;
+    bool killRequested = false;           // A következő kilépést mi okoztuk (elakadás, időtúllépés)
+};
+
+struct UciReply
+{
+    QString bestMove;       // Üres, ha megszakították vagy a motor kiesett
+    AnalysisLine info;      // A keresés utolsó fő változata
+    bool cancelled = false;
+};
+
+// Awaitable form of a tagged search:
+//
+//   UciSearch request = engine.search(moves, fen, limits);
+//   UciReply reply = co_await request;   // elsewhere: engine.cancel(request.id())
+//   if (reply.cancelled) co_return;
+//
+// The request is queued by search() itself, so it keeps its place even if it
+// is awaited later. The coroutine is resumed from the engine's event loop,
+// after the searchFinished emission has returned.
+class UciSearch
+{
+public:
+    UCIEngine::RequestId id() const { return state->id; }
+    bool await_ready() const noexcept { return state->done; }
+    void await_suspend(std::coroutine_handle<> handle) { state->waiting = handle; }
+    UciReply await_resume() { return state->reply; }
+
+private:
+    friend class UCIEngine;
+
+    struct State
+    {
+        UCIEngine::RequestId id = 0;
+        bool done = false;
+        UciReply reply;
+        std::coroutine_handle<> waiting;
+        QMetaObject::Connection connection;
+    };
+
+    std::shared_ptr<State> state = std::make_shared<State>();
 };
 
 #endif // UCIENGINE_H
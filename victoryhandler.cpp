@@ -60,12 +60,12 @@ bool VictoryHandler::isCheckmate()
     if (kingRow == -1 || kingCol == -1) return false;
 
     // Ellenőrizzük, hogy sakkban van-e
-    if (!widget->isSquareAttacked(kingRow, kingCol, isWhiteTurn)) return false;
+    if (!widget->game.isSquareAttacked(kingRow, kingCol, isWhiteTurn)) return false;
 
     // Ha sakkban van, ellenőrizzük, hogy van-e érvényes lépése
     for (int row = 0; row < 8; ++row) {
         for (int col = 0; col < 8; ++col) {
-            if (widget->isOwnPiece(row, col)) {  // Ha saját bábunk
+            if (widget->game.isOwnPiece(row, col)) {  // Ha saját bábunk
                 highlightPieces->highlightMoves(row, col);
                 if (!possibleMoves.isEmpty()) return false;  // Ha van lépés, nem matt
             }
@@ -95,7 +95,7 @@ bool VictoryHandler::isStalemate()
     if (kingRow == -1 || kingCol == -1) return false;
 
     // Ha a király támadás alatt áll, nem lehet patt
-    if (widget->isSquareAttacked(kingRow, kingCol, isWhiteTurn)) return false;
+    if (widget->game.isSquareAttacked(kingRow, kingCol, isWhiteTurn)) return false;
 
     // Ha nincs érvényes lépés, patt
     for (int row = 0; row < 8; ++row) {
@@ -3,12 +3,29 @@
 #include "uciengine.h"
 #include "highlightpieces.h"
 #include "victoryhandler.h"
+#include "search.h"
+#include "position.h"
+#include "gameclock.h"
+#include "latency.h"
+#include "trace.h"
+#include "logger.h"
+#include "analysiscache.h"
+#include "gamearchive.h"
+#include "gamerecord.h"
+#include "movelistmodel.h"
+#include "analysistree.h"
+#include <QFileInfo>
 #include <QPainter>
 #include <QMouseEvent>
 #include <QDebug>
 #include <QSet>
 #include <QTimer>
 #include <QMessageBox>
+#include <QThread>
+#include <QKeyEvent>
+#include <QHeaderView>
+#include <cctype>
+#include <cmath>
 
 Widget::Widget(QWidget *parent)
     : QWidget(parent)
@@ -16,29 +33,111 @@ Widget::Widget(QWidget *parent)
     , uciEngine(new UCIEngine(this))
     , highlightPieces(new HighlightPieces(this))
     , victoryHandler(new VictoryHandler(this))
+    , search(new Search)
+    , gameClock(new GameClock(this))
+    , analysisTimer(new QTimer(this))
+    , analysisCache(new AnalysisCache)
+    , analysisTree(new AnalysisTree)
+    , archive(new GameArchiveWriter)
+    , journal(new GameJournal)
+    , record(new GameRecord)
+    , moveListModel(new MoveListModel(record, this))
 {
     ui->setupUi(this);
     setWindowTitle("Chess");
-    resize(800, 610);
+    resize(1000, 610);
+    setFocusPolicy(Qt::StrongFocus); // F3/F4 a késleltetési statisztikákhoz, F5 a fenyegetésekhez, nyilak a visszanézéshez
     initializeBoard();
-    uciEngine->startEngine();
+    uciEngine->setSettings(EngineSettings::load());   // A motor csak az ablak megjelenése után indul (showEvent)
     connect(ui->newgameButton, &QPushButton::clicked, this, &Widget::startNewGame);
     connect(ui->resetgameButton, &QPushButton::clicked, this, &Widget::resetGame);
-    connect(uciEngine, &UCIEngine::bestMoveFound, this, &Widget::onBestMoveReceived);
-    connect(uciEngine->uciProcess, &QProcess::readyReadStandardOutput, uciEngine, &UCIEngine::handleEngineOutput);
-    connect(uciEngine->uciProcess, &QProcess::readyReadStandardError, uciEngine, &UCIEngine::handleEngineErrorOutput);
-    connect(uciEngine->uciProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            uciEngine, &UCIEngine::handleProcessFinished);
+
+    // Lépéslista: a nézet csak a látható sorokat kéri le, az egyforma sormagasság miatt hosszú játszmánál is gyors
+    ui->moveListView->setModel(moveListModel);
+    ui->moveListView->setFocusPolicy(Qt::NoFocus);   // A nyilak a táblát léptetik
+    ui->moveListView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->moveListView->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    connect(ui->moveListView, &QTableView::clicked, this, [this](const QModelIndex &index) {
+        int node = moveListModel->nodeAt(index);
+        if (node >= 0) navigateTo(node);
+    });
+    connect(uciEngine, &UCIEngine::searchFinished, this, [this](quint64 id, const QString &bestMove, bool cancelled) {
+        if (id != uciRequest) return;   // A saját cancel() válasza, vagy már nem várunk rá
+        uciRequest = 0;
+        if (cancelled) {
+            requestEngineMove();   // A külső motor végleg kiesett: a függő lépést a beépített keresés adja
+            return;
+        }
+        onBestMoveReceived(bestMove, true);
+    });
+    connect(uciEngine, &UCIEngine::engineFailed, this, [this]() {
+        if (ui->analysisButton->isChecked()) ui->analysisLabel->setText("Engine failed, analysis stopped.");
+    });
+    connect(gameClock, &GameClock::timeUpdated, this, &Widget::updateClockLabels);
+    connect(gameClock, &GameClock::flagFell, this, &Widget::onFlagFell);
+    connect(ui->analysisButton, &QPushButton::toggled, this, &Widget::toggleAnalysis);
+    connect(ui->multiPvBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this]() {
+        if (uciEngine->isAnalyzing()) restartAnalysis();
+    });
+
+    // Összevonás: az első frissítés elindítja az időzítőt, a többi csak a legfrissebb állapotot írja felül
+    analysisTimer->setSingleShot(true);
+    analysisTimer->setInterval(100);
+    connect(analysisTimer, &QTimer::timeout, this, &Widget::updateAnalysisPanel);
+    connect(uciEngine, &UCIEngine::analysisUpdated, this, [this]() {
+        if (!analysisTimer->isActive()) analysisTimer->start();
+    });
 }
 
 Widget::~Widget()
 {
+    if (searchThread) {
+        search->stop();
+        searchThread->wait();
+    }
+    delete search;
+    delete analysisCache;
+    delete analysisTree;
+    archiveGame(int(GameResult::Unknown));   // Kilépéskor a félbehagyott játszma is megmarad
+    journal->discard();
+    delete archive;                          // Kiírja a sorban álló játszmákat
+    delete journal;
+    delete record;
     delete ui;
+
+    QString latencyFile = qEnvironmentVariable("CHESS_LATENCY_EXPORT");
+    if (!latencyFile.isEmpty()) LatencyStats::instance().exportToFile(latencyFile.toStdString());
+}
+
+void Widget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    if (engineStarted) return;
+    engineStarted = true;
+
+    // Az első kirajzolás után indítjuk a motort, így a hidegindítás csak az ablaktól függ
+    QTimer::singleShot(0, uciEngine, &UCIEngine::startEngine);
+    QTimer::singleShot(0, this, [this]() {
+        if (!uciEngine->settings().cachePath.isEmpty()) analysisCache->open(uciEngine->settings().cachePath);
+
+        // Összeomlás után a napló a félbehagyott játszmát tartalmazza: archiváljuk, aztán új naplót kezdünk
+        const EngineSettings &settings = uciEngine->settings();
+        if (!settings.archivePath.isEmpty() && !archive->open(settings.archivePath.toStdString()))
+            LOG_ERROR("archive_open_failed", {"path", settings.archivePath});
+        ArchivedGame recovered;
+        if (!settings.journalPath.isEmpty() && journal->recover(settings.journalPath.toStdString(), recovered)) {
+            LOG_WARNING("journal_recovered", {"plies", int(recovered.moves.size())});
+            archive->append(std::move(recovered));
+        }
+        startRecord(recordStartFen);
+    });
 }
 
 void Widget::paintEvent(QPaintEvent *event)
 {
     if(!isStarted) return;
+    TRACE_SCOPE("Widget::paintEvent");
+    ScopedLatencyTimer paintTimer(LatencyStage::Paint);
     QPainter painter(this);
     int boardSize = 600;  // 🔹 Fix méret a sakktáblának
     int squareSize = boardSize / 8;
@@ -75,7 +174,7 @@ void Widget::paintEvent(QPaintEvent *event)
 
     for (int row = 0; row < 8; ++row) {
         for (int col = 0; col < 8; ++col) {
-            char piece = board[row][col];
+            char piece = game.pieceAt(row, col);
             if (piece != ' ') {
                 QRect textRect(col * squareSize, row * squareSize, squareSize, squareSize);
                 painter.drawText(textRect, Qt::AlignCenter, pieceMap[piece]);
@@ -85,15 +184,118 @@ void Widget::paintEvent(QPaintEvent *event)
 
     // Lehetséges lépések kiemelése
     painter.setBrush(QColor(255, 255, 0, 100));  // Átlátszó sárga szín
-    for (auto move : possibleMoves) {
+    for (auto move : game.possibleMoves) {
         int moveRow = move.first;
         int moveCol = move.second;
         painter.drawRect(moveCol * squareSize, moveRow * squareSize, squareSize, squareSize);
     }
+
+    if (showThreatOverlay) drawThreatOverlay(painter, squareSize);
+    if (uciEngine->isAnalyzing()) drawEvalBar(painter);
+    if (showLatencyOverlay) drawLatencyOverlay(painter);
+
+    if (clickTimer.isValid()) {
+        LatencyStats::instance().record(LatencyStage::ClickToPaint, clickTimer.nsecsElapsed() / 1000);
+        clickTimer.invalidate();
+    }
+}
+
+void Widget::drawLatencyOverlay(QPainter &painter)
+{
+    std::vector<std::string> lines = LatencyStats::instance().summaryLines();
+    const EngineHealth &health = uciEngine->health();
+    lines.push_back(QString("engine crashes %1 hangs %2 restarts %3 failed %4 recovery %5/%6 ms")
+                        .arg(health.crashes).arg(health.hangs).arg(health.restarts).arg(health.failedRecoveries)
+                        .arg(health.lastRecoveryMs).arg(health.maxRecoveryMs).toStdString());
+    QFont font("Courier New", 9);
+    painter.setFont(font);
+    int lineHeight = painter.fontMetrics().height();
+
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 180));
+    painter.drawRect(5, 5, 440, lineHeight * int(lines.size()) + 10);
+
+    painter.setPen(Qt::green);
+    for (int i = 0; i < int(lines.size()); ++i) {
+        painter.drawText(10, 5 + lineHeight * (i + 1), QString::fromStdString(lines[i]));
+    }
+}
+
+void Widget::drawThreatOverlay(QPainter &painter, int squareSize)
+{
+    // Az ellenfél által támadott mezők halványpirosak; a védtelen, támadott bábuk kerete piros (saját) vagy zöld (ellenfélé)
+    const AttackMap &attacks = game.attacks();
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(255, 0, 0, 45));
+    for (int square = 0; square < 64; ++square) {
+        if (attacks.isAttacked(square, !game.isWhiteTurn()))
+            painter.drawRect(square % 8 * squareSize, square / 8 * squareSize, squareSize, squareSize);
+    }
+
+    painter.setBrush(Qt::NoBrush);
+    for (int square = 0; square < 64; ++square) {
+        if (!attacks.isHanging(square)) continue;
+        bool own = bool(std::isupper(attacks.pieceAt(square))) == game.isWhiteTurn();
+        painter.setPen(QPen(own ? Qt::red : Qt::darkGreen, 3));
+        painter.drawRect(square % 8 * squareSize + 2, square / 8 * squareSize + 2, squareSize - 4, squareSize - 4);
+    }
+}
+
+void Widget::drawEvalBar(QPainter &painter)
+{
+    // A tábla és a jobb oldali panel között; a fehér rész a fehér esélyeivel arányos
+    const QVector<AnalysisLine> &lines = uciEngine->analysisLines();
+    if (lines.isEmpty()) return;
+
+    const AnalysisLine &best = lines.first();
+    int whiteScore = game.isWhiteTurn() ? best.score : -best.score;
+    double whiteShare;
+    if (best.mate) whiteShare = whiteScore > 0 ? 1.0 : 0.0;
+    else whiteShare = 1.0 / (1.0 + std::exp(-whiteScore / 400.0));
+
+    QRect bar(605, 0, 25, 600);
+    int whiteHeight = int(bar.height() * whiteShare);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    painter.drawRect(bar);
+    painter.setBrush(Qt::white);
+    painter.drawRect(bar.x(), bar.bottom() - whiteHeight, bar.width(), whiteHeight);
+    painter.setPen(Qt::gray);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(bar);
+}
+
+void Widget::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_F3) {
+        showLatencyOverlay = !showLatencyOverlay;
+        update();
+    } else if (event->key() == Qt::Key_F4) {
+        bool ok = LatencyStats::instance().exportToFile("latency.json");
+        qDebug() << (ok ? "📊 Késleltetési statisztika mentve: latency.json" : "❌ Nem sikerült menteni a statisztikát!");
+    } else if (event->key() == Qt::Key_F5) {
+        showThreatOverlay = !showThreatOverlay;
+        update();
+    } else if (event->key() == Qt::Key_Left) {
+        if (record->current() != GameRecord::Root) navigateTo(record->parent(record->current()));
+    } else if (event->key() == Qt::Key_Right) {
+        const std::vector<int> &next = record->children(record->current());
+        if (!next.empty()) navigateTo(next.front());
+    } else if (event->key() == Qt::Key_Home) {
+        navigateTo(GameRecord::Root);
+    } else if (event->key() == Qt::Key_End) {
+        navigateTo(record->lineEnd(record->current()));
+    } else {
+        QWidget::keyPressEvent(event);
+    }
 }
 
 void Widget::mousePressEvent(QMouseEvent *event)
 {
+    TRACE_SCOPE("Widget::mousePressEvent");
+    ScopedLatencyTimer inputTimer(LatencyStage::MouseInput);
+    clickTimer.start();
+
     // A négyzetek tényleges méretének kiszámítása
     int squareSize = qMin(width(), height()) / 8;
 
@@ -106,24 +308,24 @@ void Widget::mousePressEvent(QMouseEvent *event)
         return;
     }
     // Ha nincs még kiválasztott bábu
-    if (selectedRow == -1 && selectedCol == -1) {
-        char piece = board[row][col];
+    if (game.selectedRow == -1 && game.selectedCol == -1) {
+        char piece = game.pieceAt(row, col);
 
         // Ellenőrizzük, hogy a kattintott bábu a megfelelő színű-e
-        if (piece != ' ' && ((isWhiteTurn && piece >= 'A' && piece <= 'Z') ||
-                             (!isWhiteTurn && piece >= 'a' && piece <= 'z'))) {
-            selectedRow = row;
-            selectedCol = col;
+        if (piece != ' ' && ((game.isWhiteTurn() && piece >= 'A' && piece <= 'Z') ||
+                             (!game.isWhiteTurn() && piece >= 'a' && piece <= 'z'))) {
+            game.selectedRow = row;
+            game.selectedCol = col;
             highlightMoves(row, col);
             update();
         }
     }
     else {  // Ha már van kiválasztott bábu
-        if (possibleMoves.contains(QPair<int, int>(row, col))) {
+        if (game.possibleMoves.contains(QPair<int, int>(row, col))) {
             // Alkalmazzuk a lépést
             QString move = QString("%1%2%3%4")
-                               .arg(QChar('a' + selectedCol))
-                               .arg(8 - selectedRow)
+                               .arg(QChar('a' + game.selectedCol))
+                               .arg(8 - game.selectedRow)
                                .arg(QChar('a' + col))
                                .arg(8 - row);
 
@@ -131,61 +333,30 @@ void Widget::mousePressEvent(QMouseEvent *event)
 
             if (moveSuccess) {
                 // Csak akkor töröljük a kiválasztást és a lehetséges lépéseket, ha a lépés sikeres volt
-                selectedRow = -1;
-                selectedCol = -1;
-                possibleMoves.clear();
-                stepsCount++;
-                ui->stepLabel->setText(QString("Steps Count: %1").arg(stepsCount));
+                game.selectedRow = -1;
+                game.selectedCol = -1;
+                game.possibleMoves.clear();
+                game.stepsCount++;
+                ui->stepLabel->setText(QString("Steps Count: %1").arg(game.stepsCount));
                 update();
             }
             else {
-                qDebug() << "Move failed, selection remains.";
+                LOG_DEBUG("move_failed_selection_kept");
             }
         }
         else {  // Ha a kattintás nem érvényes lépés volt, csak töröljük a kijelölést
-            selectedRow = -1;
-            selectedCol = -1;
-            possibleMoves.clear();
+            game.selectedRow = -1;
+            game.selectedCol = -1;
+            game.possibleMoves.clear();
             update();
         }
     }
 }
 
-void Widget::initializeBoard()
-{
-    board = QVector<QVector<char>>(8, QVector<char>(8, ' '));
-    hasMoved = QVector<QVector<bool>>(8, QVector<bool>(8, false));
-    enPassantTarget = QPair<int, int>(-1, -1);
-
-    // Kezdő pozíció beállítása
-    QString initialPositionStr = "rnbqkbnrpppppppp                                PPPPPPPPRNBQKBNR";
-    QByteArray initialPosition = initialPositionStr.toLatin1();
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            board[row][col] = initialPosition.at(row * 8 + col);
-        }
-    }
-
-    isWhiteTurn = true;  // A fehér kezd
-}
-
 void Widget::updatePieceCount()
 {
-    int whiteCount = 0, blackCount = 0;
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            char piece = board[row][col];
-            if (piece == ' ') continue;
-
-            if (piece >= 'A' && piece <= 'Z') {
-                whiteCount++;
-            } else if (piece >= 'a' && piece <= 'z') {
-                blackCount++;
-            }
-        }
-    }
+    int whiteCount = game.evaluation().pieceCount(true);
+    int blackCount = game.evaluation().pieceCount(false);
 
     int whiteCaptured = 16 - whiteCount;
     int blackCaptured = 16 - blackCount;
@@ -196,678 +367,461 @@ void Widget::updatePieceCount()
     ui->blackCapturedLabel->setText(QString("Black Pieces Knocked Out: %1").arg(blackCaptured));
 }
 
-void Widget::highlightMoves(int row, int col)
-{
-    if (!isStarted) return;
-    char piece = board[row][col];
-    if (piece == ' ') return;
-
-    possibleMoves.clear();
-
-    switch (piece) {
-    case 'R': case 'r': highlightRookMoves(row, col); break;
-    case 'N': case 'n': highlightKnightMoves(row, col); break;
-    case 'B': case 'b': highlightBishopMoves(row, col); break;
-    case 'Q': case 'q': highlightQueenMoves(row, col); break;
-    case 'K': case 'k': highlightKingMoves(row, col); break;
-    case 'P': case 'p': highlightPawnMoves(row, col); break;
-    }
-
-    filterIllegalMoves(); // Király sakkellenőrzése
-    updatePieceCount();
-}
-
-void Widget::highlightPawnMoves(int row, int col)
-{
-    int direction = (board[row][col] == 'P') ? -1 : 1;
-    if (row + direction >= 0 && row + direction < 8 && board[row + direction][col] == ' ') {
-        possibleMoves.insert({row + direction, col});
-        if ((board[row][col] == 'P' && row == 6) || (board[row][col] == 'p' && row == 1)) {
-            if (board[row + 2 * direction][col] == ' ') {
-                possibleMoves.insert({row + 2 * direction, col});
-            }
-        }
-    }
-    if (row + direction >= 0 && row + direction < 8) {
-        if (col - 1 >= 0 && isEnemyPiece(row + direction, col - 1)) {
-            possibleMoves.insert({row + direction, col - 1});
-        }
-        if (col + 1 < 8 && isEnemyPiece(row + direction, col + 1)) {
-            possibleMoves.insert({row + direction, col + 1});
-        }
-        if (col - 1 >= 0 && isEnPassant(row + direction, col - 1) && board[row][col - 1] != ' ') {
-            possibleMoves.insert({row + direction, col - 1});
-        }
-        if (col + 1 < 8 && isEnPassant(row + direction, col + 1) && board[row][col + 1] != ' ') {
-            possibleMoves.insert({row + direction, col + 1});
-        }
-    }
-}
-
-void Widget::highlightRookMoves(int row, int col)
+void Widget::initializeBoard()
 {
-    QVector<QPair<int, int>> directions = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-    for (const auto& dir : directions) {
-        int newRow = row + dir.first, newCol = col + dir.second;
-        while (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8) {
-            if (board[newRow][newCol] == ' ') {
-                possibleMoves.insert({newRow, newCol});
-            } else {
-                if (isEnemyPiece(newRow, newCol)) possibleMoves.insert({newRow, newCol});
-                break; // Ha saját vagy ellenséges bábu van, megállunk
-            }
-            newRow += dir.first;
-            newCol += dir.second;
-        }
-    }
+    game.initializeBoard();
 }
 
-void Widget::highlightKnightMoves(int row, int col)
+bool Widget::setFen(const QString &fen)
 {
-    QVector<QPair<int, int>> knightMoves = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1},
-                                            {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
-    for (const auto &move : knightMoves) {
-        int newRow = row + move.first;
-        int newCol = col + move.second;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8 &&
-            (board[newRow][newCol] == ' ' || isEnemyPiece(newRow, newCol))) {
-            possibleMoves.insert({newRow, newCol});
-        }
-    }
-}
-
-void Widget::highlightBishopMoves(int row, int col)
-{
-    // Diagonal moves
-    for (int i = 1; i < 8; ++i) {
-        if (row + i < 8 && col + i < 8 && (board[row + i][col + i] == ' ' || isEnemyPiece(row + i, col + i))) {
-            possibleMoves.insert({row + i, col + i});
-            if (board[row + i][col + i] != ' ') break;
-        }
-        if (row + i < 8 && col - i >= 0 && (board[row + i][col - i] == ' ' || isEnemyPiece(row + i, col - i))) {
-            possibleMoves.insert({row + i, col - i});
-            if (board[row + i][col - i] != ' ') break;
-        }
-        if (row - i >= 0 && col + i < 8 && (board[row - i][col + i] == ' ' || isEnemyPiece(row - i, col + i))) {
-            possibleMoves.insert({row - i, col + i});
-            if (board[row - i][col + i] != ' ') break;
-        }
-        if (row - i >= 0 && col - i >= 0 && (board[row - i][col - i] == ' ' || isEnemyPiece(row - i, col - i))) {
-            possibleMoves.insert({row - i, col - i});
-            if (board[row - i][col - i] != ' ') break;
-        }
-    }
+    if (!game.setFen(fen)) return false;
+    archiveGame(int(GameResult::Unknown));
+    startRecord(fen);
+    update();
+    return true;
 }
 
-void Widget::highlightQueenMoves(int row, int col)
+void Widget::highlightMoves(int row, int col)
 {
-    highlightRookMoves(row, col);
-    highlightBishopMoves(row, col);
+    TRACE_SCOPE("Widget::highlightMoves");
+    if (!isStarted) return;
+    ScopedLatencyTimer timer(LatencyStage::LegalMoves);
+    game.highlightMoves(row, col);
+    updatePieceCount();
 }
 
-void Widget::highlightKingMoves(int row, int col)
+void Widget::checkGameOver()
 {
-    QVector<QPair<int, int>> kingMoves = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    for (const auto &move : kingMoves) {
-        int newRow = row + move.first;
-        int newCol = col + move.second;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8 &&
-            (board[newRow][newCol] == ' ' || isEnemyPiece(newRow, newCol))) {
-            if (!doesMoveExposeKing({newRow, newCol})) { // ELLENŐRZI, HOGY SAKKBAN LENNE-E
-                possibleMoves.insert({newRow, newCol});
-            }
-        }
+    // Csak a keresés számít, a párbeszédablak nem
+    GameOutcome outcome;
+    {
+        ScopedLatencyTimer timer(LatencyStage::GameOverScan);
+        outcome = game.outcome();
+    }
+
+    if (outcome == GameOutcome::Checkmate) {
+        LOG_INFO("game_over", {"reason", "checkmate"});
+        gameClock->stop();
+        archiveGame(int(game.isWhiteTurn() ? GameResult::BlackWins : GameResult::WhiteWins));
+        QMessageBox::information(this, "Játék vége", game.isWhiteTurn() ? "Fekete nyert (matt)!" : "Fehér nyert (matt)!");
+        isStarted = false;
+        return; // Nincs további ellenőrzés szükséges
     }
-    highlightCastling(row, col);
-}
-
-void Widget::highlightCastling(int row, int col)
-{
-    if (hasMoved[row][col]) return;
-
-    // Hosszú sánc (balra)
-    if (!hasMoved[row][0] && board[row][1] == ' ' && board[row][2] == ' ' && board[row][3] == ' ') {
-        if (!doesMoveExposeKing({row, 2}) && !doesMoveExposeKing({row, 3})) { // Sakkellenőrzés az áthaladó mezőkön
-            possibleMoves.insert({row, 2});
-        }
+    if (outcome == GameOutcome::Stalemate) {
+        LOG_INFO("game_over", {"reason", "stalemate"});
+        gameClock->stop();
+        archiveGame(int(GameResult::Draw));
+        QMessageBox::information(this, "Játék vége", "Döntetlen (pat)!");
+        isStarted = false;
+        return;
     }
-
-    // Rövid sánc (jobbra)
-    if (!hasMoved[row][7] && board[row][5] == ' ' && board[row][6] == ' ') {
-        if (!doesMoveExposeKing({row, 5}) && !doesMoveExposeKing({row, 6})) { // Sakkellenőrzés az áthaladó mezőkön
-            possibleMoves.insert({row, 6});
-        }
+    if (outcome != GameOutcome::Ongoing) {
+        LOG_INFO("game_over", {"reason", outcome == GameOutcome::FiftyMoves ? "fifty_moves"
+                                         : outcome == GameOutcome::Repetition ? "repetition" : "insufficient_material"});
+        gameClock->stop();
+        archiveGame(int(GameResult::Draw));
+        QMessageBox::information(this, "Játék vége", "Döntetlen (anyaghiány, ismétlés vagy 50 lépés szabály)!");
+        isStarted = false;
+        return;
     }
+    game.possibleMoves.clear(); // Minden esetben töröljük az előző lépéseket
 }
 
-void Widget::filterIllegalMoves()
+void Widget::onBestMoveReceived(QString bestMove, bool fromUci)
 {
-    QSet<QPair<int, int>> validMoves;
-    for (auto move : possibleMoves) {
-        if (!doesMoveExposeKing(move)) validMoves.insert(move);
+    TRACE_SCOPE("Widget::onBestMoveReceived");
+    if (engineTimer.isValid()) {
+        LatencyStats::instance().record(LatencyStage::EngineRoundTrip, engineTimer.nsecsElapsed() / 1000);
+        engineTimer.invalidate();
     }
-    possibleMoves = validMoves;
-}
 
-bool Widget::doesMoveExposeKing(QPair<int, int> move)
-{
-    if (selectedRow < 0 || selectedRow >= 8 || selectedCol < 0 || selectedCol >= 8) {
-        return false;
+    if (bestMove.isEmpty() || bestMove == "(none)") {
+        LOG_WARNING("engine_no_bestmove");
+        return;
     }
-
-    int fromRow = selectedRow;
-    int fromCol = selectedCol;
-    int toRow = move.first;
-    int toCol = move.second;
-
-    char piece = board[fromRow][fromCol];
-    if (piece == ' ') {
-        qDebug() << "HIBA: Nincs bábu a kiválasztott mezőn!";
-        return false;
+    if (!isStarted) {
+        LOG_DEBUG("engine_move_ignored", {"move", bestMove}, {"reason", "game_over"});   // Pl. leesett a zászló
+        return;
     }
 
-    char capturedPiece = board[toRow][toCol];
-
-    // Ideiglenesen végrehajtjuk a lépést
-    board[fromRow][fromCol] = ' ';
-    board[toRow][toCol] = piece;
+    LOG_DEBUG("engine_bestmove", {"move", bestMove}, {"white_to_move", game.isWhiteTurn()});
 
-    // Megkeressük a saját királyunk pozícióját
-    int kingRow = -1, kingCol = -1;
-    char kingChar = (piece >= 'A' && piece <= 'Z') ? 'K' : 'k';
+    // A lépés előtt, amíg a történet még a kérés állását írja le
+    if (fromUci) storeEngineLine(game.moveHistory, uciEngine->searchInfo());
 
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            if (board[row][col] == kingChar) {
-                kingRow = row;
-                kingCol = col;
-            }
-        }
-    }
-
-    if (kingRow == -1 || kingCol == -1) {
-        qDebug() << "HIBA: Nem található a király!";
-        return false;
+    if (game.isWhiteTurn()) {
+        LOG_WARNING("engine_move_ignored", {"move", bestMove}, {"reason", "white_to_move"});
+        return;
     }
 
-    // Ha a lépés maga a király lépése volt
-    if (piece == 'K' || piece == 'k') {
-        kingRow = toRow;
-        kingCol = toCol;
+    // ⛔ **HIBA MEGOLDÁSA:** Ellenőrizzük, hogy a lépés valóban végrehajtható-e!
+    if (!applyMove(bestMove)) {
+        LOG_WARNING("engine_move_rejected", {"move", bestMove});
+        return;
     }
 
-    // Ellenőrizzük, hogy az ellenfél sakkban tartja-e a királyt
-    bool inCheck = isSquareAttacked(kingRow, kingCol, piece >= 'A' && piece <= 'Z');
-
-    // Visszaállítjuk az eredeti állapotot
-    board[fromRow][fromCol] = piece;
-    board[toRow][toCol] = capturedPiece;
-
-    return inCheck;
+    checkGameOver();
 }
 
-bool Widget::isSquareAttacked(int row, int col, bool isWhite)
+bool Widget::applyMove(QString move)
 {
-    char enemyPawn = isWhite ? 'p' : 'P';
-    char enemyRook = isWhite ? 'r' : 'R';
-    char enemyKnight = isWhite ? 'n' : 'N';
-    char enemyBishop = isWhite ? 'b' : 'B';
-    char enemyQueen = isWhite ? 'q' : 'Q';
-    char enemyKing = isWhite ? 'k' : 'K';
-
-    // Pawn attacks
-    int direction = isWhite ? -1 : 1;
-    if (row + direction >= 0 && row + direction < 8) {
-        if (col - 1 >= 0 && board[row + direction][col - 1] == enemyPawn) return true;
-        if (col + 1 < 8 && board[row + direction][col + 1] == enemyPawn) return true;
-    }
-
-    // Knight attacks
-    QVector<QPair<int, int>> knightMoves = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
-    for (const auto &move : knightMoves) {
-        int newRow = row + move.first;
-        int newCol = col + move.second;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8 && board[newRow][newCol] == enemyKnight) {
-            return true;
-        }
-    }
+    TRACE_SCOPE("Widget::applyMove");
+    ScopedLatencyTimer timer(LatencyStage::ApplyMove);
+    LOG_INFO("apply_move", {"move", move}, {"ply", int(game.moveHistory.size())});
 
-    // Rook and Queen (horizontal and vertical)
-    QVector<QPair<int, int>> directions = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-    for (const auto &dir : directions) {
-        int newRow = row, newCol = col;
-        while (true) {
-            newRow += dir.first;
-            newCol += dir.second;
-            if (newRow < 0 || newRow >= 8 || newCol < 0 || newCol >= 8) break;
-            if (board[newRow][newCol] == ' ') continue;
-            if (board[newRow][newCol] == enemyRook || board[newRow][newCol] == enemyQueen) return true;
-            break;
-        }
-    }
-
-    // Bishop and Queen (diagonal)
-    QVector<QPair<int, int>> diagonalDirections = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    for (const auto &dir : diagonalDirections) {
-        int newRow = row, newCol = col;
-        while (true) {
-            newRow += dir.first;
-            newCol += dir.second;
-            if (newRow < 0 || newRow >= 8 || newCol < 0 || newCol >= 8) break;
-            if (board[newRow][newCol] == ' ') continue;
-            if (board[newRow][newCol] == enemyBishop || board[newRow][newCol] == enemyQueen) return true;
-            break;
-        }
+    // Az ellenőrzés és a táblamódosítás a szabálymagban történik
+    if (!game.applyMove(move)) {
+        return false;
     }
+    move = game.moveHistory.last();   // Átváltozásnál a bábu betűjével együtt
 
-    // King attacks
-    QVector<QPair<int, int>> kingMoves = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    for (const auto &move : kingMoves) {
-        int newRow = row + move.first;
-        int newCol = col + move.second;
-        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8 && board[newRow][newCol] == enemyKing) {
-            return true;
+    // Visszanézés után lépve új változat kezdődik; játszma közben ez lesz a főváltozat (visszalépés)
+    int mainEnd = record->lineEnd(GameRecord::Root);
+    uint32_t parentNode = analysisTree->find(record->position().key());
+    int node = record->play(record->parseUciMove(move.toStdString()), !ui->analysisButton->isChecked());
+    if (node >= 0) {
+        // Napló: lépésenként két bájt, így összeomlás után sem vész el a játszma
+        int newEnd = record->lineEnd(GameRecord::Root);
+        if (newEnd != mainEnd) {
+            if (!recordArchived && newEnd == node && record->parent(node) == mainEnd) journal->appendMove(record->move(node));
+            else restartJournal();
+            recordArchived = false;
         }
+        if (parentNode != AnalysisTree::NoNode) analysisTree->addChild(parentNode, record->move(node), record->position());
+        updateMoveList();
     }
 
-    return false;
-}
-
-bool Widget::isEnPassant(int row, int col)
-{
-    if (enPassantTarget != QPair<int, int>(row, col)) {
-        return false; // Az en passant célmező nem egyezik
-    }
-
-    // Az éppen lépő bábu gyalog kell legyen
-    char piece = board[selectedRow][selectedCol];
-    if (piece != 'P' && piece != 'p') {
-        return false; // Csak gyalog hajthat végre en passant ütést
+    if (ui->analysisButton->isChecked()) {
+        // Elemző módban mindkét oldalt a felhasználó lépi, a motor csak az új állást elemzi
+        restartAnalysis();
+        update();
+        return true;
     }
 
-    // Az en passant célmezőnek egy üres mezőnek kell lennie
-    if (board[row][col] != ' ') {
-        return false;
-    }
+    uciEngine->setPosition(game.moveHistory, QString::fromStdString(record->startFen()));
+    LOG_DEBUG("engine_position", {"plies", int(game.moveHistory.size())});
+    gameClock->switchSide();
+    update();
 
-    // Az ellenséges gyalognak közvetlenül mellette kell lennie
-    int enemyRow = (piece == 'P') ? row + 1 : row - 1;
-    if (enemyRow >= 0 && enemyRow < 8) {
-        char enemyPawn = board[enemyRow][col];
-        if ((piece == 'P' && enemyPawn == 'p') || (piece == 'p' && enemyPawn == 'P')) {
-            return true; // Az en passant szabály érvényes
-        }
+    // Ha a felhasználó lépett, akkor a motor jön
+    if (!game.isWhiteTurn()) {
+        game.stepsCount++;
+        ui->stepLabel->setText(QString("Steps Count: %1").arg(game.stepsCount));
+        requestEngineMove();
     }
 
-    return false;
+    return true;
 }
 
-void Widget::checkGameOver()
+void Widget::requestEngineMove()
 {
-    if (isCheckmate()) {
-        qDebug() << "🏁 Checkmate észlelve!";
-        QMessageBox::information(this, "Játék vége", isWhiteTurn ? "Fekete nyert (matt)!" : "Fehér nyert (matt)!");
-        isStarted = false;
-        return; // Nincs további ellenőrzés szükséges
-    }
-    if (isStalemate()) {
-        qDebug() << "⚖️ Stalemate észlelve!";
-        QMessageBox::information(this, "Játék vége", "Döntetlen (pat)!");
-        isStarted = false;
+    engineTimer.start();
+    SearchLimits limits;
+    if (gameClock->isRunning()) {
+        limits.wtime = gameClock->remaining(true);
+        limits.btime = gameClock->remaining(false);
+        limits.winc = limits.binc = gameClock->increment();
+    } else {
+        limits.movetime = 1000; // Óra nélkül a régi fix gondolkodási idő
+    }
+
+    // Már elemzett állás: a motor nélkül válaszolunk, de a szokásos (sorba állított) úton
+    Position position;
+    AnalysisCache::Entry cached;
+    int requiredDepth = limits.depth < 64 ? limits.depth : uciEngine->settings().cacheDepth;
+    if (buildPosition(game.moveHistory, position) && analysisCache->probe(position, requiredDepth, cached)) {
+        QString bestMove = QString::fromStdString(Position::moveToUci(cached.bestMove));
+        LOG_INFO("analysis_cache_hit", {"move", bestMove}, {"depth", cached.depth});
+        QTimer::singleShot(0, this, [this, bestMove]() { onBestMoveReceived(bestMove); });
         return;
     }
-    if (isDraw()) {
-        qDebug() << "🤝 Döntetlen észlelve!";
-        QMessageBox::information(this, "Játék vége", "Döntetlen (anyaghiány vagy 50 lépés szabály)!");
-        isStarted = false;
+
+    if (uciEngine->uciProcess->state() != QProcess::Running) {
+        requestInternalMove(limits); // Nincs külső motor: a beépített keresés lép
         return;
     }
-    possibleMoves.clear(); // Minden esetben töröljük az előző lépéseket
+    uciRequest = uciEngine->requestSearch(game.moveHistory, QString::fromStdString(record->startFen()), limits);
 }
 
-bool Widget::isOwnPiece(int row, int col)
+void Widget::requestInternalMove(const SearchLimits &limits)
 {
-    if (row < 0 || row >= 8 || col < 0 || col >= 8 || board[row][col] == ' ') return false; // Határon kívüli vagy üres mező
-
-    return isWhiteTurn ? std::isupper(board[row][col]) : std::islower(board[row][col]);
-}
-
-bool Widget::findKingPosition(int &kingRow, int &kingCol) {
-    char kingChar = isWhiteTurn ? 'K' : 'k';
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            if (board[row][col] == kingChar) {
-                kingRow = row;
-                kingCol = col;
-                return true;
-            }
+    if (searchThread) return; // Már fut egy keresés
+
+    // A keresés saját táblát kap, a lépéstörténetből építjük fel
+    Position position;
+    if (!buildPosition(game.moveHistory, position)) return;
+
+    searchThread = QThread::create([this, position, limits]() mutable {
+        if (Trace::enabled()) Trace::setThreadName("search");
+        uint64_t key = position.key();
+        SearchResult result = search->think(position, limits);
+        QString bestMove = result.bestMove == NoMove ? QString("(none)")
+                                                     : QString::fromStdString(Position::moveToUci(result.bestMove));
+        QMetaObject::invokeMethod(this, [this, bestMove, key, result]() {
+            searchThread = nullptr;
+            // A gyorsítótárat csak a GUI szál írja
+            AnalysisCache::Entry entry;
+            entry.bestMove = result.bestMove;
+            entry.mate = Search::isMateScore(result.score);
+            entry.score = entry.mate ? Search::mateMoves(result.score) : result.score;
+            entry.depth = result.depth;
+            entry.pv = result.pv;
+            analysisCache->store(key, entry);
+            storeTreeResult(key, entry.score, entry.mate, result.depth, result.bestMove);
+            onBestMoveReceived(bestMove);
+        }, Qt::QueuedConnection);
+    });
+    connect(searchThread, &QThread::finished, searchThread, &QObject::deleteLater);
+    searchThread->start();
+}
+
+bool Widget::buildPosition(const QStringList &history, Position &position)
+{
+    // A lépéstörténet a játszma kezdőállásától (egyedi FEN is lehet) indul
+    if (record->startFen().empty() || !position.setFen(record->startFen())) position.setStartPosition();
+    for (const QString &uciMove : history) {
+        Move move = position.parseUciMove(uciMove.toStdString());
+        if (move == NoMove || !position.makeMove(move)) {
+            LOG_ERROR("invalid_history_move", {"move", uciMove});
+            return false;
         }
     }
-
-    qDebug() << "HIBA: Király nem található a táblán!";
-    return false;
+    return true;
 }
 
-bool Widget::isCheckmate()
+void Widget::storeEngineLine(const QStringList &history, const AnalysisLine &line)
 {
-    int kingRow, kingCol;
-    if (!findKingPosition(kingRow, kingCol)) return false; // Biztonsági ellenőrzés
-
-    if (!isSquareAttacked(kingRow, kingCol, isWhiteTurn)) return false; // Ha nincs sakk, nincs matt
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            if (isOwnPiece(row, col)) {
-                highlightMoves(row, col);
-                if (!possibleMoves.isEmpty()) return false; // Van érvényes lépés → nem matt
-            }
-        }
-    }
-
-    return true; // Ha nincs érvényes lépés → matt
+    Position position;
+    if (line.pv.isEmpty() || !buildPosition(history, position)) return;
+    uint64_t key = position.key();
+
+    // A változatot addig vesszük át, amíg a lépései érvényesek
+    AnalysisCache::Entry entry;
+    entry.score = line.score;
+    entry.mate = line.mate;
+    entry.depth = line.depth;
+    for (const QString &uciMove : line.pv) {
+        if (int(entry.pv.size()) >= AnalysisCache::MaxPvLength) break;
+        Move move = position.parseUciMove(uciMove.toStdString());
+        if (move == NoMove || !position.makeMove(move)) break;
+        entry.pv.push_back(move);
+    }
+    if (entry.pv.empty()) return;
+    entry.bestMove = entry.pv.front();
+    analysisCache->store(key, entry);
+    storeTreeResult(key, entry.score, entry.mate, entry.depth, entry.bestMove);
+}
+
+void Widget::storeTreeResult(quint64 key, int score, bool mate, int depth, quint16 bestMove)
+{
+    uint32_t node = analysisTree->find(key);
+    if (node == AnalysisTree::NoNode) return;   // Nem a bejárt változatok része
+    AnalysisTree::Result result;
+    result.score = score;
+    result.mate = mate;
+    result.depth = depth;
+    result.bestMove = bestMove;
+    analysisTree->store(node, result);
 }
 
-bool Widget::isStalemate()
+void Widget::startRecord(const QString &fen)
 {
-    int kingRow, kingCol;
-    if (!findKingPosition(kingRow, kingCol)) return false; // Biztonsági ellenőrzés
-
-    if (isSquareAttacked(kingRow, kingCol, isWhiteTurn)) return false; // Ha sakkban van, nem patt
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            if (isOwnPiece(row, col)) {
-                highlightMoves(row, col);
-                if (!possibleMoves.isEmpty()) return false; // Van lépés → nem patt
-            }
-        }
-    }
-
-    return true; // Ha nincs érvényes lépés, de a király nincs sakkban → patt
+    recordStartFen = fen;
+    recordArchived = false;
+    if (fen.isEmpty() || !record->reset(fen.toStdString())) record->reset();
+    moveListModel->reload();
+    analysisTree->clear();
+    analysisTree->add(record->position());
+    restartJournal();
 }
 
-bool Widget::isDraw()
+void Widget::restartJournal()
 {
-    int pieceCount = 0;
-    int bishopCount = 0;
-    int knightCount = 0;
-    bool hasOtherPiece = false;
-    std::vector<int> bishopColors; // Futók mezőszínének tárolása
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            char piece = board[row][col];
-            if (piece != ' ') {
-                pieceCount++;
-
-                if (piece == 'B' || piece == 'b') {
-                    bishopCount++;
-                    bishopColors.push_back((row + col) % 2); // 0 = világos mező, 1 = sötét mező
-                }
-                if (piece == 'N' || piece == 'n') knightCount++;
-
-                if (piece != 'K' && piece != 'k' && piece != 'B' && piece != 'b' && piece != 'N' && piece != 'n') {
-                    hasOtherPiece = true; // Ha van más figura, akkor nincs anyaghiányos döntetlen
-                }
-            }
-        }
-    }
-
-    if (hasOtherPiece) return false; // Ha más figura van, nem döntetlen
-
-    // Anyaghiány ellenőrzés
-    if (pieceCount == 2) return true; // Csak két király → döntetlen
-    if (pieceCount == 3 && (bishopCount == 1 || knightCount == 1)) return true; // Király vs. Király+Huszár/Futó
-
-    if (bishopCount == 2 && bishopColors.size() == 2) {
-        if (bishopColors[0] == bishopColors[1]) return true; // Két futó azonos mezőszínen → döntetlen
-    }
-
-    // Ötven lépés szabály ellenőrzése
-    if (stepsCount >= 100) {
-        qDebug() << "📜 Ötven lépés szabály miatt döntetlen!";
-        return true;
-    }
-
-    return false;
+    if (uciEngine->settings().journalPath.isEmpty() || !engineStarted) return;
+    journal->begin(uciEngine->settings().journalPath.toStdString(), recordStartFen.toStdString());
+    for (Move move : record->line(record->lineEnd(GameRecord::Root))) journal->appendMove(move);
 }
 
-void Widget::onBestMoveReceived(QString bestMove)
+void Widget::archiveGame(int result)
 {
-    if (bestMove.isEmpty() || bestMove == "(none)") {
-        qDebug() << "⚠️ No best move received from engine!";
-        return;
-    }
-
-    qDebug() << "?? Stockfish best move: " << bestMove;
-    qDebug() << "? Current turn before applying move: " << (isWhiteTurn ? "White" : "Black");
-
-    if (isWhiteTurn) {
-        qDebug() << "⚠️ Ignoring engine move, it's White's turn!";
-        return;
-    }
-
-    // ⛔ **HIBA MEGOLDÁSA:** Ellenőrizzük, hogy a lépés valóban végrehajtható-e!
-    if (!applyMove(bestMove)) {
-        qDebug() << "❌ Move application failed!";
-        return;
-    }
+    int mainEnd = record->lineEnd(GameRecord::Root);
+    if (mainEnd == GameRecord::Root || recordArchived) return;
+    ArchivedGame archived;
+    archived.startFen = recordStartFen.toStdString();
+    archived.moves = record->line(mainEnd);
+    archived.result = GameResult(result);
+    archived.white = "Player";
+    archived.black = uciEngine->uciProcess->state() == QProcess::Running
+                         ? QFileInfo(uciEngine->settings().path).baseName().toStdString() : "Internal";
+    archive->append(std::move(archived));   // Kódolás és írás a háttérszálon
+    journal->discard();
+    recordArchived = true;                  // A fa visszanézésre megmarad, de ugyanaz a játszma nem kerül be kétszer
+}
+
+void Widget::navigateTo(int node)
+{
+    if (searchThread || uciRequest) return;   // A motor éppen az aktuális álláson gondolkodik
+    if (node == record->current() || !record->goTo(node)) return;
 
-    checkGameOver();
+    // A szabálymag a rekord állását veszi át, a lépéstörténet a csomópontig tartó változat
+    game.setPosition(record->position());
+    for (Move move : record->line(node)) game.moveHistory.append(QString::fromStdString(Position::moveToUci(move)));
+    updatePieceCount();
+    updateMoveList();
+    if (ui->analysisButton->isChecked()) restartAnalysis();
+    else uciEngine->setPosition(game.moveHistory, QString::fromStdString(record->startFen()));
+    update();
 }
 
-void Widget::addPawnMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite) {
-    highlightPawnMoves(row, col);
-    moves = possibleMoves.values().toVector();  // Átalakítás QVector-ba
+void Widget::updateMoveList()
+{
+    moveListModel->refresh();
+    QModelIndex current = moveListModel->indexOf(record->current());
+    if (current.isValid()) ui->moveListView->scrollTo(current);
+    else if (record->current() == GameRecord::Root) ui->moveListView->scrollToTop();
 }
 
-void Widget::addRookMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite) {
-    highlightRookMoves(row, col);
-    moves = possibleMoves.values().toVector();
+void Widget::clearPieceCount()
+{
+    int whiteCount = 16, blackCount = 16;
+    int whiteCaptured = 0, blackCaptured = 0;
+    ui->whitePiecesLabel->setText(QString("White Pieces: %1").arg(whiteCount));
+    ui->blackPiecesLabel->setText(QString("Black Pieces: %1").arg(blackCount));
+    ui->whiteCapturedLabel->setText(QString("White Pieces Knocked Out: %1").arg(whiteCaptured));
+    ui->blackCapturedLabel->setText(QString("Black Pieces Knocked Out: %1").arg(blackCaptured));
 }
 
-void Widget::addKnightMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite) {
-    highlightKnightMoves(row, col);
-    moves = possibleMoves.values().toVector();
+void Widget::clearStepsCounter()
+{
+    game.stepsCount = 0;
+    ui->stepLabel->setText(QString("Steps Count: %1").arg(game.stepsCount));
 }
 
-void Widget::addBishopMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite) {
-    highlightBishopMoves(row, col);
-    moves = possibleMoves.values().toVector();
-}
+void Widget::startNewGame()
+{
+    isStarted = true;
+    update();
+    search->clear();
+    uciEngine->startNewGame();
 
-void Widget::addQueenMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite) {
-    highlightQueenMoves(row, col);
-    moves = possibleMoves.values().toVector();
+    // Időkontroll "perc+inkrement" formában, pl. "5+3"
+    QStringList timeControl = ui->timeControlBox->currentText().split('+');
+    int minutes = timeControl.value(0).toInt();
+    int increment = timeControl.value(1).toInt();
+    gameClock->start(minutes * 60 * 1000, increment * 1000);
 }
 
-void Widget::addKingMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite) {
-    highlightKingMoves(row, col);
-    moves = possibleMoves.values().toVector();
+void Widget::updateClockLabels(int whiteMs, int blackMs)
+{
+    ui->whiteClockLabel->setText(QString("White: %1").arg(GameClock::format(whiteMs)));
+    ui->blackClockLabel->setText(QString("Black: %1").arg(GameClock::format(blackMs)));
 }
 
-QPair<QPair<int, int>, QPair<int, int>> Widget::convertUciToCoords(QString uciMove) {
-    if (uciMove.length() != 4) {
-        qDebug() << "❌ Invalid UCI move format:" << uciMove;
-        return { {-1, -1}, {-1, -1} }; // Hibás koordináta
+void Widget::onFlagFell(bool white)
+{
+    LOG_INFO("game_over", {"reason", "flag"}, {"white", white});
+    isStarted = false;
+    archiveGame(int(white ? GameResult::BlackWins : GameResult::WhiteWins));
+    if (searchThread) search->stop();
+    if (uciRequest) {
+        quint64 request = uciRequest;
+        uciRequest = 0;   // A cancel() válaszát már nem várjuk
+        uciEngine->cancel(request);
     }
-
-    return {
-        { 8 - uciMove[1].digitValue(), uciMove[0].toLatin1() - 'a' },
-        { 8 - uciMove[3].digitValue(), uciMove[2].toLatin1() - 'a' }
-    };
+    QMessageBox::information(this, "Játék vége", white ? "Fekete nyert (idő)!" : "Fehér nyert (idő)!");
 }
 
-QVector<QPair<int, int>> Widget::getLegalMoves(int row, int col) {
-    possibleMoves.clear();
-    QChar piece = board[row][col];
-
-    if (piece == ' ') {
-        qDebug() << "⚠️ No piece at (" << row << "," << col << ")";
-        return {};
-    }
-    bool pieceIsWhite = piece.isUpper();
-
-    // Ensure we only get legal moves for the correct side
-    if ((isWhiteTurn && !pieceIsWhite) || (!isWhiteTurn && pieceIsWhite)) {
-        qDebug() << "⚠️ It's not this piece's turn!";
-        return {};
-    }
-
-    switch (piece.toLower().toLatin1()) {
-    case 'p': highlightPawnMoves(row, col); break;
-    case 'r': highlightRookMoves(row, col); break;
-    case 'n': highlightKnightMoves(row, col); break;
-    case 'b': highlightBishopMoves(row, col); break;
-    case 'q': highlightQueenMoves(row, col); break;
-    case 'k': highlightKingMoves(row, col); break;
+void Widget::toggleAnalysis(bool enabled)
+{
+    if (enabled) {
+        gameClock->stop();   // Elemzés közben nincs óra és nincs motorlépés
+        restartAnalysis();
+    } else {
+        if (uciEngine->isAnalyzing() && !uciEngine->analysisLines().isEmpty())
+            storeEngineLine(analysisHistory, uciEngine->analysisLines().first());
+        uciEngine->stopAnalysis();
+        analysisTimer->stop();
+        ui->analysisLabel->clear();
+        update();
     }
-    filterIllegalMoves();
-    return possibleMoves.values().toVector();
 }
 
-void Widget::updatePossibleMoves()
+void Widget::restartAnalysis()
 {
-    possibleMoves.clear();
-
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            QChar piece = board[row][col];
-
-            if (piece != ' ') {
-                bool pieceIsWhite = piece.isUpper();
-
-                if ((isWhiteTurn && pieceIsWhite) || (!isWhiteTurn && !pieceIsWhite)) {
-                    QVector<QPair<int, int>> moves = getLegalMoves(row, col);
-                    for (const auto& move : moves) {
-                        possibleMoves.insert(move);
-                    }
-                }
-            }
-        }
-    }
-
-    // 🔹 Debug kiírás, hogy tényleg frissült-e
-    qDebug() << "♟️ Updated possibleMoves:";
-    for (const auto& move : possibleMoves) {
-        qDebug() << "(" << move.first << "," << move.second << ")";
+    if (uciEngine->uciProcess->state() != QProcess::Running) {
+        ui->analysisLabel->setText("Analysis needs a running UCI engine.");
+        return;
     }
+    // Az előző állás legjobb változata megmarad a következő futásokra
+    if (uciEngine->isAnalyzing() && !uciEngine->analysisLines().isEmpty())
+        storeEngineLine(analysisHistory, uciEngine->analysisLines().first());
+    uciEngine->stopAnalysis();
+    uciEngine->setMultiPV(ui->multiPvBox->value());
+    analysisHistory = game.moveHistory;
+    analysisKey = record->position().key();
+    uciEngine->startAnalysis(game.moveHistory, QString::fromStdString(record->startFen()));
 }
 
-bool Widget::applyMove(QString move)
+void Widget::updateAnalysisPanel()
 {
-    qDebug() << "?? Applying move: " << move;
-
-    auto coords = convertUciToCoords(move);
-    int fromRow = coords.first.first;
-    int fromCol = coords.first.second;
-    int toRow = coords.second.first;
-    int toCol = coords.second.second;
-
-    qDebug() << "?? From (" << fromRow << "," << fromCol << ") to (" << toRow << "," << toCol << ")";
-
-    // Ellenőrizzük, hogy a tábla érvényes helyére lépünk-e
-    if (fromRow < 0 || fromRow >= 8 || fromCol < 0 || fromCol >= 8 ||
-        toRow < 0 || toRow >= 8 || toCol < 0 || toCol >= 8) {
-        qFatal("❌ Invalid move: coordinates out of bounds!");
-        qDebug() << "❌ Invalid move: coordinates out of bounds!";
-        return false;
-    }
-
-    char piece = board[fromRow][fromCol];
-
-    // A felhasználó csak fehérrel léphet
-    if (isWhiteTurn && (piece >= 'a' && piece <= 'z')) {
-        qFatal("❌ You can only move white pieces!");
-        qDebug() << "❌ You can only move white pieces!";
-        return false;
-    }
-
-    // A sakkmotor csak feketével léphet
-    if (!isWhiteTurn && (piece >= 'A' && piece <= 'Z')) {
-        qFatal("❌ Engine can only move black pieces!");
-        qDebug() << "❌ Engine can only move black pieces!";
-        return false;
+    const QVector<AnalysisLine> &lines = uciEngine->analysisLines();
+    uint32_t treeNode = analysisTree->find(analysisKey);
+    if (lines.isEmpty()) {
+        // Amíg a motor nem szól, a más lépéssorrendből már ismert eredményt mutatjuk
+        QString text = "Analyzing...";
+        AnalysisTree::Result known;
+        if (treeNode != AnalysisTree::NoNode) known = analysisTree->result(treeNode);
+        if (known.depth > 0) {
+            int whiteScore = game.isWhiteTurn() ? known.score : -known.score;
+            text += QString("\nKnown%1: d%2  %3  %4")
+                        .arg(analysisTree->parentCount(treeNode) > 1 ? " (transposition)" : "")
+                        .arg(known.depth)
+                        .arg(known.mate ? QString("#%1").arg(whiteScore)
+                                        : QString("%1%2").arg(whiteScore >= 0 ? "+" : "").arg(whiteScore / 100.0, 0, 'f', 2))
+                        .arg(QString::fromStdString(Position::moveToUci(known.bestMove)));
+        }
+        ui->analysisLabel->setText(text);
+        update(605, 0, 25, 600);
+        return;
     }
 
-    // Ellenőrizzük, hogy a lépés legális-e
-    QVector<QPair<int, int>> legalMoves = getLegalMoves(fromRow, fromCol);
-
-    // ⛔ **HIBA MEGOLDÁSA:** Ha üres a lista, ne próbáljuk elérni az elemeit!
-    if (legalMoves.isEmpty()) {
-        qFatal("❌ No legal moves found for this piece!");
-        qDebug() << "❌ No legal moves found for this piece!";
-        return false;
+    const AnalysisLine &best = lines.first();
+    if (treeNode != AnalysisTree::NoNode && !best.pv.isEmpty()) {
+        // Élőben a fába: a transzponáló ágak azonnal megkapják
+        AnalysisTree::Result result;
+        result.score = best.score;
+        result.mate = best.mate;
+        result.depth = best.depth;
+        result.bestMove = record->position().key() == analysisKey ? record->parseUciMove(best.pv.first().toStdString()) : NoMove;
+        if (result.bestMove != NoMove) analysisTree->store(treeNode, result);
     }
-
-    if (!legalMoves.contains(QPair<int, int>(toRow, toCol))) {
-        qFatal("❌ Invalid move! Move is not in legalMoves.");
-        qDebug() << "❌ Invalid move! Move is not in legalMoves.";
-        return false;
+    QString text = QString("Depth %1/%2   %3 knps\n").arg(best.depth).arg(best.seldepth).arg(best.nps / 1000);
+    for (const AnalysisLine &line : lines) {
+        if (line.pv.isEmpty()) continue;
+        // Pontszám fehér szemszögéből, ahogy a sakkfelületeken szokás
+        int whiteScore = game.isWhiteTurn() ? line.score : -line.score;
+        QString score = line.mate ? QString("#%1").arg(whiteScore)
+                                  : QString("%1%2").arg(whiteScore >= 0 ? "+" : "").arg(whiteScore / 100.0, 0, 'f', 2);
+        text += QString("%1. %2  d%3  %4\n").arg(line.multipv).arg(score, 6).arg(line.depth)
+                    .arg(QStringList(line.pv.mid(0, 10)).join(' '));
     }
-
-    // Ha a lépés érvényes, végrehajtjuk
-    board[toRow][toCol] = board[fromRow][fromCol];
-    board[fromRow][fromCol] = ' ';
-    moveHistory.append(move);
-    uciEngine->setPosition(moveHistory);
-    qDebug() << "📜 Move history sent to engine: " << moveHistory;
-    isWhiteTurn = !isWhiteTurn;
-    possibleMoves.clear();
-    update();
-
-    // Ha a felhasználó lépett, akkor a motor jön
-    if (!isWhiteTurn) {
-        stepsCount++;
-        ui->stepLabel->setText(QString("Steps Count: %1").arg(stepsCount));
-        uciEngine->requestBestMove(1000);
-    }
-
-    return true;
-}
-
-void Widget::clearPieceCount()
-{
-    int whiteCount = 16, blackCount = 16;
-    int whiteCaptured = 0, blackCaptured = 0;
-    ui->whitePiecesLabel->setText(QString("White Pieces: %1").arg(whiteCount));
-    ui->blackPiecesLabel->setText(QString("Black Pieces: %1").arg(blackCount));
-    ui->whiteCapturedLabel->setText(QString("White Pieces Knocked Out: %1").arg(whiteCaptured));
-    ui->blackCapturedLabel->setText(QString("Black Pieces Knocked Out: %1").arg(blackCaptured));
-}
-
-void Widget::clearStepsCounter()
-{
-    stepsCount = 0;
-    ui->stepLabel->setText(QString("Steps Count: %1").arg(stepsCount));
-}
-
-void Widget::startNewGame()
-{
-    isStarted = true;
-    update();
-    uciEngine->startNewGame();
+    ui->analysisLabel->setText(text);
+    update(605, 0, 25, 600);   // Csak az értékelő sáv
 }
 
 void Widget::resetGame()
 {
-    moveHistory.clear();  // Történet törlése
+    archiveGame(int(GameResult::Unknown));
+    startRecord();
+    game.moveHistory.clear();  // Történet törlése
+    gameClock->stop();
     clearPieceCount();
     clearStepsCounter();
     initializeBoard();  // Tábla alaphelyzetbe állítása
-    possibleMoves.clear();
-    selectedRow = -1;
-    selectedCol = -1;
+    game.possibleMoves.clear();
+    game.selectedRow = -1;
+    game.selectedCol = -1;
+    if (ui->analysisButton->isChecked()) restartAnalysis();
     update();
 }
 
-bool Widget::isEnemyPiece(int row, int col)
-{
-    char piece = board[row][col];
-    if (piece == ' ' || (isWhiteTurn && piece >= 'A' && piece <= 'Z') ||
-        (!isWhiteTurn && piece >= 'a' && piece <= 'z')) {
-        return false; // Ha a mező üres vagy a saját színű bábu, nem támadható
-    }
-    return true; // Ellenfél bábujának támadása
-}
@@ -4,10 +4,26 @@
 #include <QWidget>
 #include <QVector>
 #include <QProcess>
+#include <QElapsedTimer>
+#include "chessgame.h"
 
 class UCIEngine;
 class HighlightPieces;
 class VictoryHandler;
+class Search;
+class GameClock;
+class AnalysisCache;
+class GameArchiveWriter;
+class GameJournal;
+class GameRecord;
+class MoveListModel;
+class AnalysisTree;
+class Position;
+class QThread;
+class QPainter;
+class QTimer;
+struct SearchLimits;
+struct AnalysisLine;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -21,55 +37,32 @@ class Widget : public QWidget {
 public:
     explicit Widget(QWidget *parent = nullptr);
     ~Widget();
+    void showEvent(QShowEvent *event) override;
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void drawLatencyOverlay(QPainter &painter);
+    void drawThreatOverlay(QPainter &painter, int squareSize);
     void initializeBoard();
+    bool setFen(const QString &fen);
     void highlightMoves(int row, int col);
-    void makeMove(const QString &move);
-    void highlightPawnMoves(int row, int col);
-    void highlightRookMoves(int row, int col);
-    void highlightKnightMoves(int row, int col);
-    void highlightBishopMoves(int row, int col);
-    void highlightQueenMoves(int row, int col);
-    void highlightKingMoves(int row, int col);
-    void highlightCastling(int row, int col);
-    bool isEnPassant(int row, int col);
-    void filterIllegalMoves();
-    bool doesMoveExposeKing(QPair<int, int> move);
-    bool isSquareAttacked(int row, int col, bool isWhite);
     bool applyMove(QString move);
-    bool isEnemyPiece(int row, int col);
-    void onBestMoveReceived(QString bestMove);
-    bool isValidMove(QString move);
-    void updatePossibleMoves();
-    QVector<QPair<int, int>> getLegalMoves(int row, int col);
-    void addPawnMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite);
-    void addRookMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite);
-    void addKnightMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite);
-    void addBishopMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite);
-    void addQueenMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite);
-    void addKingMoves(QVector<QPair<int, int>>& moves, int row, int col, bool isWhite);
-    QPair<QPair<int, int>, QPair<int, int>> convertUciToCoords(QString uciMove);
+    void onBestMoveReceived(QString bestMove, bool fromUci = false);
+    void requestInternalMove(const SearchLimits &limits);
+    void requestEngineMove();
+    void updateClockLabels(int whiteMs, int blackMs);
+    void onFlagFell(bool white);
     void startNewGame();
     void resetGame();
     void checkGameOver();
-    bool isCheckmate();
-    bool isStalemate();
-    bool isDraw();
-    bool isOwnPiece(int row, int col);
     void updatePieceCount();
     void clearPieceCount();
     void clearStepsCounter();
-    bool findKingPosition(int &kingRow, int &kingCol);
-    QSet<QPair<int, int>> possibleMoves;
-    QVector<QVector<bool>> hasMoved;
-    QPair<int, int> enPassantTarget;
-    int selectedRow = -1;
-    int selectedCol = -1;
-    bool isWhiteTurn = true;
-    QStringList moveHistory;
-    QMap<QString, QString> boardMap;
-    int stepsCount = 0;
+    void toggleAnalysis(bool enabled);
+    void restartAnalysis();
+    void updateAnalysisPanel();
+    void drawEvalBar(QPainter &painter);
+    ChessGame game;      // Szabálylogika (chess_core)
     bool isStarted = false;
 
 private:
@@ -77,7 +70,36 @@ private:
     UCIEngine *uciEngine;
     HighlightPieces *highlightPieces;
     VictoryHandler *victoryHandler;
-    QVector<QVector<char>> board;
+    Search *search;
+    QThread *searchThread = nullptr;
+    GameClock *gameClock;
+    QElapsedTimer clickTimer;      // Kattintástól a következő kirajzolásig
+    QElapsedTimer engineTimer;     // Motorkérés és bestmove között
+    bool showLatencyOverlay = false;
+    bool showThreatOverlay = false;
+    bool engineStarted = false;
+    quint64 uciRequest = 0;        // A motorlépés címkézett kérése, 0 = nincs; a válasz a gyorsítótárba is kerül
+    QTimer *analysisTimer;         // Az info sorokat legfeljebb 10 Hz-cel jelenítjük meg
+    AnalysisCache *analysisCache;
+    QStringList analysisHistory;   // Az éppen elemzett állás lépései
+    AnalysisTree *analysisTree;    // A bejárt változatok, transzpozíciók összevonva
+    quint64 analysisKey = 0;       // Az éppen elemzett állás kulcsa
+    GameArchiveWriter *archive;
+    GameJournal *journal;
+    GameRecord *record;            // A játszma és változatai; a főváltozatot mentjük
+    QString recordStartFen;        // Üres = alapállás
+    bool recordArchived = false;   // A főváltozat már az archívumban van
+    MoveListModel *moveListModel;
+
+    void startRecord(const QString &fen = QString());
+    void archiveGame(int result);  // GameResult értéke
+    void restartJournal();
+    void navigateTo(int node);     // Visszanézés: a tábla a csomópont állását mutatja
+    void updateMoveList();
+
+    bool buildPosition(const QStringList &history, Position &position);
+    void storeEngineLine(const QStringList &history, const AnalysisLine &line);
+    void storeTreeResult(quint64 key, int score, bool mate, int depth, quint16 bestMove);
 
 signals:
     void moveMade(QString move);